@@ -0,0 +1,50 @@
+#include "Benchmark.h"
+
+struct BenchmarkCase
+{
+  const char* Name;
+  void (*Run)(void);
+};
+
+// a function local static, the benchmarks of other translation units register before any global of this one is initialized
+static std::vector<BenchmarkCase>& Benchmarks(void)
+{
+  static std::vector<BenchmarkCase> benchmarks;
+
+  return benchmarks;
+}
+
+bool Benchmark::Register(const char* name, void (*run)(void))
+{
+  Benchmarks().push_back({ name, run });
+
+  return true;
+}
+
+void Benchmark::RunAll(const std::string& filter)
+{
+  for (const auto& benchmark : Benchmarks())
+  {
+    if (std::string(benchmark.Name).find(filter) == std::string::npos) continue;
+
+    std::cout << benchmark.Name << std::endl;
+
+    benchmark.Run();
+  }
+}
+
+void Benchmark::Report(const std::string& what, double seconds, uint64_t bytes, uint64_t items, const char* itemName)
+{
+  char line[256];
+
+  snprintf(line, sizeof(line), "  %-40s %9.2f MB %9.2f ms %9.1f MB/s %9.2f M %s/s", what.c_str(), bytes / 1e6, seconds * 1e3, bytes / 1e6 / seconds, items / 1e6 / seconds, itemName);
+
+  std::cout << line << std::endl;
+}
+
+uint64_t Benchmark::FileSize(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+  return file.is_open() ? static_cast<uint64_t>(file.tellg()) : 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// a benchmark runner without dependencies, every BENCHMARK registers itself before main
+// the runner is started in the solution directory, the shipped assets are read from there, and only Release numbers mean anything
+class Benchmark
+{
+public:
+  static bool Register(const char* name, void (*run)(void));
+
+  // runs every benchmark whose name contains filter
+  static void RunAll(const std::string& filter);
+
+  // the fastest of repetitions runs of work in seconds, the first run also warms the caches and the scratch buffers
+  template <typename Work>
+  static double Time(UINT repetitions, Work&& work)
+  {
+    double best = std::numeric_limits<double>::max();
+
+    for (UINT r = 0; r < repetitions; ++r)
+    {
+      const auto start = std::chrono::steady_clock::now();
+
+      work();
+
+      const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+      best = std::min(best, seconds.count());
+    }
+
+    return best;
+  }
+
+  // one line of results, the throughput of bytes in MB/s and of items in millions per second
+  static void Report(const std::string& what, double seconds, uint64_t bytes, uint64_t items, const char* itemName);
+
+  // the size of a file, 0 if it does not exist
+  static uint64_t FileSize(const std::string& filename);
+
+private:
+  Benchmark(void) noexcept = delete;
+  ~Benchmark(void) noexcept = delete;
+
+};
+
+#define BENCHMARK(name) \
+  static void name(void); \
+  static const bool s_Registered##name = Benchmark::Register(#name, &name); \
+  static void name(void)
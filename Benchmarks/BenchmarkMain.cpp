@@ -0,0 +1,9 @@
+#include "Benchmark.h"
+
+// Benchmarks.exe [filter], runs the benchmarks whose name contains filter or all of them
+int main(int argc, char* argv[])
+{
+  Benchmark::RunAll((argc > 1) ? argv[1] : "");
+
+  return EXIT_SUCCESS;
+}
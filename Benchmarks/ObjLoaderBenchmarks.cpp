@@ -0,0 +1,83 @@
+#include "Benchmark.h"
+#include "../Tests/Test.h"
+#include "../Tests/ObjWriter.h"
+#include "../Tests/BaselineObjLoader.h"
+#include "../ObjLoader.h"
+
+// drops what a streaming import passes on
+class NullSink : public ObjSink
+{
+public:
+  virtual bool Vertices(const Vertex* vertices, size_t count) override { return true; }
+  virtual bool Indices(const DWORD* indices, size_t count) override { return true; }
+};
+
+// about a million triangles
+static constexpr UINT s_GridSize = 708;
+
+static const char* const s_ShippedMeshes[] = { "plane.obj", "barrier.obj", "wall.obj", "floor.obj" };
+
+static const struct
+{
+  const char* Filename;
+  ObjCorner Corner;
+  bool Negative;
+  bool Quads;
+  bool Baseline;  // the baseline loader reads it
+} s_SyntheticMeshes[] =
+{
+  { "benchmark_triangles.obj", ObjCorner::PositionTexCoord, false, false, true },
+  { "benchmark_quads.obj", ObjCorner::PositionTexCoord, false, true, false },
+  { "benchmark_negative.obj", ObjCorner::PositionTexCoordNormal, true, false, false },
+  { "benchmark_positions.obj", ObjCorner::Position, false, false, false },
+};
+
+// the time to import a file, the baseline loader is timed once since it is orders of magnitude slower
+static void Measure(OBJLoader& loader, const std::string& filename, const bool baseline)
+{
+  const uint64_t size = Benchmark::FileSize(filename);
+
+  const double seconds = Benchmark::Time(5, [&](void) { loader.Import(filename); });
+
+  Benchmark::Report(filename, seconds, size, loader.Indices().size() / 3, "triangles");
+
+  if (!baseline) return;
+
+  Vertex* vertices = nullptr;
+  DWORD* indices = nullptr;
+  int vertexCount = 0;
+  int indexCount = 0;
+
+  const double baselineSeconds = Benchmark::Time(1, [&](void) { BaselineObjLoader::Load(filename, vertices, vertexCount, indices, indexCount); });
+
+  Benchmark::Report(filename + " (baseline)", baselineSeconds, size, indexCount / 3, "triangles");
+
+  delete[] vertices;
+  delete[] indices;
+}
+
+BENCHMARK(ObjLoaderImport)
+{
+  OBJLoader loader;
+
+  for (const auto* filename : s_ShippedMeshes) Measure(loader, filename, true);
+
+  for (const auto& synthetic : s_SyntheticMeshes)
+  {
+    const TemporaryFile file(synthetic.Filename, ObjWriter::Grid(s_GridSize, synthetic.Corner, synthetic.Negative, synthetic.Quads, 0));
+
+    Measure(loader, file.Name(), synthetic.Baseline);
+  }
+}
+
+BENCHMARK(ObjLoaderStream)
+{
+  OBJLoader loader;
+  NullSink sink;
+
+  const TemporaryFile file("benchmark_stream.obj", ObjWriter::Grid(s_GridSize, ObjCorner::PositionTexCoord, false, false, 0));
+
+  const double seconds = Benchmark::Time(5, [&](void) { loader.Stream(file.Name(), sink); });
+
+  Benchmark::Report(file.Name(), seconds, Benchmark::FileSize(file.Name()), 2ull * s_GridSize * s_GridSize, "triangles");
+}
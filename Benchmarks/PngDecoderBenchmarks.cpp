@@ -0,0 +1,66 @@
+#include "Benchmark.h"
+#include "../Tests/PngWriter.h"
+#include "../PngDecoder.h"
+
+static const char* const s_ShippedImages[] = { "barrier.png", "thm.png" };
+
+// textures of the size the importer meets, the fixed codes are about as fast to inflate as the dynamic ones encoders write
+static const struct
+{
+  const char* Name;
+  UINT Size;
+  BYTE ColorType;
+  BYTE Depth;
+  bool Interlaced;
+  PngDeflate Deflate;
+} s_SyntheticImages[] =
+{
+  { "rgba8", 4096, 6, 8, false, PngDeflate::Fixed },
+  { "rgb8", 4096, 2, 8, false, PngDeflate::Fixed },
+  { "rgba8 stored", 4096, 6, 8, false, PngDeflate::Stored },
+  { "rgba8 interlaced", 4096, 6, 8, true, PngDeflate::Fixed },
+  { "rgba16", 2048, 6, 16, false, PngDeflate::Fixed },
+  { "palette4", 4096, 3, 4, false, PngDeflate::Fixed },
+};
+
+// the time to decode png, the throughput is of the file and of the pixels
+static void Measure(const std::string& what, const std::vector<BYTE>& png)
+{
+  PngInfo info;
+
+  if (!PngDecoder::ReadInfo(png.data(), png.size(), info))
+  {
+    std::cout << "  " << what << " is not a PNG file" << std::endl;
+    return;
+  }
+
+  const size_t rowPitch = static_cast<size_t>(info.Width) * info.BytesPerPixel;
+  std::vector<BYTE> pixels(rowPitch * info.Height);
+  bool decoded = true;
+
+  const double seconds = Benchmark::Time(5, [&](void) { decoded &= PngDecoder::Decode(png.data(), png.size(), pixels.data(), rowPitch); });
+
+  if (!decoded) std::cout << "  " << what << " did not decode" << std::endl;
+
+  Benchmark::Report(what, seconds, png.size(), static_cast<uint64_t>(info.Width) * info.Height, "pixels");
+}
+
+BENCHMARK(PngDecoderShipped)
+{
+  for (const auto* filename : s_ShippedImages)
+  {
+    std::ifstream file(filename, std::ios::binary);
+
+    Measure(filename, std::vector<BYTE>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+  }
+}
+
+BENCHMARK(PngDecoderSynthetic)
+{
+  for (const auto& synthetic : s_SyntheticImages)
+  {
+    const PngSource source = PngWriter::Pattern(synthetic.Size, synthetic.Size, synthetic.ColorType, synthetic.Depth, synthetic.Interlaced, 0);
+
+    Measure(synthetic.Name, PngWriter::Write(source, synthetic.Deflate));
+  }
+}
@@ -0,0 +1,1109 @@
+#include "BlockCompressor.h"
+
+#include <atomic>
+#include <thread>
+
+// least squares refinements of the endpoints for each quality
+static constexpr int s_Refinements[] = { 0, 2, 8 };
+// of the 64 partitions of BC7 mode 1, this many that fit their subsets best to a line are encoded in full
+static constexpr int s_PartitionCandidates = 4;
+
+// BC7 interpolation weights in 64ths for 3 and 4 bit indices
+static constexpr int s_Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static constexpr int s_Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// the two subset partitions of BC7, bit i is the subset of pixel i
+static constexpr uint16_t s_Partitions2[64] = {
+  0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+  0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+  0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+  0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+// the pixel of subset 1 whose index is written without its highest bit, that of subset 0 is always pixel 0
+static constexpr BYTE s_Anchors2[64] = {
+  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+  15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+  15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+  6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+// the layout of a BC7 mode Compress writes
+struct Bc7Mode
+{
+  int Channels;       // 3 for RGB with opaque alpha, 4 for RGBA
+  int EndpointBits;   // per channel without the p-bit
+  int IndexBits;
+  bool SharedPBit;    // one p-bit per subset instead of one per endpoint
+};
+
+static constexpr Bc7Mode s_Mode1 = { 3, 6, 3, true };
+static constexpr Bc7Mode s_Mode6 = { 4, 7, 4, false };
+
+// a 4x4 block as RGBA, row by row
+struct BlockPixels
+{
+  int Pixels[16][4];
+  bool Opaque;
+};
+
+// quantized endpoints of a BC7 subset
+struct SubsetEndpoints
+{
+  int Values[2][4];
+  int PBits[2];
+};
+
+// the 128 bits of a block, written and read from the lowest bit up
+struct BlockBits
+{
+  uint64_t Bits[2] = {};
+  int Position = 0;
+
+  inline void Write(const uint32_t value, const int count) noexcept
+  {
+    for (int i = 0; i < count; ++i, ++Position) Bits[Position >> 6] |= static_cast<uint64_t>((value >> i) & 1) << (Position & 63);
+  }
+
+  inline uint32_t Read(const int count) noexcept
+  {
+    uint32_t value = 0;
+
+    for (int i = 0; i < count; ++i, ++Position) value |= static_cast<uint32_t>((Bits[Position >> 6] >> (Position & 63)) & 1) << i;
+
+    return value;
+  }
+};
+
+// the endpoint pairs of 5 and 6 bits whose color at 1/3 comes closest to every 8 bit value, BC1 blocks of a single color use them
+struct SingleColorTables
+{
+  BYTE Match5[256][2];
+  BYTE Match6[256][2];
+
+  SingleColorTables(void) noexcept
+  {
+    Fill(Match5, 5);
+    Fill(Match6, 6);
+  }
+
+  static void Fill(BYTE (&match)[256][2], const int bits) noexcept
+  {
+    const int levels = 1 << bits;
+
+    for (int value = 0; value < 256; ++value)
+    {
+      int best = INT_MAX;
+
+      for (int a = 0; a < levels; ++a)
+      {
+        for (int b = 0; b < levels; ++b)
+        {
+          const int ea = (a << (8 - bits)) | (a >> (2 * bits - 8));
+          const int eb = (b << (8 - bits)) | (b >> (2 * bits - 8));
+          const int error = abs((2 * ea + eb) / 3 - value) * 64 + abs(a - b);
+
+          if (error < best)
+          {
+            best = error;
+            match[value][0] = static_cast<BYTE>(a);
+            match[value][1] = static_cast<BYTE>(b);
+          }
+        }
+      }
+    }
+  }
+};
+
+static const SingleColorTables& SingleColor(void) noexcept
+{
+  static const SingleColorTables tables;
+
+  return tables;
+}
+
+// runs encode(row) for every row of blocks, threads take the next row as they finish one since the cost of a block varies
+template <typename Encode>
+static void ForEachBlockRow(const UINT rows, const UINT maxThreads, const Encode& encode)
+{
+  std::atomic<UINT> next(0);
+
+  const auto work = [&next, rows, &encode](void) { for (UINT row = next++; row < rows; row = next++) encode(row); };
+  const UINT threads = std::max(1u, std::min(maxThreads ? maxThreads : std::thread::hardware_concurrency(), rows));
+
+  std::vector<std::thread> workers;
+
+  for (UINT t = 1; t < threads; ++t) workers.emplace_back(work);
+
+  work();
+
+  for (auto& worker : workers) worker.join();
+}
+
+static void LoadBlock(const BYTE* pixels, const UINT width, const UINT height, const DXGI_FORMAT source, const UINT blockX, const UINT blockY, BlockPixels& block) noexcept
+{
+  const bool bgr = (source != DXGI_FORMAT_R8G8B8A8_UNORM);
+
+  block.Opaque = true;
+
+  for (UINT i = 0; i < 16; ++i)
+  {
+    const UINT x = std::min(blockX * 4 + (i & 3), width - 1);
+    const UINT y = std::min(blockY * 4 + (i >> 2), height - 1);
+    const BYTE* pixel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+    int* target = block.Pixels[i];
+
+    target[0] = pixel[bgr ? 2 : 0];
+    target[1] = pixel[1];
+    target[2] = pixel[bgr ? 0 : 2];
+    target[3] = (source == DXGI_FORMAT_B8G8R8X8_UNORM) ? 255 : pixel[3];
+
+    block.Opaque = block.Opaque && (target[3] == 255);
+  }
+}
+
+static void StoreBlock(const BYTE (&decoded)[16][4], const UINT width, const UINT height, const UINT blockX, const UINT blockY, BYTE* pixels) noexcept
+{
+  for (UINT i = 0; i < 16; ++i)
+  {
+    const UINT x = blockX * 4 + (i & 3);
+    const UINT y = blockY * 4 + (i >> 2);
+
+    if (x < width && y < height) memcpy(pixels + (static_cast<size_t>(y) * width + x) * 4, decoded[i], 4);
+  }
+}
+
+// the mean and the direction of the largest spread of the members of a block over their first channels
+static void PrincipalAxis(const BlockPixels& block, const int* members, const int count, const int channels, float mean[4], float axis[4]) noexcept
+{
+  float covariance[4][4] = {};
+
+  for (int c = 0; c < 4; ++c) mean[c] = 0.0f;
+
+  for (int m = 0; m < count; ++m)
+  {
+    for (int c = 0; c < channels; ++c) mean[c] += block.Pixels[members[m]][c];
+  }
+
+  for (int c = 0; c < channels; ++c) mean[c] /= count;
+
+  for (int m = 0; m < count; ++m)
+  {
+    float delta[4];
+
+    for (int c = 0; c < channels; ++c) delta[c] = block.Pixels[members[m]][c] - mean[c];
+
+    for (int i = 0; i < channels; ++i)
+    {
+      for (int j = i; j < channels; ++j) covariance[i][j] += delta[i] * delta[j];
+    }
+  }
+
+  for (int i = 0; i < channels; ++i)
+  {
+    for (int j = 0; j < i; ++j) covariance[i][j] = covariance[j][i];
+  }
+
+  // power iteration from the channel that varies most
+  int widest = 0;
+
+  for (int c = 1; c < channels; ++c) widest = (covariance[c][c] > covariance[widest][widest]) ? c : widest;
+
+  for (int c = 0; c < 4; ++c) axis[c] = (c < channels) ? covariance[widest][c] : 0.0f;
+
+  for (int iteration = 0; iteration < 8; ++iteration)
+  {
+    float next[4] = {};
+    float largest = 0.0f;
+
+    for (int i = 0; i < channels; ++i)
+    {
+      for (int j = 0; j < channels; ++j) next[i] += covariance[i][j] * axis[j];
+
+      largest = std::max(largest, fabsf(next[i]));
+    }
+
+    if (largest < 1e-6f) break;
+
+    for (int c = 0; c < channels; ++c) axis[c] = next[c] / largest;
+  }
+
+  float length = 0.0f;
+
+  for (int c = 0; c < channels; ++c) length += axis[c] * axis[c];
+
+  // a block of a single color, any direction does
+  if (length < 1e-12f)
+  {
+    for (int c = 0; c < channels; ++c) axis[c] = 1.0f;
+
+    length = static_cast<float>(channels);
+  }
+
+  for (int c = 0; c < channels; ++c) axis[c] /= sqrtf(length);
+}
+
+// the ends of the projections of the members onto the axis through their mean
+static void AxisEndpoints(const BlockPixels& block, const int* members, const int count, const int channels, float low[4], float high[4]) noexcept
+{
+  float mean[4];
+  float axis[4];
+
+  PrincipalAxis(block, members, count, channels, mean, axis);
+
+  float minimum = std::numeric_limits<float>::max();
+  float maximum = -std::numeric_limits<float>::max();
+
+  for (int m = 0; m < count; ++m)
+  {
+    float t = 0.0f;
+
+    for (int c = 0; c < channels; ++c) t += (block.Pixels[members[m]][c] - mean[c]) * axis[c];
+
+    minimum = std::min(minimum, t);
+    maximum = std::max(maximum, t);
+  }
+
+  for (int c = 0; c < channels; ++c)
+  {
+    low[c] = mean[c] + axis[c] * minimum;
+    high[c] = mean[c] + axis[c] * maximum;
+  }
+}
+
+// the endpoints with the smallest squared error for members at fixed fractions of the way from low to high, false if all fractions are the same
+static bool LeastSquares(const BlockPixels& block, const int* members, const int count, const int channels, const float* fractions, float low[4], float high[4]) noexcept
+{
+  float aa = 0.0f;
+  float ab = 0.0f;
+  float bb = 0.0f;
+  float ax[4] = {};
+  float bx[4] = {};
+
+  for (int m = 0; m < count; ++m)
+  {
+    const float b = fractions[m];
+    const float a = 1.0f - b;
+
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+
+    for (int c = 0; c < channels; ++c)
+    {
+      ax[c] += a * block.Pixels[members[m]][c];
+      bx[c] += b * block.Pixels[members[m]][c];
+    }
+  }
+
+  const float determinant = aa * bb - ab * ab;
+
+  if (fabsf(determinant) < 1e-6f) return false;
+
+  for (int c = 0; c < channels; ++c)
+  {
+    low[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+    high[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+  }
+
+  return true;
+}
+
+static inline int Squared(const int value) noexcept { return value * value; }
+
+static constexpr int s_All[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+static inline int Quantize(const float value, const int levels) noexcept
+{
+  return std::min(std::max(static_cast<int>(value * (levels - 1) / 255.0f + 0.5f), 0), levels - 1);
+}
+
+// BC1 and the color of BC3
+
+static inline uint16_t Pack565(const int r, const int g, const int b) noexcept { return static_cast<uint16_t>((r << 11) | (g << 5) | b); }
+
+static inline uint16_t Pack565(const float color[4]) noexcept { return Pack565(Quantize(color[0], 32), Quantize(color[1], 64), Quantize(color[2], 32)); }
+
+static inline void Unpack565(const uint16_t packed, int color[3]) noexcept
+{
+  const int r = packed >> 11;
+  const int g = (packed >> 5) & 63;
+  const int b = packed & 31;
+
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+// the four colors of c0 and c1 in four color mode, or three and transparent black in three color mode
+static void ColorPalette(const uint16_t c0, const uint16_t c1, const bool fourColors, int palette[4][4]) noexcept
+{
+  Unpack565(c0, palette[0]);
+  Unpack565(c1, palette[1]);
+
+  for (int c = 0; c < 3; ++c)
+  {
+    palette[2][c] = fourColors ? (2 * palette[0][c] + palette[1][c]) / 3 : (palette[0][c] + palette[1][c]) / 2;
+    palette[3][c] = fourColors ? (palette[0][c] + 2 * palette[1][c]) / 3 : 0;
+  }
+
+  for (int i = 0; i < 4; ++i) palette[i][3] = (fourColors || i < 3) ? 255 : 0;
+}
+
+// the nearest of the four colors for every pixel, returns the squared error
+static int ColorIndices(const BlockPixels& block, const uint16_t c0, const uint16_t c1, BYTE indices[16]) noexcept
+{
+  int palette[4][4];
+  int error = 0;
+
+  ColorPalette(c0, c1, true, palette);
+
+  for (int i = 0; i < 16; ++i)
+  {
+    const int* pixel = block.Pixels[i];
+    int best = INT_MAX;
+
+    for (int p = 0; p < 4; ++p)
+    {
+      const int distance = Squared(pixel[0] - palette[p][0]) + Squared(pixel[1] - palette[p][1]) + Squared(pixel[2] - palette[p][2]);
+
+      if (distance < best)
+      {
+        best = distance;
+        indices[i] = static_cast<BYTE>(p);
+      }
+    }
+
+    error += best;
+  }
+
+  return error;
+}
+
+// moves one channel of a 565 color a step up or down, false if that leaves its range
+static bool Step565(uint16_t& color, const int channel, const int delta) noexcept
+{
+  static constexpr int s_Shifts[3] = { 11, 5, 0 };
+  static constexpr int s_Masks[3] = { 31, 63, 31 };
+
+  const int value = ((color >> s_Shifts[channel]) & s_Masks[channel]) + delta;
+
+  if (value < 0 || value > s_Masks[channel]) return false;
+
+  color = static_cast<uint16_t>((color & ~(s_Masks[channel] << s_Shifts[channel])) | (value << s_Shifts[channel]));
+
+  return true;
+}
+
+// 8 bytes of color in four color mode, c0 is kept above c1 since BC1 switches to three colors otherwise
+static void EncodeColor(const BlockPixels& block, const BlockCompressionQuality quality, BYTE* out) noexcept
+{
+  static constexpr float s_Fractions[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+  uint16_t c0;
+  uint16_t c1;
+  BYTE indices[16];
+  bool single = true;
+
+  for (int i = 1; i < 16 && single; ++i) single = (block.Pixels[i][0] == block.Pixels[0][0]) && (block.Pixels[i][1] == block.Pixels[0][1]) && (block.Pixels[i][2] == block.Pixels[0][2]);
+
+  if (single)
+  {
+    // the color at 1/3 of a pair hits a single color closer than any endpoint on its own
+    const auto& tables = SingleColor();
+    const int* pixel = block.Pixels[0];
+
+    c0 = Pack565(tables.Match5[pixel[0]][0], tables.Match6[pixel[1]][0], tables.Match5[pixel[2]][0]);
+    c1 = Pack565(tables.Match5[pixel[0]][1], tables.Match6[pixel[1]][1], tables.Match5[pixel[2]][1]);
+
+    memset(indices, 2, sizeof(indices));
+  }
+  else
+  {
+    float low[4];
+    float high[4];
+
+    AxisEndpoints(block, s_All, 16, 3, low, high);
+
+    c0 = Pack565(high);
+    c1 = Pack565(low);
+
+    int error = ColorIndices(block, c0, c1, indices);
+
+    for (int refinement = 0; refinement < s_Refinements[static_cast<int>(quality)] && error > 0; ++refinement)
+    {
+      float fractions[16];
+      BYTE candidate[16];
+
+      for (int i = 0; i < 16; ++i) fractions[i] = s_Fractions[indices[i]];
+
+      if (!LeastSquares(block, s_All, 16, 3, fractions, high, low)) break;
+
+      const uint16_t r0 = Pack565(high);
+      const uint16_t r1 = Pack565(low);
+      const int refined = ColorIndices(block, r0, r1, candidate);
+
+      if (refined >= error) break;
+
+      c0 = r0;
+      c1 = r1;
+      error = refined;
+      memcpy(indices, candidate, sizeof(indices));
+    }
+
+    // steps each channel of each endpoint while that lowers the error
+    for (bool improved = (quality == BlockCompressionQuality::Best); improved && error > 0;)
+    {
+      improved = false;
+
+      for (int step = 0; step < 12; ++step)
+      {
+        uint16_t moved[2] = { c0, c1 };
+        BYTE candidate[16];
+
+        if (!Step565(moved[step / 6], (step >> 1) % 3, (step & 1) ? 1 : -1)) continue;
+
+        const int stepped = ColorIndices(block, moved[0], moved[1], candidate);
+
+        if (stepped >= error) continue;
+
+        c0 = moved[0];
+        c1 = moved[1];
+        error = stepped;
+        memcpy(indices, candidate, sizeof(indices));
+        improved = true;
+      }
+    }
+  }
+
+  if (c0 < c1)
+  {
+    std::swap(c0, c1);
+
+    for (int i = 0; i < 16; ++i) indices[i] ^= 1;
+  }
+  else if (c0 == c1)
+  {
+    // three color mode, where index 0 is still c0
+    memset(indices, 0, sizeof(indices));
+  }
+
+  uint32_t packed = 0;
+
+  for (int i = 0; i < 16; ++i) packed |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+  out[0] = static_cast<BYTE>(c0);
+  out[1] = static_cast<BYTE>(c0 >> 8);
+  out[2] = static_cast<BYTE>(c1);
+  out[3] = static_cast<BYTE>(c1 >> 8);
+  memcpy(out + 4, &packed, sizeof(packed));
+}
+
+// BC3 alpha
+
+// eight values between a0 and a1, or six and then 0 and 255 if a0 is not above a1
+static void AlphaPalette(const int a0, const int a1, int palette[8]) noexcept
+{
+  palette[0] = a0;
+  palette[1] = a1;
+
+  if (a0 > a1)
+  {
+    for (int i = 2; i < 8; ++i) palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+  }
+  else
+  {
+    for (int i = 2; i < 6; ++i) palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+static int AlphaIndices(const BlockPixels& block, const int a0, const int a1, BYTE indices[16]) noexcept
+{
+  int palette[8];
+  int error = 0;
+
+  AlphaPalette(a0, a1, palette);
+
+  for (int i = 0; i < 16; ++i)
+  {
+    int best = INT_MAX;
+
+    for (int p = 0; p < 8; ++p)
+    {
+      const int distance = Squared(block.Pixels[i][3] - palette[p]);
+
+      if (distance < best)
+      {
+        best = distance;
+        indices[i] = static_cast<BYTE>(p);
+      }
+    }
+
+    error += best;
+  }
+
+  return error;
+}
+
+// 8 bytes of alpha, eight values between the extremes, or six between the extremes apart from 0 and 255
+static void EncodeAlpha(const BlockPixels& block, const BlockCompressionQuality quality, BYTE* out) noexcept
+{
+  int minimum = 255;
+  int maximum = 0;
+  int innerMinimum = 255;
+  int innerMaximum = 0;
+
+  for (int i = 0; i < 16; ++i)
+  {
+    const int alpha = block.Pixels[i][3];
+
+    minimum = std::min(minimum, alpha);
+    maximum = std::max(maximum, alpha);
+
+    if (alpha == 0 || alpha == 255) continue;
+
+    innerMinimum = std::min(innerMinimum, alpha);
+    innerMaximum = std::max(innerMaximum, alpha);
+  }
+
+  int a0 = maximum;
+  int a1 = minimum;
+  BYTE indices[16];
+  BYTE candidate[16];
+  int error = AlphaIndices(block, a0, a1, indices);
+
+  const auto consider = [&](const int c0, const int c1)
+  {
+    const int candidateError = AlphaIndices(block, c0, c1, candidate);
+
+    if (candidateError >= error) return;
+
+    a0 = c0;
+    a1 = c1;
+    error = candidateError;
+    memcpy(indices, candidate, sizeof(indices));
+  };
+
+  if (quality != BlockCompressionQuality::Fast && error > 0 && innerMinimum <= innerMaximum) consider(innerMinimum, innerMaximum);
+
+  if (quality == BlockCompressionQuality::Best && error > 0)
+  {
+    for (int d0 = -2; d0 <= 2; ++d0)
+    {
+      for (int d1 = -2; d1 <= 2; ++d1)
+      {
+        const int c0 = std::min(maximum + d0, 255);
+        const int c1 = std::max(minimum + d1, 0);
+
+        if (c0 > c1) consider(c0, c1);
+      }
+    }
+  }
+
+  uint64_t packed = 0;
+
+  for (int i = 0; i < 16; ++i) packed |= static_cast<uint64_t>(indices[i]) << (3 * i);
+
+  out[0] = static_cast<BYTE>(a0);
+  out[1] = static_cast<BYTE>(a1);
+
+  for (int b = 0; b < 6; ++b) out[2 + b] = static_cast<BYTE>(packed >> (8 * b));
+}
+
+// BC7
+
+// an endpoint channel with its p-bit below it, widened to 8 bits by repeating its highest bits
+static inline int Expand(const int value, const int pBit, const int bits) noexcept
+{
+  const int full = (value << 1) | pBit;
+  const int total = bits + 1;
+
+  return (full << (8 - total)) | (full >> (2 * total - 8));
+}
+
+// the endpoint values and p-bits that come closest to low and high
+// the p-bit is shared by all channels of an endpoint, opaque blocks keep it at 1 since alpha would be 254 without it
+static void QuantizeEndpoints(const float low[4], const float high[4], const Bc7Mode& mode, const bool opaque, SubsetEndpoints& endpoints) noexcept
+{
+  const float* targets[2] = { low, high };
+  const int levels = 1 << mode.EndpointBits;
+  // [endpoint][p-bit]
+  int values[2][2][4] = {};
+  float errors[2][2] = {};
+
+  for (int e = 0; e < 2; ++e)
+  {
+    for (int p = 0; p < 2; ++p)
+    {
+      for (int c = 0; c < mode.Channels; ++c)
+      {
+        const float target = std::min(std::max(targets[e][c], 0.0f), 255.0f);
+        const int guess = static_cast<int>((target * (2 * levels - 1) / 255.0f - p) * 0.5f + 0.5f);
+        float best = std::numeric_limits<float>::max();
+
+        for (int value = std::max(guess - 1, 0); value <= std::min(guess + 1, levels - 1); ++value)
+        {
+          const float delta = Expand(value, p, mode.EndpointBits) - target;
+
+          if (delta * delta < best)
+          {
+            best = delta * delta;
+            values[e][p][c] = value;
+          }
+        }
+
+        errors[e][p] += best;
+      }
+    }
+  }
+
+  for (int e = 0; e < 2; ++e)
+  {
+    int p = mode.SharedPBit ? ((errors[0][1] + errors[1][1] < errors[0][0] + errors[1][0]) ? 1 : 0) : ((errors[e][1] < errors[e][0]) ? 1 : 0);
+
+    if (opaque && mode.Channels == 4) p = 1;
+
+    endpoints.PBits[e] = p;
+    memcpy(endpoints.Values[e], values[e][p], sizeof(endpoints.Values[e]));
+  }
+}
+
+// the colors a subset interpolates between its endpoints, opaque if the mode has no alpha
+static void Bc7Palette(const Bc7Mode& mode, const SubsetEndpoints& endpoints, int palette[16][4]) noexcept
+{
+  const int* weights = (mode.IndexBits == 3) ? s_Weights3 : s_Weights4;
+
+  for (int c = 0; c < 4; ++c)
+  {
+    const bool present = (c < mode.Channels);
+    const int e0 = present ? Expand(endpoints.Values[0][c], endpoints.PBits[0], mode.EndpointBits) : 255;
+    const int e1 = present ? Expand(endpoints.Values[1][c], endpoints.PBits[1], mode.EndpointBits) : 255;
+
+    for (int i = 0; i < (1 << mode.IndexBits); ++i) palette[i][c] = ((64 - weights[i]) * e0 + weights[i] * e1 + 32) >> 6;
+  }
+}
+
+// the nearest palette entry for every member of a subset, returns the squared error
+static int SubsetIndices(const BlockPixels& block, const int* members, const int count, const Bc7Mode& mode, const SubsetEndpoints& endpoints, BYTE indices[16]) noexcept
+{
+  int palette[16][4];
+  int error = 0;
+
+  Bc7Palette(mode, endpoints, palette);
+
+  for (int m = 0; m < count; ++m)
+  {
+    const int* pixel = block.Pixels[members[m]];
+    int best = INT_MAX;
+
+    for (int i = 0; i < (1 << mode.IndexBits); ++i)
+    {
+      int distance = 0;
+
+      for (int c = 0; c < mode.Channels; ++c) distance += Squared(pixel[c] - palette[i][c]);
+
+      if (distance < best)
+      {
+        best = distance;
+        indices[members[m]] = static_cast<BYTE>(i);
+      }
+    }
+
+    error += best;
+  }
+
+  return error;
+}
+
+// endpoints and indices of the members of a subset, returns the squared error
+static int FitSubset(const BlockPixels& block, const int* members, const int count, const Bc7Mode& mode, const int refinements, SubsetEndpoints& endpoints, BYTE indices[16]) noexcept
+{
+  const int* weights = (mode.IndexBits == 3) ? s_Weights3 : s_Weights4;
+  float low[4];
+  float high[4];
+
+  AxisEndpoints(block, members, count, mode.Channels, low, high);
+  QuantizeEndpoints(low, high, mode, block.Opaque, endpoints);
+
+  int error = SubsetIndices(block, members, count, mode, endpoints, indices);
+
+  for (int refinement = 0; refinement < refinements && error > 0; ++refinement)
+  {
+    float fractions[16];
+
+    for (int m = 0; m < count; ++m) fractions[m] = weights[indices[members[m]]] / 64.0f;
+
+    if (!LeastSquares(block, members, count, mode.Channels, fractions, low, high)) break;
+
+    SubsetEndpoints refined;
+    BYTE candidate[16];
+
+    memcpy(candidate, indices, sizeof(candidate));
+    QuantizeEndpoints(low, high, mode, block.Opaque, refined);
+
+    const int refinedError = SubsetIndices(block, members, count, mode, refined, candidate);
+
+    if (refinedError >= error) break;
+
+    endpoints = refined;
+    error = refinedError;
+    memcpy(indices, candidate, sizeof(candidate));
+  }
+
+  return error;
+}
+
+// the squared distances of the members of a subset from the line through them along their principal axis
+static float LineError(const BlockPixels& block, const int* members, const int count) noexcept
+{
+  float mean[4];
+  float axis[4];
+  float error = 0.0f;
+
+  PrincipalAxis(block, members, count, 3, mean, axis);
+
+  for (int m = 0; m < count; ++m)
+  {
+    float along = 0.0f;
+
+    for (int c = 0; c < 3; ++c)
+    {
+      const float delta = block.Pixels[members[m]][c] - mean[c];
+
+      along += delta * axis[c];
+      error += delta * delta;
+    }
+
+    error -= along * along;
+  }
+
+  return error;
+}
+
+static int PartitionMembers(const int partition, const int subset, int members[16]) noexcept
+{
+  int count = 0;
+
+  for (int i = 0; i < 16; ++i)
+  {
+    if (((s_Partitions2[partition] >> i) & 1) == subset) members[count++] = i;
+  }
+
+  return count;
+}
+
+static inline int PartitionSubset(const int partition, const int pixel) noexcept { return (s_Partitions2[partition] >> pixel) & 1; }
+
+static void WriteMode6(SubsetEndpoints endpoints, BYTE indices[16], BYTE* out) noexcept
+{
+  // the index of pixel 0 is written without its highest bit, the order of the endpoints makes it 0
+  if (indices[0] & 8)
+  {
+    std::swap(endpoints.Values[0], endpoints.Values[1]);
+    std::swap(endpoints.PBits[0], endpoints.PBits[1]);
+
+    for (int i = 0; i < 16; ++i) indices[i] = static_cast<BYTE>(15 - indices[i]);
+  }
+
+  BlockBits bits;
+
+  bits.Write(1 << 6, 7);
+
+  for (int c = 0; c < 4; ++c)
+  {
+    for (int e = 0; e < 2; ++e) bits.Write(endpoints.Values[e][c], 7);
+  }
+
+  bits.Write(endpoints.PBits[0], 1);
+  bits.Write(endpoints.PBits[1], 1);
+
+  for (int i = 0; i < 16; ++i) bits.Write(indices[i], i ? 4 : 3);
+
+  memcpy(out, bits.Bits, sizeof(bits.Bits));
+}
+
+static void WriteMode1(const int partition, SubsetEndpoints (&subsets)[2], BYTE indices[16], BYTE* out) noexcept
+{
+  const int anchors[2] = { 0, s_Anchors2[partition] };
+
+  for (int s = 0; s < 2; ++s)
+  {
+    if (!(indices[anchors[s]] & 4)) continue;
+
+    std::swap(subsets[s].Values[0], subsets[s].Values[1]);
+
+    for (int i = 0; i < 16; ++i)
+    {
+      if (PartitionSubset(partition, i) == s) indices[i] = static_cast<BYTE>(7 - indices[i]);
+    }
+  }
+
+  BlockBits bits;
+
+  bits.Write(1 << 1, 2);
+  bits.Write(partition, 6);
+
+  for (int c = 0; c < 3; ++c)
+  {
+    for (int s = 0; s < 2; ++s)
+    {
+      for (int e = 0; e < 2; ++e) bits.Write(subsets[s].Values[e][c], 6);
+    }
+  }
+
+  bits.Write(subsets[0].PBits[0], 1);
+  bits.Write(subsets[1].PBits[0], 1);
+
+  for (int i = 0; i < 16; ++i) bits.Write(indices[i], (i == anchors[0] || i == anchors[1]) ? 2 : 3);
+
+  memcpy(out, bits.Bits, sizeof(bits.Bits));
+}
+
+// 16 bytes in mode 6, or in mode 1 if one of its partitions comes closer to an opaque block
+static void EncodeBc7(const BlockPixels& block, const BlockCompressionQuality quality, BYTE* out) noexcept
+{
+  const int refinements = s_Refinements[static_cast<int>(quality)];
+  SubsetEndpoints endpoints;
+  BYTE indices[16];
+  int error = FitSubset(block, s_All, 16, s_Mode6, refinements, endpoints, indices);
+
+  WriteMode6(endpoints, indices, out);
+
+  if (quality != BlockCompressionQuality::Best || !block.Opaque || error == 0) return;
+
+  // partitions ranked by how close both of their subsets are to a line
+  std::pair<float, int> ranked[64];
+  int members[2][16];
+  int counts[2];
+
+  for (int partition = 0; partition < 64; ++partition)
+  {
+    for (int s = 0; s < 2; ++s) counts[s] = PartitionMembers(partition, s, members[s]);
+
+    ranked[partition] = { LineError(block, members[0], counts[0]) + LineError(block, members[1], counts[1]), partition };
+  }
+
+  std::partial_sort(ranked, ranked + s_PartitionCandidates, ranked + 64);
+
+  for (int candidate = 0; candidate < s_PartitionCandidates; ++candidate)
+  {
+    const int partition = ranked[candidate].second;
+    SubsetEndpoints subsets[2];
+    int partitionError = 0;
+
+    for (int s = 0; s < 2; ++s)
+    {
+      counts[s] = PartitionMembers(partition, s, members[s]);
+      partitionError += FitSubset(block, members[s], counts[s], s_Mode1, refinements, subsets[s], indices);
+    }
+
+    if (partitionError >= error) continue;
+
+    error = partitionError;
+    WriteMode1(partition, subsets, indices, out);
+  }
+}
+
+// reference decoder
+
+static void DecodeColor(const BYTE* in, const bool fourColors, BYTE (&decoded)[16][4]) noexcept
+{
+  const uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+  const uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+  uint32_t indices;
+  int palette[4][4];
+
+  memcpy(&indices, in + 4, sizeof(indices));
+  ColorPalette(c0, c1, fourColors || c0 > c1, palette);
+
+  for (int i = 0; i < 16; ++i)
+  {
+    for (int c = 0; c < 4; ++c) decoded[i][c] = static_cast<BYTE>(palette[(indices >> (2 * i)) & 3][c]);
+  }
+}
+
+static void DecodeAlpha(const BYTE* in, BYTE (&decoded)[16][4]) noexcept
+{
+  uint64_t indices = 0;
+  int palette[8];
+
+  for (int b = 0; b < 6; ++b) indices |= static_cast<uint64_t>(in[2 + b]) << (8 * b);
+
+  AlphaPalette(in[0], in[1], palette);
+
+  for (int i = 0; i < 16; ++i) decoded[i][3] = static_cast<BYTE>(palette[(indices >> (3 * i)) & 7]);
+}
+
+static bool DecodeBc7(const BYTE* in, BYTE (&decoded)[16][4]) noexcept
+{
+  BlockBits bits;
+  SubsetEndpoints subsets[2];
+  int palettes[2][16][4];
+
+  memcpy(bits.Bits, in, sizeof(bits.Bits));
+
+  if ((in[0] & 0x7F) == 0x40)
+  {
+    bits.Read(7);
+
+    for (int c = 0; c < 4; ++c)
+    {
+      for (int e = 0; e < 2; ++e) subsets[0].Values[e][c] = bits.Read(7);
+    }
+
+    subsets[0].PBits[0] = bits.Read(1);
+    subsets[0].PBits[1] = bits.Read(1);
+    Bc7Palette(s_Mode6, subsets[0], palettes[0]);
+
+    for (int i = 0; i < 16; ++i)
+    {
+      const int index = bits.Read(i ? 4 : 3);
+
+      for (int c = 0; c < 4; ++c) decoded[i][c] = static_cast<BYTE>(palettes[0][index][c]);
+    }
+
+    return true;
+  }
+
+  if ((in[0] & 0x03) == 0x02)
+  {
+    bits.Read(2);
+
+    const int partition = bits.Read(6);
+    const int anchor = s_Anchors2[partition];
+
+    for (int c = 0; c < 3; ++c)
+    {
+      for (int s = 0; s < 2; ++s)
+      {
+        for (int e = 0; e < 2; ++e) subsets[s].Values[e][c] = bits.Read(6);
+      }
+    }
+
+    for (int s = 0; s < 2; ++s)
+    {
+      subsets[s].PBits[0] = subsets[s].PBits[1] = bits.Read(1);
+      Bc7Palette(s_Mode1, subsets[s], palettes[s]);
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+      const int index = bits.Read((i == 0 || i == anchor) ? 2 : 3);
+
+      for (int c = 0; c < 4; ++c) decoded[i][c] = static_cast<BYTE>(palettes[PartitionSubset(partition, i)][index][c]);
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+UINT BlockCompressor::BlockSize(DXGI_FORMAT format) noexcept
+{
+  switch (format)
+  {
+  case DXGI_FORMAT_BC1_UNORM:
+    return 8;
+
+  case DXGI_FORMAT_BC3_UNORM:
+  case DXGI_FORMAT_BC7_UNORM:
+    return 16;
+
+  default:
+    return 0;
+  }
+}
+
+bool BlockCompressor::Compress(const BYTE* pixels, UINT width, UINT height, DXGI_FORMAT source, DXGI_FORMAT target, BlockCompressionQuality quality, BYTE* blocks, UINT threads)
+{
+  const UINT blockSize = BlockSize(target);
+
+  if (!blockSize || !width || !height) return false;
+
+  if (source != DXGI_FORMAT_R8G8B8A8_UNORM && source != DXGI_FORMAT_B8G8R8A8_UNORM && source != DXGI_FORMAT_B8G8R8X8_UNORM) return false;
+
+  const UINT blocksWide = (width + 3) / 4;
+
+  ForEachBlockRow((height + 3) / 4, threads, [=](const UINT row)
+  {
+    BlockPixels block;
+    BYTE* out = blocks + static_cast<size_t>(row) * blocksWide * blockSize;
+
+    for (UINT column = 0; column < blocksWide; ++column, out += blockSize)
+    {
+      LoadBlock(pixels, width, height, source, column, row, block);
+
+      if (target == DXGI_FORMAT_BC1_UNORM)
+      {
+        EncodeColor(block, quality, out);
+      }
+      else if (target == DXGI_FORMAT_BC3_UNORM)
+      {
+        EncodeAlpha(block, quality, out);
+        EncodeColor(block, quality, out + 8);
+      }
+      else
+      {
+        EncodeBc7(block, quality, out);
+      }
+    }
+  });
+
+  return true;
+}
+
+bool BlockCompressor::Decompress(const BYTE* blocks, UINT width, UINT height, DXGI_FORMAT format, BYTE* pixels)
+{
+  const UINT blockSize = BlockSize(format);
+
+  if (!blockSize) return false;
+
+  for (UINT row = 0; row < (height + 3) / 4; ++row)
+  {
+    for (UINT column = 0; column < (width + 3) / 4; ++column, blocks += blockSize)
+    {
+      BYTE decoded[16][4];
+
+      if (format == DXGI_FORMAT_BC1_UNORM)
+      {
+        DecodeColor(blocks, false, decoded);
+      }
+      else if (format == DXGI_FORMAT_BC3_UNORM)
+      {
+        // the color of BC3 always has four colors
+        DecodeColor(blocks + 8, true, decoded);
+        DecodeAlpha(blocks, decoded);
+      }
+      else if (!DecodeBc7(blocks, decoded))
+      {
+        return false;
+      }
+
+      StoreBlock(decoded, width, height, column, row, pixels);
+    }
+  }
+
+  return true;
+}
+
+double BlockCompressor::PSNR(const BYTE* reference, DXGI_FORMAT source, const BYTE* pixels, size_t count) noexcept
+{
+  const bool bgr = (source != DXGI_FORMAT_R8G8B8A8_UNORM);
+  const int channels = (source == DXGI_FORMAT_B8G8R8X8_UNORM) ? 3 : 4;
+  double error = 0.0;
+
+  for (size_t i = 0; i < count; ++i, reference += 4, pixels += 4)
+  {
+    const int expected[4] = { reference[bgr ? 2 : 0], reference[1], reference[bgr ? 0 : 2], reference[3] };
+
+    for (int c = 0; c < channels; ++c) error += Squared(expected[c] - pixels[c]);
+  }
+
+  if (error == 0.0) return std::numeric_limits<double>::infinity();
+
+  return 10.0 * log10(255.0 * 255.0 * count * channels / error);
+}
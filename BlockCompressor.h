@@ -0,0 +1,36 @@
+#pragma once
+
+enum class BlockCompressionQuality
+{
+  Fast,     // endpoints at the ends of the principal axis of each block
+  Normal,   // Fast refined by least squares
+  Best,     // Normal refined further, BC1 and BC3 search around the endpoints, BC7 also tries the two subset partitions of mode 1 on opaque blocks
+};
+
+// block compression of 8 bit levels for upload as BC1, BC3 or BC7, every 4x4 block is encoded on its own so the rows of blocks are spread across threads
+// BC1 holds opaque color in 4 bits per pixel, BC3 adds interpolated alpha in 8 bits per pixel, BC7 holds RGBA in 8 bits per pixel at a much higher quality
+// BC7 is written in mode 6 (one subset, RGBA) and mode 1 (two subsets, RGB) only
+// nothing but DXGI_FORMAT is needed from Direct3D, so the encoder and its reference decoder also build for tests outside the engine
+class BlockCompressor
+{
+public:
+  // bytes per 4x4 block of BC1, BC3 and BC7, 0 for every other format
+  static UINT BlockSize(DXGI_FORMAT format) noexcept;
+
+  // encodes rows of width RGBA8, BGRA8 or BGRX8 pixels without padding into rows of blocks without padding
+  // partial blocks at the right and bottom repeat the last column and row, BC1 drops alpha
+  // the rows of blocks are spread across up to threads threads, 0 uses one per core
+  static bool Compress(const BYTE* pixels, UINT width, UINT height, DXGI_FORMAT source, DXGI_FORMAT target, BlockCompressionQuality quality, BYTE* blocks, UINT threads = 0);
+
+  // the reference decoder, writes rows of width RGBA8 pixels without padding
+  // decodes every BC1 and BC3 block, but only the BC7 modes Compress writes and fails on the others
+  static bool Decompress(const BYTE* blocks, UINT width, UINT height, DXGI_FORMAT format, BYTE* pixels);
+
+  // peak signal to noise ratio in dB of count RGBA8 pixels against the reference pixels in source format, alpha is left out for BGRX8
+  static double PSNR(const BYTE* reference, DXGI_FORMAT source, const BYTE* pixels, size_t count) noexcept;
+
+private:
+  BlockCompressor(void) noexcept = delete;
+  ~BlockCompressor(void) noexcept = delete;
+
+};
@@ -10,11 +10,11 @@ constexpr const float min_float = std::numeric_limits<float>::min();
 static BoundingVolumeTestType s_Type = BoundingVolumeTestType::AABB;
 BoundingVolumeTestType BoundingVolume::TestType = BoundingVolumeTestType::Sphere;
 
-BoundingVolume::BoundingVolume(std::vector<Vertex>& vertices) noexcept
+LocalBounds::LocalBounds(const std::vector<Vertex>& vertices) noexcept
 {
-	BoundingBox::CreateFromPoints(m_AABB, vertices.size(), (XMFLOAT3*)vertices.data(), sizeof(Vertex));
-	BoundingSphere::CreateFromPoints(m_Sphere, vertices.size(), (XMFLOAT3*)vertices.data(), sizeof(Vertex));
-	BoundingOrientedBox::CreateFromPoints(m_OBB, vertices.size(), (XMFLOAT3*)vertices.data(), sizeof(Vertex));
+	BoundingBox::CreateFromPoints(AABB, vertices.size(), &vertices.data()->Position, sizeof(Vertex));
+	BoundingSphere::CreateFromPoints(Sphere, vertices.size(), &vertices.data()->Position, sizeof(Vertex));
+	BoundingOrientedBox::CreateFromPoints(OBB, vertices.size(), &vertices.data()->Position, sizeof(Vertex));
 }
 
 bool BoundingVolume::Intersects(BoundingVolume* other, XMFLOAT3& resolution) noexcept
@@ -31,6 +31,8 @@ bool BoundingVolume::Intersects(BoundingVolume* other, XMFLOAT3& resolution) noe
 
 void BoundingVolume::Update(XMFLOAT3* position, XMFLOAT4* rotation) noexcept
 {
+	if (!m_Local) return;
+
 	// make some static constants to use every time
 	static const XMVECTOR scale = { 1.0f, 1.0f, 1.0f, 1.0f };
 	static const XMVECTOR origin = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -41,9 +43,9 @@ void BoundingVolume::Update(XMFLOAT3* position, XMFLOAT4* rotation) noexcept
 
 	const auto transform = XMMatrixAffineTransformation(scale, origin, vrot, vpos);
 
-	m_OBB.Transform(m_OBBTransformed, transform);
-	m_AABB.Transform(m_AABBTransformed, transform);
-	m_Sphere.Transform(m_SphereTransformed, transform);
+	m_Local->OBB.Transform(m_OBBTransformed, transform);
+	m_Local->AABB.Transform(m_AABBTransformed, transform);
+	m_Local->Sphere.Transform(m_SphereTransformed, transform);
 }
 
 bool BoundingVolume::SimpleCollisionCheck(const std::vector<BoundingVolume*>& models) noexcept
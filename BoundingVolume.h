@@ -9,11 +9,25 @@ enum class BoundingVolumeTestType
 	Sphere,
 };
 
+// the bounds of a shape in its own space, computed once and shared by every BoundingVolume placed from it
+struct LocalBounds
+{
+	LocalBounds(void) noexcept = default;
+	LocalBounds(const std::vector<Vertex>& vertices) noexcept;
+	LocalBounds(const BoundingBox& aabb, const BoundingSphere& sphere, const BoundingOrientedBox& obb) noexcept : AABB(aabb), Sphere(sphere), OBB(obb) {}
+
+	BoundingBox AABB;
+	BoundingSphere Sphere;
+	BoundingOrientedBox OBB;
+};
+
+// places LocalBounds in the world, only the transformed bounds are stored per instance
 class BoundingVolume
 {
 public:
 	BoundingVolume(void) noexcept = default;
-	BoundingVolume(std::vector<Vertex>& vertices) noexcept;
+	// local has to outlive the BoundingVolume
+	BoundingVolume(const LocalBounds& local) noexcept : m_Local(&local) {}
 	~BoundingVolume(void) noexcept = default;
 
 	bool Intersects(BoundingVolume* other, XMFLOAT3& resolution) noexcept;
@@ -27,9 +41,7 @@ public:
 	bool insectCheckAABBSphere(const BoundingSphere& sphere, XMFLOAT3&) const noexcept;
 	bool insectCheckOBBSphere(const BoundingSphere& sphere, XMFLOAT3&) const noexcept;
 
-	BoundingBox m_AABB;
-	BoundingSphere m_Sphere;
-	BoundingOrientedBox m_OBB;
+	const LocalBounds* m_Local = nullptr;
 	BoundingBox m_AABBTransformed;
 	BoundingSphere m_SphereTransformed;
 	BoundingOrientedBox m_OBBTransformed;
@@ -24,19 +24,24 @@ static float aspect = 0.0f;
 
 BoundingFrustum _Frustum;
 
+static LocalBounds s_BodyBounds;
+static LocalBounds s_FrustumBounds;
+
 bool Camera::Init(const uint32_t width, const uint32_t height) noexcept
 {
 	aspect = static_cast<float>(width) / static_cast<float>(height);
 
-	m_Body = BoundingVolume(
+	s_BodyBounds = LocalBounds(
 		std::vector<Vertex> {
 			{ { -0.25f, -1.0f, -0.25f }, {}, {} },
 			{ {  0.25f,  0.7f,  0.25f }, {}, {} }
 		}
 	);
 
-	m_Body.m_Sphere.Center = { 0.0f, 0.0f, 0.0f };
-	m_Body.m_Sphere.Radius = 0.25f;
+	s_BodyBounds.Sphere.Center = { 0.0f, 0.0f, 0.0f };
+	s_BodyBounds.Sphere.Radius = 0.25f;
+
+	m_Body = BoundingVolume(s_BodyBounds);
 
 	BoundingFrustum::CreateFromMatrix(_Frustum, XMLoadFloat4x4(&GetProjectionMatrix()));
 
@@ -47,7 +52,8 @@ bool Camera::Init(const uint32_t width, const uint32_t height) noexcept
 
 	for (const auto& vertex : fp) vertices.push_back(Vertex(vertex, {}, {}));
 
-	m_Frustum = BoundingVolume(vertices);
+	s_FrustumBounds = LocalBounds(vertices);
+	m_Frustum = BoundingVolume(s_FrustumBounds);
 
 	return true;
 }
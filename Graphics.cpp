@@ -5,6 +5,7 @@
 #include "Keyboard.h"
 
 #include "DeviceManager.h"
+#include "TextureCache.h"
 #include "LevelRenderer.h"
 #include "ImageRenderer.h"
 
@@ -114,6 +115,9 @@ bool Graphics::Sync()
     WaitForSingleObject(m_fenceEvent, INFINITE);
   }
 
+  // the GPU is past every frame submitted so far, the textures dropped during them can go
+  TextureCache::Collect(m_fence->GetCompletedValue(), m_fenceValue);
+
   m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
 
   return true;
@@ -125,6 +129,8 @@ void Graphics::Release()
     m_renderer->Release();
     delete(m_renderer);
   }
+  // waits for the GPU, so the textures the renderer dropped are released before the device
+  if (m_commandQueue && m_fence) Sync();
   // internal release
   for (int i = 0; i < sizeof(m_renderTargets) / sizeof(m_renderTargets[0]); i++) {
     if (m_renderTargets[i]) m_renderTargets[i].Reset();
@@ -209,84 +209,17 @@ bool ImageRenderer::CreateRootSignature(ComPtr<ID3D12Device>& device)
 
 bool ImageRenderer::LoadTexture(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList)
 {
-  // Load the image from file
-  D3D12_RESOURCE_DESC textureDesc;
-  int imageBytesPerRow;
-  BYTE* imageData;
-  auto imageSize = TextureLoader::LoadImageDataFromFile(
-    &imageData,
-    textureDesc,
-    L"thm.png",
-    imageBytesPerRow
-  );
-
-  // make sure we have data
-  if (imageSize <= 0)
+  TextureImage image;
+
+  // every mip level is uploaded with it
+  if (!image.Open(L"thm.png") || !TextureLoader::CreateTexture(device.Get(), commandList.Get(), image, textureBuffer, textureBufferUploadHeap))
   {
     Log::Info("loading of texture failed");
 
     return false;
   }
 
-  // create a default heap where the upload heap will copy its contents into (contents being the texture)
-  if (
-    FAILED(
-      device->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), // a default heap
-        D3D12_HEAP_FLAG_NONE, // no flags
-        &textureDesc, // the description of our texture
-        D3D12_RESOURCE_STATE_COPY_DEST, // We will copy the texture from the upload heap to here, so we start it out in a copy dest state
-        nullptr, // used for render targets and depth/stencil buffers
-        IID_PPV_ARGS(&textureBuffer)
-      )
-    )
-  )
-  {
-    return false;
-  }
-  textureBuffer->SetName(L"Texture Buffer Resource Heap");
-
-  UINT64 textureUploadBufferSize;
-  // this function gets the size an upload buffer needs to be to upload a texture to the gpu.
-  // each row must be 256 byte aligned except for the last row, which can just be the size in bytes of the row
-  // eg. textureUploadBufferSize = ((((width * numBytesPerPixel) + 255) & ~255) * (height - 1)) + (width * numBytesPerPixel);
-  //textureUploadBufferSize = (((imageBytesPerRow + 255) & ~255) * (textureDesc.Height - 1)) + imageBytesPerRow;
-  device->GetCopyableFootprints(&textureDesc, 0, 1, 0, nullptr, nullptr, nullptr, &textureUploadBufferSize);
-
-  // now we create an upload heap to upload our texture to the GPU
-  if (
-    FAILED(
-      device->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
-        D3D12_HEAP_FLAG_NONE, // no flags
-        &CD3DX12_RESOURCE_DESC::Buffer(textureUploadBufferSize), // resource description for a buffer (storing the image data in this heap just to copy to the default heap)
-        D3D12_RESOURCE_STATE_GENERIC_READ, // We will copy the contents from this heap to the default heap above
-        nullptr,
-        IID_PPV_ARGS(&textureBufferUploadHeap))
-      )
-    )
-  {
-    return false;
-  }
-  textureBufferUploadHeap->SetName(L"Texture Buffer Upload Resource Heap");
-
-  // store vertex buffer in upload heap
-  D3D12_SUBRESOURCE_DATA textureData = {};
-  textureData.pData = &imageData[0]; // pointer to our image data
-  textureData.RowPitch = imageBytesPerRow; // size of all our triangle vertex data
-  textureData.SlicePitch = imageBytesPerRow * textureDesc.Height; // also the size of our triangle vertex data
-
-  // Now we copy the upload buffer contents to the default heap
-  UpdateSubresources(
-    commandList.Get(),
-    textureBuffer.Get(),
-    textureBufferUploadHeap.Get(),
-    0, 0, 1,
-    &textureData
-  );
-
-  // transition the texture default heap to a pixel shader resource (we will be sampling from this heap in the pixel shader to get the color of pixels)
-  commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(textureBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+  const D3D12_RESOURCE_DESC textureDesc = textureBuffer->GetDesc();
 
   // create the descriptor heap that will store our srv
   D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
@@ -304,11 +237,8 @@ bool ImageRenderer::LoadTexture(ComPtr<ID3D12Device>& device, ComPtr<ID3D12Graph
   srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
   srvDesc.Format = textureDesc.Format;
   srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-  srvDesc.Texture2D.MipLevels = 1;
+  srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
   device->CreateShaderResourceView(textureBuffer.Get(), &srvDesc, mainDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
-  // we are done with image data now that we've uploaded it to the gpu, so free it up
-  delete imageData;
-
   return true;
 }
@@ -0,0 +1,141 @@
+#include "ImportCache.h"
+
+#include "MappedFile.h"
+
+static constexpr uint64_t s_Prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t s_Prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t s_Prime3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t s_Prime4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t s_Prime5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t Rotate(const uint64_t value, const int bits) noexcept { return (value << bits) | (value >> (64 - bits)); }
+
+static inline uint64_t Read64(const char* p) noexcept
+{
+  uint64_t value;
+
+  memcpy(&value, p, sizeof(value));
+
+  return value;
+}
+
+static inline uint32_t Read32(const char* p) noexcept
+{
+  uint32_t value;
+
+  memcpy(&value, p, sizeof(value));
+
+  return value;
+}
+
+static inline uint64_t Round(const uint64_t accumulator, const uint64_t input) noexcept { return Rotate(accumulator + input * s_Prime2, 31) * s_Prime1; }
+
+static inline uint64_t MergeRound(const uint64_t hash, const uint64_t accumulator) noexcept { return (hash ^ Round(0, accumulator)) * s_Prime1 + s_Prime4; }
+
+uint64_t ImportCache::Hash(const char* data, size_t size, uint64_t seed) noexcept
+{
+  const char* p = data;
+  const char* const end = data + size;
+  uint64_t hash;
+
+  // four independent lanes of 8 bytes each, the bulk of a file goes through here
+  if (size >= 32)
+  {
+    uint64_t lanes[4] = { seed + s_Prime1 + s_Prime2, seed + s_Prime2, seed, seed - s_Prime1 };
+
+    for (; p + 32 <= end; p += 32)
+    {
+      lanes[0] = Round(lanes[0], Read64(p));
+      lanes[1] = Round(lanes[1], Read64(p + 8));
+      lanes[2] = Round(lanes[2], Read64(p + 16));
+      lanes[3] = Round(lanes[3], Read64(p + 24));
+    }
+
+    hash = Rotate(lanes[0], 1) + Rotate(lanes[1], 7) + Rotate(lanes[2], 12) + Rotate(lanes[3], 18);
+
+    for (const auto lane : lanes) hash = MergeRound(hash, lane);
+  }
+  else
+  {
+    hash = seed + s_Prime5;
+  }
+
+  hash += size;
+
+  for (; p + 8 <= end; p += 8) hash = Rotate(hash ^ Round(0, Read64(p)), 27) * s_Prime1 + s_Prime4;
+
+  if (p + 4 <= end)
+  {
+    hash = Rotate(hash ^ (Read32(p) * s_Prime1), 23) * s_Prime2 + s_Prime3;
+    p += 4;
+  }
+
+  for (; p < end; ++p) hash = Rotate(hash ^ (static_cast<uint8_t>(*p) * s_Prime5), 11) * s_Prime1;
+
+  hash ^= hash >> 33;
+  hash *= s_Prime2;
+  hash ^= hash >> 29;
+  hash *= s_Prime3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+bool ImportCache::ArtifactFileName(const std::string& source, uint32_t version, const std::string& extension, std::string& artifact, Dependencies dependencies)
+{
+  MappedFile file;
+
+  if (!file.Open(source)) return false;
+
+  uint64_t hash = Hash(file.Data(), file.Size(), version);
+
+  if (dependencies)
+  {
+    // the same source in another directory references other files
+    const auto directory = source.substr(0, source.find_last_of("/\\") + 1);
+
+    hash = Hash(directory.data(), directory.size(), hash);
+
+    std::vector<std::string> names;
+
+    dependencies(file.Data(), file.Size(), names);
+
+    for (const auto& name : names)
+    {
+      hash = Hash(name.data(), name.size(), hash);
+
+      // a missing dependency only contributes its name, the artifact changes once it appears
+      MappedFile dependency;
+
+      if (dependency.Open(directory + name)) hash = Hash(dependency.Data(), dependency.Size(), hash + 1);
+    }
+  }
+
+  char name[17];
+
+  snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+  artifact = std::string(Directory) + "/" + name + extension;
+
+  // the caller writes the artifact if it does not exist yet, fails harmlessly if the directory is already there
+  CreateDirectoryA(Directory, nullptr);
+
+  return true;
+}
+
+bool ImportCache::Store(const std::string& artifact, const void* header, size_t headerSize, const void* data, size_t size)
+{
+  // threads importing the same content at once each write their own temporary file, the last move wins
+  const auto temporary = artifact + "." + std::to_string(GetCurrentThreadId()) + ".tmp";
+
+  {
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+
+    output.write(static_cast<const char*>(header), headerSize);
+    output.write(static_cast<const char*>(data), size);
+
+    if (!output.good()) return false;
+  }
+
+  return MoveFileExA(temporary.c_str(), artifact.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// cooked artifacts of source assets, stored in Directory under the hash of the source content and the importer version
+// an artifact never goes stale: a changed source or importer maps to a new name, the old artifact is simply not used anymore
+class ImportCache
+{
+public:
+  static constexpr const char* Directory = "cache";
+
+  // lists the files a source references by names relative to its directory, like the material libraries of an OBJ
+  typedef void (*Dependencies)(const char* data, size_t size, std::vector<std::string>& dependencies);
+
+  // "cache/0123456789abcdef.mesh" for source and creates the directory, false if the source can not be read
+  // version is that of the importer and its artifact format, raising it invalidates every artifact of the importer
+  // with dependencies the directory of source and the content of every file they list are part of the name as well
+  static bool ArtifactFileName(const std::string& source, uint32_t version, const std::string& extension, std::string& artifact, Dependencies dependencies = nullptr);
+
+  static inline bool Exists(const std::string& artifact) noexcept { return GetFileAttributesA(artifact.c_str()) != INVALID_FILE_ATTRIBUTES; }
+
+  // writes header followed by data through a temporary file, so a crash never leaves a partial artifact behind
+  static bool Store(const std::string& artifact, const void* header, size_t headerSize, const void* data, size_t size);
+
+  // 64 bit xxHash of size bytes
+  static uint64_t Hash(const char* data, size_t size, uint64_t seed) noexcept;
+
+private:
+  ImportCache(void) noexcept = delete;
+  ~ImportCache(void) noexcept = delete;
+
+};
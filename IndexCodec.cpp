@@ -0,0 +1,166 @@
+#include "IndexCodec.h"
+
+#include <intrin.h>
+#include <tmmintrin.h>
+
+static inline uint32_t ZigZag(const DWORD index, const DWORD previous) noexcept
+{
+  const auto delta = static_cast<int32_t>(index - previous);
+
+  return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+}
+
+static inline DWORD UnZigZag(const uint32_t value) noexcept { return (value >> 1) ^ (0u - (value & 1)); }
+
+static inline UINT ByteLength(const uint32_t value) noexcept
+{
+  if (value < (1u << 8)) return 1;
+  if (value < (1u << 16)) return 2;
+  if (value < (1u << 24)) return 3;
+
+  return 4;
+}
+
+// pshufb masks that move the bytes of four values into four 32 bit lanes, one per control byte
+struct ShuffleTable
+{
+  alignas(16) BYTE Shuffle[256][16];
+  BYTE Length[256];
+
+  ShuffleTable(void) noexcept
+  {
+    for (UINT key = 0; key < 256; ++key)
+    {
+      BYTE offset = 0;
+
+      for (UINT lane = 0; lane < 4; ++lane)
+      {
+        const UINT length = ((key >> (lane * 2)) & 3) + 1;
+
+        for (UINT b = 0; b < 4; ++b) Shuffle[key][lane * 4 + b] = b < length ? offset++ : 0x80;
+      }
+
+      Length[key] = offset;
+    }
+  }
+};
+
+static const ShuffleTable s_Table;
+
+static bool SupportsSSSE3(void) noexcept
+{
+  int info[4];
+
+  __cpuid(info, 1);
+
+  return (info[2] & (1 << 9)) != 0;
+}
+
+static const bool s_SSSE3 = SupportsSSSE3();
+
+static inline void Store(uint32_t* indices, const __m128i values) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), values); }
+
+static inline void Store(uint16_t* indices, const __m128i values) noexcept
+{
+  // the low halves of all lanes, the caller made sure every index fits
+  const __m128i low = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(indices), _mm_shuffle_epi8(values, low));
+}
+
+template <typename T>
+static bool DecodeBlocks(const BYTE* data, size_t size, size_t count, T* indices) noexcept
+{
+  const BYTE* end = data + size;
+  DWORD previous = 0;
+
+  for (size_t block = 0; block < count; block += IndexCodec::BlockSize)
+  {
+    const size_t n = std::min(IndexCodec::BlockSize, count - block);
+    const BYTE* control = data;
+
+    if (static_cast<size_t>(end - data) < (n + 3) / 4) return false;
+
+    data += (n + 3) / 4;
+
+    size_t i = 0;
+
+    // four indices per step, as long as a full 16 byte load stays inside the stream
+    if (s_SSSE3)
+    {
+      const __m128i one = _mm_set1_epi32(1);
+      __m128i last = _mm_set1_epi32(static_cast<int>(previous));
+
+      for (; i + 4 <= n && end - data >= 16; i += 4)
+      {
+        const BYTE key = control[i / 4];
+
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        const __m128i zigzag = _mm_shuffle_epi8(bytes, _mm_load_si128(reinterpret_cast<const __m128i*>(s_Table.Shuffle[key])));
+
+        // undo the zigzag mapping and add up the differences, lane i gets the sum of lanes 0 to i plus the last index
+        __m128i values = _mm_xor_si128(_mm_srli_epi32(zigzag, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(zigzag, one)));
+
+        values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+        values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+        values = _mm_add_epi32(values, last);
+
+        Store(indices + block + i, values);
+
+        last = _mm_shuffle_epi32(values, _MM_SHUFFLE(3, 3, 3, 3));
+        data += s_Table.Length[key];
+      }
+
+      previous = static_cast<DWORD>(_mm_cvtsi128_si32(last));
+    }
+
+    for (; i < n; ++i)
+    {
+      const UINT length = ((control[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+
+      if (static_cast<size_t>(end - data) < length) return false;
+
+      uint32_t value = 0;
+
+      for (UINT b = 0; b < length; ++b) value |= static_cast<uint32_t>(data[b]) << (b * 8);
+
+      data += length;
+      previous += UnZigZag(value);
+
+      indices[block + i] = static_cast<T>(previous);
+    }
+  }
+
+  return true;
+}
+
+void IndexCodec::Encode(const DWORD* indices, size_t count, DWORD& previous, std::vector<BYTE>& output)
+{
+  for (size_t block = 0; block < count; block += BlockSize)
+  {
+    const size_t n = std::min(BlockSize, count - block);
+    const size_t control = output.size();
+
+    output.resize(control + (n + 3) / 4, 0);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      const uint32_t value = ZigZag(indices[block + i], previous);
+      const UINT length = ByteLength(value);
+
+      output[control + i / 4] |= static_cast<BYTE>((length - 1) << ((i % 4) * 2));
+
+      for (UINT b = 0; b < length; ++b) output.push_back(static_cast<BYTE>(value >> (b * 8)));
+
+      previous = indices[block + i];
+    }
+  }
+}
+
+bool IndexCodec::Decode(const BYTE* data, size_t size, size_t count, UINT stride, void* indices) noexcept
+{
+  if (stride == sizeof(uint16_t)) return DecodeBlocks(data, size, count, static_cast<uint16_t*>(indices));
+  if (stride == sizeof(uint32_t)) return DecodeBlocks(data, size, count, static_cast<uint32_t*>(indices));
+
+  return false;
+}
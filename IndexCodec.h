@@ -0,0 +1,22 @@
+#pragma once
+
+// index stream of cooked meshes (Stream VByte layout, Lemire et al.)
+// every index is stored as the zigzag mapped difference to its predecessor in 1 to 4 bytes
+// the stream is split into blocks of up to BlockSize indices, each block holds a 2 bit length per index followed by the data bytes
+class IndexCodec
+{
+public:
+  static constexpr size_t BlockSize = 4096;
+
+  // appends the encoded indices to output, previous carries the difference chain from one call to the next and starts at 0
+  // count has to be a multiple of BlockSize on every call except the last one
+  static void Encode(const DWORD* indices, size_t count, DWORD& previous, std::vector<BYTE>& output);
+
+  // decodes count indices as 16 (stride 2) or 32 (stride 4) bit values, false if the stream ends early
+  static bool Decode(const BYTE* data, size_t size, size_t count, UINT stride, void* indices) noexcept;
+
+private:
+  IndexCodec(void) noexcept = delete;
+  ~IndexCodec(void) noexcept = delete;
+
+};
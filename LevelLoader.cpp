@@ -1,9 +1,64 @@
 #include "LevelLoader.h"
 
+#include "ImportCache.h"
+#include "MappedFile.h"
+
+static constexpr uint32_t s_Magic = 0x4C434145; // "EACL"
+// raised with every change of the parsing or the layout, part of the import cache key so every level is parsed again
+static constexpr uint32_t s_Version = 1;
+
+// a parsed level in the import cache, every row is its cell count as uint32_t followed by one byte per cell
+struct LevelFileHeader
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t RowCount;
+};
+
+// false if the artifact is damaged, cells is left incomplete then
+static bool Read(const MappedFile& file, std::vector<std::vector<int>>& cells)
+{
+  if (file.Size() < sizeof(LevelFileHeader)) return false;
+
+  const auto* header = reinterpret_cast<const LevelFileHeader*>(file.Data());
+
+  if (header->Magic != s_Magic || header->Version != s_Version) return false;
+
+  const char* p = file.Data() + sizeof(LevelFileHeader);
+  const char* const end = file.Data() + file.Size();
+
+  for (uint32_t r = 0; r < header->RowCount; ++r)
+  {
+    uint32_t count;
+
+    if (static_cast<size_t>(end - p) < sizeof(count)) return false;
+
+    memcpy(&count, p, sizeof(count));
+    p += sizeof(count);
+
+    if (static_cast<size_t>(end - p) < count) return false;
+
+    cells.emplace_back(reinterpret_cast<const BYTE*>(p), reinterpret_cast<const BYTE*>(p) + count);
+    p += count;
+  }
+
+  return p == end;
+}
+
 std::vector<std::vector<int>> LevelLoader::Load(const std::string& filename)
 {
   std::vector<std::vector<int>> cells;
 
+  std::string artifact;
+  const bool cacheable = ImportCache::ArtifactFileName(filename, s_Version, ".level", artifact);
+
+  MappedFile file;
+
+  if (cacheable && file.Open(artifact) && Read(file, cells)) return cells;
+
+  file.Close();
+  cells.clear();
+
   std::string to;
   std::ifstream t(filename);
 
@@ -21,5 +76,20 @@ std::vector<std::vector<int>> LevelLoader::Load(const std::string& filename)
     cells.push_back(row);
   }
 
+  if (!cacheable) return cells;
+
+  const LevelFileHeader header = { s_Magic, s_Version, static_cast<uint32_t>(cells.size()) };
+  std::vector<BYTE> rows;
+
+  for (const auto& row : cells)
+  {
+    const auto count = static_cast<uint32_t>(row.size());
+
+    rows.insert(rows.end(), reinterpret_cast<const BYTE*>(&count), reinterpret_cast<const BYTE*>(&count) + sizeof(count));
+    rows.insert(rows.end(), row.begin(), row.end());
+  }
+
+  if (!ImportCache::Store(artifact, &header, sizeof(header), rows.data(), rows.size())) Log::Error("Caching of level " + artifact + " failed");
+
   return cells;
 }
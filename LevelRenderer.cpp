@@ -10,28 +10,18 @@ bool LevelRenderer::CreatePipelineState(ComPtr<ID3D12Device>& device, int width,
 
   if (!CreateRootSignature(device)) return false;
 
-  D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-  heapDesc.NumDescriptors = 1;
-  heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-  heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-  if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mainDescriptorHeap))))
-  {
-    return false;
-  }
-
   ComPtr<ID3DBlob> vertexShader;
   ComPtr<ID3DBlob> pixelShader;
 
-  SHADER_MACROS.push_back({ "TEXTURE", "0" });
+  SHADER_MACROS.push_back({ "TEXTURE_ARRAY", "0" });
 
-  if (!CompileShaders(vertexShader, "mainCB", pixelShader, "main")) return false;
+  if (!CompileShaders(vertexShader, "mainPacked", pixelShader, "main")) return false;
 
-  // Define the vertex input layout.
+  // Define the vertex input layout, meshes are drawn from cooked PackedVertex buffers.
   D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
   {
-    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-    { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 28, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+    { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
   };
 
   // Describe and create the graphics pipeline state object (PSO).
@@ -99,8 +89,14 @@ bool LevelRenderer::LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12Gra
 
   if (!CreateDepthStencilBuffer(device, commandList, width, height)) return false;
 
+  // decode all distinct meshes concurrently before the (serial) GPU upload
+  Mesh::ImportAll();
+
   for (auto& model : m_models) model->LoadResources(device, commandList);
 
+  // every distinct texture of the level once
+  TextureCache::LoadResources(device, commandList);
+
   commandList->Close();
 
   return true;
@@ -122,10 +118,9 @@ bool LevelRenderer::PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& comma
   const auto dsvHandle = m_depthStencilDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
   commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
 
-  ID3D12DescriptorHeap* descriptorHeaps[] = { mainDescriptorHeap.Get() };
-  commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-  // set the descriptor table to the descriptor heap (parameter 1, as constant buffer root descriptor is parameter index 0)
-  commandList->SetGraphicsRootDescriptorTable(1, mainDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+  // the views of every texture array of the level, the draws only pick their table and layer
+  ID3D12DescriptorHeap* descriptorHeaps[] = { TextureCache::DescriptorHeap() };
+  if (descriptorHeaps[0]) commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
   const float clearColor[] = { 0.08f, 0.08f, 0.08f, 1.0f };
   commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
@@ -174,16 +169,17 @@ bool LevelRenderer::CreateRootSignature(ComPtr<ID3D12Device>& device)
   // this is a range of descriptors inside a descriptor heap
   D3D12_DESCRIPTOR_RANGE1  descriptorTableRanges[1]; // only one range right now
   descriptorTableRanges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV; // this is a range of shader resource views (descriptors)
-  descriptorTableRanges[0].NumDescriptors = 1; // we only have one texture right now, so the range is only 1
+  descriptorTableRanges[0].NumDescriptors = 1; // one texture array, the layer is picked by the slice constant
   descriptorTableRanges[0].BaseShaderRegister = 0; // start index of the shader registers in the range
   descriptorTableRanges[0].RegisterSpace = 0; // space 0. can usually be zero
   descriptorTableRanges[0].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND; // this appends the range to the end of the root signature descriptor tables
 
   // create a root parameter for the root descriptor and fill it out
-  CD3DX12_ROOT_PARAMETER1  rootParameters[2] = { {}, {} }; // two root parameters
+  CD3DX12_ROOT_PARAMETER1  rootParameters[3] = { {}, {}, {} }; // three root parameters
 
   rootParameters[0].InitAsConstants(sizeof(ConstantBuffer) / sizeof(float), 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
   rootParameters[1].InitAsDescriptorTable(1, descriptorTableRanges, D3D12_SHADER_VISIBILITY_PIXEL);
+  rootParameters[2].InitAsConstants(1, 1, 0, D3D12_SHADER_VISIBILITY_PIXEL); // the texture array layer of the draw
 
   // create a static sampler
   D3D12_STATIC_SAMPLER_DESC sampler = {};
@@ -202,7 +198,7 @@ bool LevelRenderer::CreateRootSignature(ComPtr<ID3D12Device>& device)
   sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
 
   CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
-  rootSignatureDesc.Init_1_1(2, rootParameters, 1, &sampler, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+  rootSignatureDesc.Init_1_1(_countof(rootParameters), rootParameters, 1, &sampler, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
   ComPtr<ID3DBlob> signature;
   ComPtr<ID3DBlob> error;
@@ -238,7 +234,26 @@ void LevelRenderer::Render(ComPtr<ID3D12GraphicsCommandList>& commandList) noexc
   const auto end = std::chrono::system_clock::now();
   const std::chrono::duration<double> diff = (end - start);
 
-  Log::Info((std::wstringstream() << L"Culling: " << diff.count() * 1000.0 << "ms - " << renderables.size() << " of " << m_models.size() << " models visible").str());
+  // pixels per unit of size at distance 1
+  const auto projectionScale = m_viewport.Height * 0.5f * Camera::GetProjectionMatrix()._22;
+
+  size_t triangles = 0;
+  size_t rejected = 0;
+  // no texture array is bound at the start of the frame
+  UINT textureArray = UINT_MAX;
+
+  for (auto& model : renderables)
+  {
+    const auto lod = model->SelectLod(projectionScale);
+
+    // the coarser LODs are small on screen, their clusters are not worth testing
+    const auto culled = lod == 0 ? model->CullClusters() : 0;
+
+    triangles += model->TriangleCount(lod) - culled;
+    rejected += culled;
+
+    model->PopulateCommandList(commandList, nullptr, 0, lod, textureArray);
+  }
 
-  for (auto& model : renderables) model->PopulateCommandList(commandList, nullptr, 0);
+  Log::Info((std::wstringstream() << L"Culling: " << diff.count() * 1000.0 << "ms - " << renderables.size() << " of " << m_models.size() << " models visible, " << triangles << " triangles, " << rejected << " rejected by cluster culling").str());
 }
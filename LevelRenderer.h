@@ -18,8 +18,6 @@ protected:
 
   const int m_constantBufferAlignedSize = (sizeof(ConstantBuffer) + 255) & ~255;
 
-  ComPtr<ID3D12DescriptorHeap> mainDescriptorHeap;
-
   std::vector<Model*> m_models;
   std::vector<std::vector<int>> levelLayout;
 
@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+  m_File(other.m_File),
+  m_Mapping(other.m_Mapping),
+  m_Data(other.m_Data),
+  m_Size(other.m_Size)
+{
+  other.m_File = INVALID_HANDLE_VALUE;
+  other.m_Mapping = nullptr;
+  other.m_Data = nullptr;
+  other.m_Size = 0;
+}
+
+MappedFile::~MappedFile(void) noexcept
+{
+  Close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this == &other) return *this;
+
+  Close();
+
+  std::swap(m_File, other.m_File);
+  std::swap(m_Mapping, other.m_Mapping);
+  std::swap(m_Data, other.m_Data);
+  std::swap(m_Size, other.m_Size);
+
+  return *this;
+}
+
+bool MappedFile::Open(const std::string& filename) noexcept
+{
+  Close();
+
+  m_File = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (m_File == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+
+  if (!GetFileSizeEx(m_File, &size))
+  {
+    Close();
+
+    return false;
+  }
+
+  m_Size = static_cast<size_t>(size.QuadPart);
+
+  // an empty file can not be mapped, but it is still a valid (empty) view
+  if (m_Size == 0) return true;
+
+  m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if (m_Mapping) m_Data = static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+
+  if (!m_Data)
+  {
+    Close();
+
+    return false;
+  }
+
+  return true;
+}
+
+void MappedFile::Close(void) noexcept
+{
+  if (m_Data) UnmapViewOfFile(m_Data);
+  if (m_Mapping) CloseHandle(m_Mapping);
+  if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+
+  m_File = INVALID_HANDLE_VALUE;
+  m_Mapping = nullptr;
+  m_Data = nullptr;
+  m_Size = 0;
+}
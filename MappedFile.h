@@ -0,0 +1,28 @@
+#pragma once
+
+// read only view of a whole file, the pages are loaded by the OS on first access
+class MappedFile
+{
+public:
+  MappedFile(void) noexcept = default;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile(void) noexcept;
+
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool Open(const std::string& filename) noexcept;
+  void Close(void) noexcept;
+
+  inline bool IsOpen(void) const noexcept { return m_File != INVALID_HANDLE_VALUE; }
+  inline const char* Data(void) const noexcept { return m_Data; }
+  inline size_t Size(void) const noexcept { return m_Size; }
+
+private:
+  HANDLE m_File = INVALID_HANDLE_VALUE;
+  HANDLE m_Mapping = nullptr;
+  const char* m_Data = nullptr;
+  size_t m_Size = 0;
+
+};
@@ -1,8 +1,184 @@
 #include "Mesh.h"
 
+#include <atomic>
+#include <thread>
+
 std::map<std::string, Mesh> Mesh::cache;
 
-bool Mesh::GetMesh(std::string object, std::string texture, Mesh*& mesh)
+// sources at least this large are streamed into the cooked file instead of being imported in one piece
+static constexpr uint64_t s_StreamingThreshold = 256ull << 20;
+// FIFO size the cook statistics are reported for, a conservative guess for current hardware
+static constexpr UINT s_SimulatedCacheSize = 16;
+// the overdraw pass may raise the simulated ACMR by up to 5%
+static constexpr float s_OverdrawThreshold = 1.05f;
+// every LOD aims for half the triangles of the one before it
+static constexpr size_t s_MaxLodCount = 8;
+// no LOD may deviate from the full mesh by more than 5% of its extent
+static constexpr float s_LodErrorLimit = 0.05f;
+// a LOD with more than 90% of the triangles of the one before it is not worth its indices
+static constexpr float s_LodMinReduction = 0.9f;
+
+// simplifies the submesh again and again, chain receives the indices of every LOD below it and errors what each one deviates by
+static void SimplifyChain(const std::vector<Vertex>& vertices, const DWORD* indices, size_t indexCount, float errorLimit, std::vector<std::vector<DWORD>>& chain, std::vector<float>& errors)
+{
+  std::vector<DWORD> source(indices, indices + indexCount);
+  std::vector<DWORD> lod;
+  float error = 0.0f;
+
+  while (!source.empty() && chain.size() + 1 < s_MaxLodCount)
+  {
+    // the errors of the steps add up, what is left of the limit bounds the next one
+    const float step = MeshSimplifier::Simplify(source.data(), source.size(), vertices.data(), vertices.size(), source.size() / 2, errorLimit - error, lod);
+
+    if (lod.empty() || lod.size() > source.size() * s_LodMinReduction) break;
+
+    error += step;
+
+    MeshOptimizer::OptimizeVertexCache(lod.data(), lod.size(), vertices.size());
+
+    chain.push_back(lod);
+    errors.push_back(error);
+
+    source.swap(lod);
+  }
+}
+
+// appends the indices of every LOD below the full mesh to indices and its submeshes to the tables, each submesh is simplified on its own
+// a submesh that cannot be simplified as far as the others keeps its coarsest range in the remaining LODs
+static void GenerateLods(const std::string& name, const std::vector<Vertex>& vertices, std::vector<DWORD>& indices, MeshFileTables& tables)
+{
+  const size_t submeshCount = tables.Submeshes.size();
+
+  UINT triangles = 0;
+
+  for (const auto& submesh : tables.Submeshes) triangles += submesh.IndexCount / 3;
+
+  tables.Lods.assign(1, MeshFileLod{ triangles, 0.0f });
+
+  if (indices.empty()) return;
+
+  BoundingBox box;
+
+  BoundingBox::CreateFromPoints(box, vertices.size(), &vertices.front().Position, sizeof(Vertex));
+
+  const float errorLimit = s_LodErrorLimit * 2.0f * std::max({ box.Extents.x, box.Extents.y, box.Extents.z });
+
+  std::vector<std::vector<std::vector<DWORD>>> chains(submeshCount);
+  std::vector<std::vector<float>> errors(submeshCount);
+  size_t lodCount = 1;
+
+  for (size_t s = 0; s < submeshCount; ++s)
+  {
+    SimplifyChain(vertices, indices.data() + tables.Submeshes[s].IndexStart, tables.Submeshes[s].IndexCount, errorLimit, chains[s], errors[s]);
+
+    lodCount = std::max(lodCount, chains[s].size() + 1);
+  }
+
+  std::string report;
+
+  for (size_t lod = 1; lod < lodCount; ++lod)
+  {
+    MeshFileLod level = { 0, 0.0f };
+
+    for (size_t s = 0; s < submeshCount; ++s)
+    {
+      // only LOD 0 has clusters
+      MeshFileSubmesh submesh = tables.Submeshes[(lod - 1) * submeshCount + s];
+
+      submesh.ClusterStart = 0;
+      submesh.ClusterCount = 0;
+
+      if (lod <= chains[s].size())
+      {
+        const auto& simplified = chains[s][lod - 1];
+
+        submesh.IndexStart = static_cast<uint32_t>(indices.size());
+        submesh.IndexCount = static_cast<uint32_t>(simplified.size());
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+      }
+
+      if (!errors[s].empty()) level.Error = std::max(level.Error, errors[s][std::min(lod, errors[s].size()) - 1]);
+
+      level.TriangleCount += submesh.IndexCount / 3;
+      tables.Submeshes.push_back(submesh);
+    }
+
+    tables.Lods.push_back(level);
+
+    report += ", LOD " + std::to_string(lod) + " " + std::to_string(level.TriangleCount) + " triangles error " + std::to_string(level.Error);
+  }
+
+  Log::Info(name + " " + std::to_string(triangles) + " triangles in " + std::to_string(submeshCount) + " submeshes" + report);
+}
+
+// runs all cook time optimizations in order and logs what the simulators report for them
+// tables holds a LOD 0 submesh per material on the way in, each of them is optimized and clustered on its own
+// the statistics after the passes are those of LOD 0
+static void Optimize(const std::string& name, std::vector<Vertex>& vertices, std::vector<DWORD>& indices, MeshFileTables& tables)
+{
+  const auto cacheBefore = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertices.size(), s_SimulatedCacheSize);
+  const auto overdrawBefore = MeshOptimizer::AnalyzeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size());
+  const auto fetchBefore = MeshOptimizer::AnalyzeVertexFetch(indices.data(), indices.size(), vertices.size(), sizeof(Vertex));
+
+  for (auto& submesh : tables.Submeshes)
+  {
+    DWORD* range = indices.data() + submesh.IndexStart;
+
+    MeshOptimizer::OptimizeVertexCache(range, submesh.IndexCount, vertices.size());
+    MeshOptimizer::OptimizeOverdraw(range, submesh.IndexCount, vertices.data(), vertices.size(), s_OverdrawThreshold);
+
+    // clusters grow from the triangles in overdraw order, which keeps most of it
+    submesh.ClusterStart = static_cast<uint32_t>(tables.Clusters.size());
+
+    MeshClusterizer::BuildClusters(range, submesh.IndexCount, vertices.data(), vertices.size(), tables.Clusters);
+
+    submesh.ClusterCount = static_cast<uint32_t>(tables.Clusters.size()) - submesh.ClusterStart;
+
+    for (UINT c = submesh.ClusterStart; c < tables.Clusters.size(); ++c) tables.Clusters[c].IndexStart += submesh.IndexStart;
+  }
+
+  const auto culling = MeshClusterizer::AnalyzeClusterCulling(tables.Clusters.data(), tables.Clusters.size());
+
+  Log::Info(name + " " + std::to_string(tables.Clusters.size()) + " clusters, culling rejects " + std::to_string(culling.Rejected) + " of the triangles per view" +
+    " (frustum " + std::to_string(culling.FrustumRejected / std::max(culling.Views, 1u)) + ", backface " + std::to_string(culling.BackfaceRejected / std::max(culling.Views, 1u)) +
+    " of " + std::to_string(culling.Triangles / std::max(culling.Views, 1u)) + ")");
+
+  // the LODs only get the vertex cache pass, they are drawn small enough for overdraw not to matter
+  GenerateLods(name, vertices, indices, tables);
+
+  // has to be last, it changes the vertex order the other passes were based on but not the triangle order
+  // LOD 0 comes first in indices, so its vertices end up at the front of the buffer
+  vertices.resize(MeshOptimizer::OptimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.size()));
+
+  // the submeshes of LOD 0 cover the front of indices without gaps
+  const size_t full = static_cast<size_t>(tables.Lods.front().TriangleCount) * 3;
+
+  const auto cacheAfter = MeshOptimizer::AnalyzeVertexCache(indices.data(), full, vertices.size(), s_SimulatedCacheSize);
+  const auto overdrawAfter = MeshOptimizer::AnalyzeOverdraw(indices.data(), full, vertices.data(), vertices.size());
+  const auto fetchAfter = MeshOptimizer::AnalyzeVertexFetch(indices.data(), full, vertices.size(), sizeof(Vertex));
+
+  Log::Info(name + " vertex cache ACMR " + std::to_string(cacheBefore.ACMR) + " -> " + std::to_string(cacheAfter.ACMR) +
+    ", ATVR " + std::to_string(cacheBefore.ATVR) + " -> " + std::to_string(cacheAfter.ATVR) +
+    ", overdraw " + std::to_string(overdrawBefore.Overdraw) + " -> " + std::to_string(overdrawAfter.Overdraw) +
+    ", overfetch " + std::to_string(fetchBefore.Overfetch) + " -> " + std::to_string(fetchAfter.Overfetch));
+}
+
+static std::string PackingReport(const VertexPackingStatistics& statistics)
+{
+  return ", vertex packing error position " + std::to_string(statistics.PositionMaxError) + " max " + std::to_string(statistics.PositionRMSError()) + " rms" +
+    ", texcoord " + std::to_string(statistics.TexCoordMaxError) + " max " + std::to_string(statistics.TexCoordRMSError()) + " rms";
+}
+
+// the throughput of the OBJ import, the time includes mapping the file, welding and grouping by material
+static std::string ImportReport(const uint64_t bytes, const size_t triangles, const double seconds)
+{
+  const double rate = 1.0 / std::max(seconds, 1e-9);
+
+  return ", " + std::to_string(bytes / 1e6) + " MB and " + std::to_string(triangles) + " triangles in " + std::to_string(seconds * 1e3) + " ms" +
+    " (" + std::to_string(bytes / 1e6 * rate) + " MB/s, " + std::to_string(triangles * rate / 1e6) + " M triangles/s, " + ObjTokenizer::InstructionSet() + ")";
+}
+
+bool Mesh::GetMesh(std::string object, Mesh*& mesh)
 {
   auto& it = cache.find(object);
 
@@ -14,51 +190,281 @@ bool Mesh::GetMesh(std::string object, std::string texture, Mesh*& mesh)
     return true;
   }
 
-  mesh = new Mesh(object, texture);
-  const auto entry = cache.insert({ object, *mesh });
+  const auto entry = cache.insert({ object, Mesh(object) });
 
+  mesh = &entry.first->second;
   mesh->instances = 1;
 
   return entry.second;
 }
 
+void Mesh::ImportAll(void)
+{
+  std::vector<Mesh*> meshes;
+
+  for (auto& entry : cache) if (!entry.second.m_cooked.IsOpen()) meshes.push_back(&entry.second);
+
+  // every worker owns a loader for all the meshes it takes, so its scratch buffers keep their capacity from one import to the next
+  // one worker per core takes the next mesh as it finishes one, the cores left over parse the chunks of large files
+  const UINT cores = std::max(1u, std::thread::hardware_concurrency());
+  const UINT threads = static_cast<UINT>(std::min<size_t>(cores, meshes.size()));
+  const UINT threadsPerMesh = std::max(1u, cores / std::max(1u, threads));
+
+  std::atomic<size_t> next(0);
+
+  const auto work = [&meshes, &next, threadsPerMesh](void)
+  {
+    OBJLoader loader(threadsPerMesh);
+
+    for (size_t i = next++; i < meshes.size(); i = next++) meshes[i]->Import(loader);
+  };
+
+  std::vector<std::thread> workers;
+
+  for (UINT t = 1; t < threads; ++t) workers.emplace_back(work);
+
+  work();
+
+  for (auto& worker : workers) worker.join();
+
+  // an image used by several meshes or materials is opened once
+  for (auto& entry : cache) entry.second.AcquireTextures();
+
+  TextureCache::ImportAll();
+}
+
+bool Mesh::Import(OBJLoader& loader)
+{
+  if (m_cooked.IsOpen()) return true;
+
+  std::string cooked;
+
+  // the cooked materials hold the texture paths of the material libraries, relative to the directory of the .obj
+  if (!ImportCache::ArtifactFileName(m_filename, MeshFile::Version, ".mesh", cooked, &OBJLoader::Libraries))
+  {
+    Log::Error("Obj File " + m_filename + " couldn't be loaded.");
+
+    return false;
+  }
+
+  // the .obj is only parsed if its content was not cooked before
+  if (ImportCache::Exists(cooked) && Open(cooked)) return true;
+
+  if (Cook(loader, cooked) && Open(cooked)) return true;
+
+  Log::Error("Cooking of " + m_filename + " failed");
+
+  return false;
+}
+
+bool Mesh::Open(const std::string& cooked)
+{
+  if (!m_cooked.Open(cooked)) return false;
+
+  // decoded on the import thread, LoadResources only uploads them
+  m_indices.resize(static_cast<size_t>(m_cooked.IndexCount()) * m_cooked.IndexStride());
+
+  if (!m_cooked.DecodeIndices(m_indices.data()))
+  {
+    m_cooked.Close();
+
+    return false;
+  }
+
+  return true;
+}
+
+void Mesh::AcquireTextures(void)
+{
+  if (!m_cooked.IsOpen() || !m_materialTextures.empty()) return;
+
+  for (UINT m = 0; m < m_cooked.MaterialCount(); ++m)
+  {
+    const std::string texture = m_cooked.Materials()[m].Texture;
+
+    m_materialTextures.push_back(texture.empty() ? TextureCache::InvalidHandle : TextureCache::Acquire(std::wstring(texture.begin(), texture.end())));
+  }
+}
+
 void Mesh::LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList)
 {
   if (loaded) return;
 
-  DWORD* indexList;
+  loaded = true;
+
+  // only meshes added after ImportAll are still to import, they go through a loader of their own
+  if (!m_cooked.IsOpen())
+  {
+    OBJLoader loader;
+
+    if (!Import(loader)) return;
+  }
+
+  m_vertexCount = m_cooked.VertexCount();
+  m_indexCount = m_cooked.IndexCount();
+  m_bounds = LocalBounds(m_cooked.Bounds().AABB, m_cooked.Bounds().Sphere, m_cooked.Bounds().OBB);
+  m_lods.assign(m_cooked.Lods(), m_cooked.Lods() + m_cooked.LodCount());
+  m_submeshes.assign(m_cooked.Submeshes(), m_cooked.Submeshes() + static_cast<size_t>(m_cooked.LodCount()) * m_cooked.SubmeshCount());
+  m_clusters.assign(m_cooked.Clusters(), m_cooked.Clusters() + m_cooked.ClusterCount());
+
+  const auto& offset = m_cooked.PositionOffset();
+  const auto& scale = m_cooked.PositionScale();
 
-  OBJLoader::Load(m_filename, m_Verticies, m_vertexCount, indexList, m_indexCount);
+  XMStoreFloat4x4(&m_dequantization, XMMatrixScaling(scale.x, scale.y, scale.z) * XMMatrixTranslation(offset.x, offset.y, offset.z));
 
+  // the buffers are filled straight from the mapped file
   if (m_vertexCount && m_indexCount)
   {
-    CreateVertexBuffer(device, commandList, m_Verticies, m_vertexCount * sizeof(Vertex));
-    CreateIndexBuffer(device, commandList, indexList, m_indexCount * sizeof(DWORD));
-    LoadTexture(device, commandList);
+    CreateVertexBuffer(device, commandList, m_cooked.Vertices(), m_vertexCount * sizeof(PackedVertex));
+    CreateIndexBuffer(device, commandList, m_indices.data(), static_cast<int>(m_indices.size()), m_cooked.IndexStride() == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT);
   }
 
-  delete[] indexList;
+  // uploaded by TextureCache::LoadResources together with the textures of every other mesh
+  AcquireTextures();
 
-  loaded = true;
+  // UpdateSubresources already copied them into the upload heap
+  std::vector<BYTE>().swap(m_indices);
+}
+
+bool Mesh::Cook(OBJLoader& loader, const std::string& cooked) const
+{
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+  const uint64_t size = GetFileAttributesExA(m_filename.c_str(), GetFileExInfoStandard, &attributes) ?
+    (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow : 0;
+
+  if (size >= s_StreamingThreshold)
+  {
+    MeshFileWriter writer(cooked);
+
+    const bool streamed = loader.Stream(m_filename, writer) && writer.Finish();
+
+    if (streamed) Log::Info("Streamed " + m_filename + " into " + cooked + PackingReport(writer.Statistics()));
+
+    return streamed;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  if (!loader.Import(m_filename)) return false;
+
+  const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  Log::Info("Imported " + m_filename + ImportReport(size, loader.Indices().size() / 3, seconds.count()));
+
+  // the loader keeps its buffers for the next import, the optimized mesh goes into a copy
+  std::vector<Vertex> vertices(loader.Vertices());
+  std::vector<DWORD> indices(loader.Indices());
+
+  MeshFileTables tables;
+
+  // one material per submesh, the loader already made them unique
+  for (const auto& submesh : loader.Submeshes())
+  {
+    MeshFileMaterial material = {};
+
+    submesh.Material.copy(material.Name, sizeof(material.Name) - 1);
+
+    // a cut off path would point somewhere else, the texture of the mesh is the better guess
+    if (submesh.Texture.size() < sizeof(material.Texture)) submesh.Texture.copy(material.Texture, sizeof(material.Texture) - 1);
+    else Log::Error(m_filename + " texture path of material " + submesh.Material + " is too long");
+
+    tables.Submeshes.push_back({ static_cast<uint32_t>(tables.Materials.size()), submesh.IndexStart, submesh.IndexCount, 0, 0 });
+    tables.Materials.push_back(material);
+  }
+
+  // even a mesh without faces is written with a submesh and a material
+  if (tables.Submeshes.empty())
+  {
+    tables.Submeshes.push_back({});
+    tables.Materials.push_back({});
+  }
+
+  Optimize(m_filename, vertices, indices, tables);
+
+  VertexPackingStatistics packing;
+
+  const bool written = MeshFile::Write(cooked, vertices.data(), static_cast<UINT>(vertices.size()), indices.data(), static_cast<UINT>(indices.size()), tables, packing);
+
+  if (written) Log::Info("Cooked " + m_filename + " into " + cooked + PackingReport(packing));
+
+  return written;
 }
 
 void Mesh::Update(int frameIndex)
 {
 }
 
-void Mesh::PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress)
+void Mesh::PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress, UINT lod, const std::vector<bool>& visibleClusters, UINT texture, UINT& textureArray)
 {
-  // set the descriptor heap
-  ID3D12DescriptorHeap* descriptorHeaps[] = { m_shaderResourceViewDescriptorHeap.Get() };
-  commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-  // set the descriptor table to the descriptor heap (parameter 1, as constant buffer root descriptor is parameter index 0)
-  commandList->SetGraphicsRootDescriptorTable(1, m_shaderResourceViewDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+  if (m_lods.empty()) return;
+
+  lod = std::min(lod, static_cast<UINT>(m_lods.size()) - 1);
+
+  const size_t submeshCount = m_submeshes.size() / m_lods.size();
+  const auto* submeshes = m_submeshes.data() + lod * submeshCount;
+  const bool culled = lod == 0 && visibleClusters.size() == m_clusters.size();
 
   commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
   commandList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
   commandList->IASetIndexBuffer(&m_indexBufferView);
 
-  commandList->DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);
+  // the submeshes are sorted by material, the texture only changes between them
+  UINT material = UINT_MAX;
+  bool textured = false;
+
+  for (size_t s = 0; s < submeshCount; ++s)
+  {
+    const auto& submesh = submeshes[s];
+
+    if (!submesh.IndexCount) continue;
+
+    if (submesh.Material != material)
+    {
+      material = submesh.Material;
+
+      const UINT handle = (material < m_materialTextures.size() && TextureCache::IsLoaded(m_materialTextures[material])) ? m_materialTextures[material] : texture;
+
+      // set the descriptor table to the texture array of the material (parameter 1, as constant buffer root descriptor is parameter index 0), unless it is bound already
+      // there is no table while the descriptor heap is missing, drawing without one is invalid, so the submeshes are skipped
+      const D3D12_GPU_DESCRIPTOR_HANDLE descriptor = TextureCache::Descriptor(handle);
+
+      textured = (descriptor.ptr != 0);
+
+      if (textured && TextureCache::Array(handle) != textureArray)
+      {
+        textureArray = TextureCache::Array(handle);
+        commandList->SetGraphicsRootDescriptorTable(1, descriptor);
+      }
+
+      // the layer of the material in the array (parameter 2)
+      commandList->SetGraphicsRoot32BitConstant(2, TextureCache::Slice(handle), 0);
+    }
+
+    if (!textured) continue;
+
+    if (!culled || !submesh.ClusterCount)
+    {
+      commandList->DrawIndexedInstanced(submesh.IndexCount, 1, submesh.IndexStart, 0, 0);
+
+      continue;
+    }
+
+    // the clusters are consecutive in the index buffer, every run of visible ones is a single draw
+    const size_t end = submesh.ClusterStart + submesh.ClusterCount;
+
+    for (size_t c = submesh.ClusterStart; c < end; ++c)
+    {
+      if (!visibleClusters[c]) continue;
+
+      const UINT start = m_clusters[c].IndexStart;
+      UINT count = m_clusters[c].IndexCount;
+
+      while (c + 1 < end && visibleClusters[c + 1]) count += m_clusters[++c].IndexCount;
+
+      commandList->DrawIndexedInstanced(count, 1, start, 0, 0);
+    }
+  }
 }
 
 void Mesh::Release()
@@ -71,7 +477,10 @@ void Mesh::Release()
   m_indexBufferUpload.Reset();
   m_vertexBuffer.Reset();
   m_vertexBufferUpload.Reset();
-  m_textureBuffer.Reset();
+
+  for (const UINT handle : m_materialTextures) TextureCache::Release(handle);
+
+  m_materialTextures.clear();
 
   for (auto it = cache.begin(); it != cache.end(); ++it)
   {
@@ -84,7 +493,7 @@ void Mesh::Release()
   }
 }
 
-bool Mesh::CreateIndexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, DWORD* indexList, int indexBufferSize)
+bool Mesh::CreateIndexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, const BYTE* indexList, int indexBufferSize, DXGI_FORMAT format)
 {
   if (m_indexBufferUpload) m_indexBufferUpload->Release();
 
@@ -116,7 +525,7 @@ bool Mesh::CreateIndexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12Graphics
 
   D3D12_SUBRESOURCE_DATA subresourceData = {};
 
-  subresourceData.pData = (void*)indexList;
+  subresourceData.pData = indexList;
   subresourceData.RowPitch = indexBufferSize;
   subresourceData.SlicePitch = subresourceData.RowPitch;
 
@@ -126,14 +535,14 @@ bool Mesh::CreateIndexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12Graphics
 
   m_indexBufferView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
   m_indexBufferView.SizeInBytes = indexBufferSize;
-  m_indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+  m_indexBufferView.Format = format;
 
   Log::Info(L"CreateIndexBuffer succeeded");
 
   return true;
 }
 
-bool Mesh::CreateVertexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, Vertex* vertexList, int vertexBufferSize)
+bool Mesh::CreateVertexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, const PackedVertex* vertexList, int vertexBufferSize)
 {
   if (m_vertexBufferUpload) m_vertexBufferUpload->Release();
 
@@ -165,7 +574,7 @@ bool Mesh::CreateVertexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12Graphic
 
   D3D12_SUBRESOURCE_DATA subresourceData = {};
 
-  subresourceData.pData = (void*)vertexList;
+  subresourceData.pData = vertexList;
   subresourceData.RowPitch = vertexBufferSize;
   subresourceData.SlicePitch = subresourceData.RowPitch;
 
@@ -174,126 +583,10 @@ bool Mesh::CreateVertexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12Graphic
   commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_vertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
 
   m_vertexBufferView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
-  m_vertexBufferView.StrideInBytes = sizeof(Vertex);
+  m_vertexBufferView.StrideInBytes = sizeof(PackedVertex);
   m_vertexBufferView.SizeInBytes = vertexBufferSize;
 
   Log::Info(L"CreateVertexBuffer succeeded");
 
   return true;
 }
-
-bool Mesh::LoadTexture(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList)
-{
-  // Load the image from file
-  D3D12_RESOURCE_DESC textureDesc;
-  int imageBytesPerRow;
-  BYTE* imageData;
-
-  const auto imageSize = TextureLoader::LoadImageDataFromFile(
-    &imageData,
-    textureDesc,
-    m_texturename.c_str(),
-    imageBytesPerRow
-  );
-
-  // make sure we have data
-  if (imageSize <= 0)
-  {
-    Log::Info("loading of texture failed");
-
-    return false;
-  }
-
-  // create a default heap where the upload heap will copy its contents into (contents being the texture)
-  if (
-    FAILED(
-      device->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), // a default heap
-        D3D12_HEAP_FLAG_NONE, // no flags
-        &textureDesc, // the description of our texture
-        D3D12_RESOURCE_STATE_COPY_DEST, // We will copy the texture from the upload heap to here, so we start it out in a copy dest state
-        nullptr, // used for render targets and depth/stencil buffers
-        IID_PPV_ARGS(&m_textureBuffer)
-      )
-    )
-    )
-  {
-    return false;
-  }
-  m_textureBuffer->SetName(L"Texture Buffer Resource Heap");
-
-  UINT64 textureUploadBufferSize;
-
-  // this function gets the size an upload buffer needs to be to upload a texture to the gpu.
-  // each row must be 256 byte aligned except for the last row, which can just be the size in bytes of the row
-  // eg. textureUploadBufferSize = ((((width * numBytesPerPixel) + 255) & ~255) * (height - 1)) + (width * numBytesPerPixel);
-  //textureUploadBufferSize = (((imageBytesPerRow + 255) & ~255) * (textureDesc.Height - 1)) + imageBytesPerRow;
-  device->GetCopyableFootprints(&textureDesc, 0, 1, 0, nullptr, nullptr, nullptr, &textureUploadBufferSize);
-
-  // now we create an upload heap to upload our texture to the GPU
-  if (
-    FAILED(
-      device->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
-        D3D12_HEAP_FLAG_NONE, // no flags
-        &CD3DX12_RESOURCE_DESC::Buffer(textureUploadBufferSize), // resource description for a buffer (storing the image data in this heap just to copy to the default heap)
-        D3D12_RESOURCE_STATE_GENERIC_READ, // We will copy the contents from this heap to the default heap above
-        nullptr,
-        IID_PPV_ARGS(&m_textureBufferUploadHeap))
-    )
-  )
-  {
-    Log::Info(L"Failed to create committed resource texture upload heap");
-
-    return false;
-  }
-  m_textureBufferUploadHeap->SetName(L"Texture Buffer Upload Resource Heap");
-
-  // store vertex buffer in upload heap
-  D3D12_SUBRESOURCE_DATA textureData = {};
-
-  textureData.pData = &imageData[0]; // pointer to our image data
-  textureData.RowPitch = imageBytesPerRow; // size of all our triangle vertex data
-  textureData.SlicePitch = imageBytesPerRow * textureDesc.Height; // also the size of our triangle vertex data
-
-  // Now we copy the upload buffer contents to the default heap
-  UpdateSubresources(
-    commandList.Get(),
-    m_textureBuffer.Get(),
-    m_textureBufferUploadHeap.Get(),
-    0, 0, 1,
-    &textureData
-  );
-
-  // transition the texture default heap to a pixel shader resource (we will be sampling from this heap in the pixel shader to get the color of pixels)
-  commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_textureBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-
-  // create the descriptor heap that will store our srv
-  D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-
-  heapDesc.NumDescriptors = 1;
-  heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-  heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-
-  if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(m_shaderResourceViewDescriptorHeap.GetAddressOf()))))
-  {
-    m_textureBufferUploadHeap->SetName(L"Failed to create texture descriptor heap");
-
-    return false;
-  }
-
-  // now we create a shader resource view (descriptor that points to the texture and describes it)
-  D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-
-  srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-  srvDesc.Format = textureDesc.Format;
-  srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-  srvDesc.Texture2D.MipLevels = 1;
-
-  device->CreateShaderResourceView(m_textureBuffer.Get(), &srvDesc, m_shaderResourceViewDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-
-  // we are done with image data now that we've uploaded it to the gpu, so free it up
-  delete imageData;
-
-  return true;
-}
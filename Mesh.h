@@ -1,35 +1,62 @@
 #pragma once
 
+#include "MeshFile.h"
+#include "ImportCache.h"
+#include "BoundingVolume.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshClusterizer.h"
 #include "ObjLoader.h"
-#include "ObjLoader2.h"
-#include "TextureLoader.h"
+#include "ObjTokenizer.h"
+#include "TextureCache.h"
 
 class Mesh
 {
 public:
-  static bool GetMesh(std::string object, std::string texture, Mesh*& mesh);
+  static bool GetMesh(std::string object, Mesh*& mesh);
+  // imports every cached mesh that is not imported yet on up to one thread per core, then opens the textures of their materials
+  static void ImportAll(void);
+  Mesh(Mesh&&) noexcept = default;
   ~Mesh(void) noexcept = default;
 
+  // loader is reused by the caller for the next mesh
+  bool Import(OBJLoader& loader);
   void LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList);
   void Update(int frameIndex);
-  void PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress);
+  // draws the given LOD one submesh at a time, indices past the last one draw the last one
+  // LOD 0 only draws the clusters flagged in visibleClusters, all of them if it does not hold a flag per cluster
+  // materials without a texture of their own, or one that did not load, are drawn with the texture handle of the model
+  // textureArray is the TextureCache array bound to the command list, the descriptor table is only set when a material is in another one
+  void PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress, UINT lod, const std::vector<bool>& visibleClusters, UINT texture, UINT& textureArray);
   void Release();
 
   inline const std::string& ObjectFileName(void) const noexcept { return m_filename; }
-  inline const std::wstring& TextureFileName(void) const noexcept { return m_texturename; }
 
-  virtual bool CreateIndexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, DWORD*, int);
-  virtual bool CreateVertexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, Vertex* iList, int vertexBufferSize);
-  virtual bool LoadTexture(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList);
+  virtual bool CreateIndexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, const BYTE* indexList, int indexBufferSize, DXGI_FORMAT format);
+  virtual bool CreateVertexBuffer(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, const PackedVertex* iList, int vertexBufferSize);
 
   const int VertexCount(void) const noexcept { return m_vertexCount; }
-  const Vertex* Vertices(void) const noexcept { return m_Verticies; }
+  // object space bounds from the cooked file, shared by the bounding volumes of every Model of the mesh
+  const LocalBounds& Bounds(void) const noexcept { return m_bounds; }
+  // maps the unorm16 positions of the vertex buffer back to object space, goes in front of the world matrix
+  const XMFLOAT4X4& Dequantization(void) const noexcept { return m_dequantization; }
+  // LOD 0 is the full mesh, the following ones get coarser and their errors grow
+  const std::vector<MeshFileLod>& Lods(void) const noexcept { return m_lods; }
+  // LOD by LOD, the same number of submeshes for each
+  const std::vector<MeshFileSubmesh>& Submeshes(void) const noexcept { return m_submeshes; }
+  // consecutive ranges of the indices of the LOD 0 submeshes with bounds in object space
+  const std::vector<MeshCluster>& Clusters(void) const noexcept { return m_clusters; }
 
 private:
   static std::map<std::string, Mesh> cache;
 
   Mesh(void) noexcept = default;
-  Mesh(std::string filename, std::string texture) : m_filename(filename), m_texturename(texture.begin(), texture.end()) {}
+  Mesh(std::string filename) : m_filename(filename) {}
+
+  bool Open(const std::string& cooked);
+  bool Cook(OBJLoader& loader, const std::string& cooked) const;
+  // a texture cache reference for every material of the cooked mesh
+  void AcquireTextures(void);
 
   bool loaded = false;
   int instances = 0;
@@ -42,15 +69,18 @@ private:
   ComPtr<ID3D12Resource> m_vertexBufferUpload;
   D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
 
-  ComPtr<ID3D12Resource> m_textureBuffer;
-  ComPtr<ID3D12Resource> m_textureBufferUploadHeap;
-
-  ComPtr<ID3D12DescriptorHeap> m_shaderResourceViewDescriptorHeap;
+  // TextureCache handles by material, TextureCache::InvalidHandle for the materials without a texture of their own
+  std::vector<UINT> m_materialTextures;
 
   int m_indexCount = 0;
   int m_vertexCount = 0;
-  Vertex* m_Verticies;
+  std::vector<MeshFileLod> m_lods;
+  std::vector<MeshFileSubmesh> m_submeshes;
+  std::vector<MeshCluster> m_clusters;
+  LocalBounds m_bounds;
+  XMFLOAT4X4 m_dequantization = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+  MeshFile m_cooked;
+  std::vector<BYTE> m_indices;
   std::string m_filename;
-  std::wstring m_texturename;
 
 };
@@ -0,0 +1,365 @@
+#include "MeshClusterizer.h"
+
+static constexpr UINT s_None = std::numeric_limits<UINT>::max();
+
+// below this the normals spread too far for the cone to reject anything in practice, the cluster is never backface culled
+static constexpr float s_MinimumConeDot = 0.1f;
+
+// unconnected triangles looked at once the surface of a cluster has no free neighbours left
+static constexpr size_t s_ScanWindow = 256;
+
+// field of view of the simulated cameras, the same as the one of the level camera
+static constexpr float s_AnalysisFieldOfView = 75.0f * 3.14159265f / 180.0f;
+
+struct Float3
+{
+  float x, y, z;
+};
+
+static inline Float3 Add(const Float3& a, const Float3& b) noexcept { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+static inline Float3 Subtract(const Float3& a, const Float3& b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static inline Float3 Scale(const Float3& a, const float s) noexcept { return { a.x * s, a.y * s, a.z * s }; }
+static inline Float3 Cross(const Float3& a, const Float3& b) noexcept { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+static inline float Dot(const Float3& a, const Float3& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static inline float Length(const Float3& a) noexcept { return sqrtf(Dot(a, a)); }
+static inline Float3 Load(const Vertex& vertex) noexcept { return { vertex.Position.x, vertex.Position.y, vertex.Position.z }; }
+static inline Float3 Load(const XMFLOAT3& v) noexcept { return { v.x, v.y, v.z }; }
+
+struct PositionHash
+{
+  size_t operator()(const std::array<uint32_t, 3>& key) const noexcept { return (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u); }
+};
+
+// UV seams split the vertices of a surface, clusters grow across them by position
+static void BuildPositionRemap(const Vertex* vertices, size_t vertexCount, std::vector<UINT>& remap)
+{
+  std::unordered_map<std::array<uint32_t, 3>, UINT, PositionHash> first;
+
+  first.reserve(vertexCount);
+  remap.resize(vertexCount);
+
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    std::array<uint32_t, 3> key;
+
+    memcpy(key.data(), &vertices[v].Position, sizeof(key));
+
+    remap[v] = first.insert({ key, static_cast<UINT>(v) }).first->second;
+  }
+}
+
+// Ritter's bounding sphere, within a few percent of the minimal one
+static void ComputeSphere(const Vertex* vertices, const std::vector<DWORD>& points, MeshCluster& cluster) noexcept
+{
+  // the point furthest from any point, then the one furthest from that one span the initial sphere
+  const auto furthest = [&](const Float3& from)
+  {
+    Float3 result = from;
+    float distance = 0.0f;
+
+    for (const auto v : points)
+    {
+      const Float3 d = Subtract(Load(vertices[v]), from);
+
+      if (Dot(d, d) > distance)
+      {
+        result = Load(vertices[v]);
+        distance = Dot(d, d);
+      }
+    }
+
+    return result;
+  };
+
+  const Float3 a = furthest(Load(vertices[points.front()]));
+  const Float3 b = furthest(a);
+
+  Float3 center = Scale(Add(a, b), 0.5f);
+  float radius = Length(Subtract(b, a)) * 0.5f;
+
+  // grow the sphere just enough to take in every point outside of it
+  for (const auto v : points)
+  {
+    const Float3 p = Load(vertices[v]);
+    const float distance = Length(Subtract(p, center));
+
+    if (distance <= radius) continue;
+
+    const float grown = (radius + distance) * 0.5f;
+
+    center = Add(center, Scale(Subtract(p, center), (grown - radius) / distance));
+    radius = grown;
+  }
+
+  cluster.Center = { center.x, center.y, center.z };
+  cluster.Radius = radius;
+}
+
+// the cone axis is the average of the unit normals, the cutoff follows from the normal furthest away from it
+static void ComputeCone(const DWORD* indices, const Vertex* vertices, MeshCluster& cluster) noexcept
+{
+  std::vector<Float3> normals;
+  Float3 sum = {};
+
+  for (UINT i = cluster.IndexStart; i < cluster.IndexStart + cluster.IndexCount; i += 3)
+  {
+    const Float3 a = Load(vertices[indices[i]]);
+    const Float3 n = Cross(Subtract(Load(vertices[indices[i + 1]]), a), Subtract(Load(vertices[indices[i + 2]]), a));
+    const float length = Length(n);
+
+    // degenerate triangles are never rasterized, they do not restrict the cone
+    if (length == 0.0f) continue;
+
+    normals.push_back(Scale(n, 1.0f / length));
+    sum = Add(sum, normals.back());
+  }
+
+  const float length = Length(sum);
+
+  cluster.ConeAxis = { 0.0f, 0.0f, 0.0f };
+  cluster.ConeCutoff = 1.0f;
+
+  if (length == 0.0f) return;
+
+  const Float3 axis = Scale(sum, 1.0f / length);
+
+  float minimum = 1.0f;
+
+  for (const auto& n : normals) minimum = std::min(minimum, Dot(n, axis));
+
+  cluster.ConeAxis = { axis.x, axis.y, axis.z };
+
+  if (minimum > s_MinimumConeDot) cluster.ConeCutoff = sqrtf(1.0f - minimum * minimum);
+}
+
+void MeshClusterizer::BuildClusters(DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, std::vector<MeshCluster>& clusters)
+{
+  const size_t triangleCount = indexCount / 3;
+
+  if (!triangleCount) return;
+
+  std::vector<UINT> remap;
+
+  BuildPositionRemap(vertices, vertexCount, remap);
+
+  // triangles per position
+  std::vector<UINT> offsets(vertexCount + 1, 0);
+  std::vector<UINT> adjacency(triangleCount * 3);
+
+  for (size_t i = 0; i < triangleCount * 3; ++i) ++offsets[remap[indices[i]] + 1];
+  for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+
+  std::vector<UINT> fill(offsets.begin(), offsets.end() - 1);
+
+  for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[remap[indices[i]]]++] = static_cast<UINT>(i / 3);
+
+  std::vector<Float3> centroids(triangleCount);
+
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    centroids[t] = Scale(Add(Add(Load(vertices[indices[t * 3]]), Load(vertices[indices[t * 3 + 1]])), Load(vertices[indices[t * 3 + 2]])), 1.0f / 3.0f);
+  }
+
+  // the cluster a vertex and a position were last added to
+  std::vector<UINT> vertexCluster(vertexCount, s_None);
+  std::vector<UINT> positionCluster(vertexCount, s_None);
+  std::vector<bool> emitted(triangleCount, false);
+
+  std::vector<DWORD> output;
+  std::vector<DWORD> clusterVertices;
+  std::vector<UINT> clusterPositions;
+
+  output.reserve(triangleCount * 3);
+
+  const size_t first = clusters.size();
+  size_t seed = 0;
+
+  for (;;)
+  {
+    // every cluster starts at the first triangle left in input order, which keeps the overdraw order of the clusters
+    while (seed < triangleCount && emitted[seed]) ++seed;
+
+    if (seed == triangleCount) break;
+
+    const UINT id = static_cast<UINT>(clusters.size());
+
+    MeshCluster cluster = {};
+
+    cluster.IndexStart = static_cast<uint32_t>(output.size());
+
+    clusterVertices.clear();
+    clusterPositions.clear();
+
+    Float3 sum = {};
+    UINT next = static_cast<UINT>(seed);
+
+    while (next != s_None)
+    {
+      emitted[next] = true;
+      sum = Add(sum, centroids[next]);
+
+      for (size_t k = next * 3; k < next * 3 + 3; ++k)
+      {
+        const DWORD v = indices[k];
+
+        output.push_back(v);
+
+        if (vertexCluster[v] != id)
+        {
+          vertexCluster[v] = id;
+          clusterVertices.push_back(v);
+        }
+
+        if (positionCluster[remap[v]] != id)
+        {
+          positionCluster[remap[v]] = id;
+          clusterPositions.push_back(remap[v]);
+        }
+      }
+
+      if (output.size() - cluster.IndexStart == MaxTriangles * 3) break;
+
+      // the neighbour that adds the fewest new vertices, ties go to the one closest to the cluster's centroid
+      const Float3 center = Scale(sum, 3.0f / (output.size() - cluster.IndexStart));
+
+      UINT bestAdded = 4;
+      float bestDistance = std::numeric_limits<float>::max();
+
+      next = s_None;
+
+      for (const auto p : clusterPositions)
+      {
+        for (UINT a = offsets[p]; a < offsets[p + 1]; ++a)
+        {
+          const UINT t = adjacency[a];
+
+          if (emitted[t]) continue;
+
+          UINT added = 0;
+
+          for (size_t k = t * 3; k < t * 3 + 3; ++k) added += vertexCluster[indices[k]] != id;
+
+          if (clusterVertices.size() + added > MaxVertices) continue;
+
+          const Float3 d = Subtract(centroids[t], center);
+          const float distance = Dot(d, d);
+
+          if (added < bestAdded || (added == bestAdded && distance < bestDistance))
+          {
+            next = t;
+            bestAdded = added;
+            bestDistance = distance;
+          }
+        }
+      }
+
+      if (next != s_None || clusterVertices.size() + 3 > MaxVertices) continue;
+
+      // the connected surface is used up, a close triangle further down the input order may still join
+      float extent = 0.0f;
+
+      for (const auto v : clusterVertices) extent = std::max(extent, Dot(Subtract(Load(vertices[v]), center), Subtract(Load(vertices[v]), center)));
+
+      size_t scanned = 0;
+
+      for (size_t t = seed; t < triangleCount && scanned < s_ScanWindow; ++t)
+      {
+        if (emitted[t]) continue;
+
+        ++scanned;
+
+        const Float3 d = Subtract(centroids[t], center);
+        const float distance = Dot(d, d);
+
+        if (distance <= extent && distance < bestDistance)
+        {
+          next = static_cast<UINT>(t);
+          bestDistance = distance;
+        }
+      }
+    }
+
+    cluster.IndexCount = static_cast<uint32_t>(output.size() - cluster.IndexStart);
+
+    ComputeSphere(vertices, clusterVertices, cluster);
+
+    clusters.push_back(cluster);
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+
+  // the cones need the final index order
+  for (size_t c = first; c < clusters.size(); ++c) ComputeCone(indices, vertices, clusters[c]);
+}
+
+ClusterCullingStatistics MeshClusterizer::AnalyzeClusterCulling(const MeshCluster* clusters, size_t clusterCount)
+{
+  ClusterCullingStatistics statistics;
+
+  if (!clusterCount) return statistics;
+
+  // the views are placed around the bounding box of all cluster spheres
+  Float3 minimum = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+  Float3 maximum = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+  for (size_t c = 0; c < clusterCount; ++c)
+  {
+    const auto& s = clusters[c];
+
+    minimum = { std::min(minimum.x, s.Center.x - s.Radius), std::min(minimum.y, s.Center.y - s.Radius), std::min(minimum.z, s.Center.z - s.Radius) };
+    maximum = { std::max(maximum.x, s.Center.x + s.Radius), std::max(maximum.y, s.Center.y + s.Radius), std::max(maximum.z, s.Center.z + s.Radius) };
+  }
+
+  const Float3 center = Scale(Add(minimum, maximum), 0.5f);
+  const float radius = Length(Subtract(maximum, minimum)) * 0.5f;
+
+  static const Float3 s_Directions[] =
+  {
+    { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+    { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, -1.0f },
+    { -1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, -1.0f }, { -1.0f, -1.0f, 1.0f }, { -1.0f, -1.0f, -1.0f },
+  };
+
+  // the side planes of a square frustum, a sphere is outside if it is completely beyond one of them
+  const float c = cosf(s_AnalysisFieldOfView * 0.5f);
+  const float s = sinf(s_AnalysisFieldOfView * 0.5f);
+
+  for (const auto& direction : s_Directions)
+  {
+    const Float3 forward = Scale(direction, 1.0f / Length(direction));
+    const Float3 up = fabsf(forward.y) > 0.9f ? Float3{ 1.0f, 0.0f, 0.0f } : Float3{ 0.0f, 1.0f, 0.0f };
+    const Float3 side = Cross(up, forward);
+    const Float3 right = Scale(side, 1.0f / Length(side));
+    const Float3 top = Cross(forward, right);
+
+    // one camera looking at the mesh from outside and one standing in its center looking out
+    const Float3 eyes[] = { Subtract(center, Scale(forward, radius * 2.0f)), center };
+
+    for (const auto& eye : eyes)
+    {
+      const XMFLOAT3 position = { eye.x, eye.y, eye.z };
+
+      ++statistics.Views;
+
+      for (size_t k = 0; k < clusterCount; ++k)
+      {
+        const auto& cluster = clusters[k];
+        const UINT triangles = cluster.IndexCount / 3;
+        const Float3 p = Subtract(Load(cluster.Center), eye);
+        const float x = Dot(p, right);
+        const float y = Dot(p, top);
+        const float z = Dot(p, forward);
+        const float r = cluster.Radius;
+
+        statistics.Triangles += triangles;
+
+        if (z < -r || x * c - z * s > r || -x * c - z * s > r || y * c - z * s > r || -y * c - z * s > r) statistics.FrustumRejected += triangles;
+        else if (IsBackfacing(cluster, position)) statistics.BackfaceRejected += triangles;
+      }
+    }
+  }
+
+  statistics.Rejected = static_cast<float>(statistics.FrustumRejected + statistics.BackfaceRejected) / statistics.Triangles;
+
+  return statistics;
+}
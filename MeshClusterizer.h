@@ -0,0 +1,51 @@
+#pragma once
+
+// a contiguous range of the index buffer of LOD 0, small enough to be culled on its own
+struct MeshCluster
+{
+  XMFLOAT3 Center;    // bounding sphere in object space
+  float Radius;
+  XMFLOAT3 ConeAxis;  // average facing direction of the triangles
+  float ConeCutoff;   // sine of the half angle of the normal cone, 1 if the triangles face too many directions to ever face away together
+  uint32_t IndexStart;
+  uint32_t IndexCount;
+  uint32_t Reserved[2];
+};
+
+struct ClusterCullingStatistics
+{
+  UINT Views = 0;
+  UINT Triangles = 0;        // triangles in all clusters, summed over all views
+  UINT FrustumRejected = 0;  // triangles in clusters outside the view frustum, summed over all views
+  UINT BackfaceRejected = 0; // triangles in clusters inside the frustum that face away, summed over all views
+  float Rejected = 0.0f;     // rejected per triangle, the share of a view that is never submitted
+};
+
+// splits a mesh into clusters for the CPU culling of LevelRenderer
+class MeshClusterizer
+{
+public:
+  static constexpr size_t MaxVertices = 64;
+  static constexpr size_t MaxTriangles = 124;
+
+  // reorders the triangles so every cluster is a contiguous range of indices and appends one MeshCluster per range
+  // clusters grow across shared vertices, a cluster is closed as soon as the next triangle does not fit anymore
+  static void BuildClusters(DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, std::vector<MeshCluster>& clusters);
+
+  // true if every triangle of the cluster faces away from position, both in object space
+  static inline bool IsBackfacing(const MeshCluster& cluster, const XMFLOAT3& position) noexcept
+  {
+    const XMFLOAT3 d = { cluster.Center.x - position.x, cluster.Center.y - position.y, cluster.Center.z - position.z };
+    const float distance = sqrtf(d.x * d.x + d.y * d.y + d.z * d.z);
+
+    return d.x * cluster.ConeAxis.x + d.y * cluster.ConeAxis.y + d.z * cluster.ConeAxis.z >= cluster.ConeCutoff * distance + cluster.Radius;
+  }
+
+  // culls the clusters for a fixed set of views, 75 degree cameras orbiting the mesh and looking out from its center
+  static ClusterCullingStatistics AnalyzeClusterCulling(const MeshCluster* clusters, size_t clusterCount);
+
+private:
+  MeshClusterizer(void) noexcept = delete;
+  ~MeshClusterizer(void) noexcept = delete;
+
+};
@@ -0,0 +1,345 @@
+#include "MeshFile.h"
+
+static constexpr uint32_t s_Magic = 0x4D434145; // "EACM"
+
+static inline uint64_t Align16(const uint64_t offset) noexcept { return (offset + 15) & ~15ull; }
+
+static const char s_Padding[16] = {};
+
+// vertices packed at once while a streamed mesh is finished
+static constexpr size_t s_PackBatch = 1 << 16;
+
+// 16 bit indices address vertices 0 to 65535
+static inline uint32_t IndexStride(const uint64_t vertexCount) noexcept { return vertexCount <= (1ull << 16) ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+// the whole AABB maps to the unorm16 range
+static void SetQuantization(MeshFileHeader& header, const XMFLOAT3& minimum, const XMFLOAT3& maximum) noexcept
+{
+  header.PositionOffset = minimum;
+  header.PositionScale = { maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z };
+}
+
+// places the tables behind the bounds, each one 16 byte aligned
+static void PlaceTables(MeshFileHeader& header, const UINT lodCount, const UINT submeshCount, const UINT materialCount, const UINT clusterCount) noexcept
+{
+  header.LodCount = lodCount;
+  header.LodOffset = Align16(header.BoundsOffset + sizeof(MeshFileBounds));
+  header.SubmeshCount = submeshCount;
+  header.SubmeshOffset = Align16(header.LodOffset + sizeof(MeshFileLod) * static_cast<uint64_t>(lodCount));
+  header.MaterialCount = materialCount;
+  header.MaterialOffset = Align16(header.SubmeshOffset + sizeof(MeshFileSubmesh) * static_cast<uint64_t>(lodCount) * submeshCount);
+  header.ClusterCount = clusterCount;
+  header.ClusterOffset = Align16(header.MaterialOffset + sizeof(MeshFileMaterial) * static_cast<uint64_t>(materialCount));
+}
+
+// output has to stand right behind the bounds
+static void WriteTables(std::ostream& output, const MeshFileHeader& header, const MeshFileLod* lods, const MeshFileSubmesh* submeshes, const MeshFileMaterial* materials, const MeshCluster* clusters)
+{
+  const uint64_t submeshCount = static_cast<uint64_t>(header.LodCount) * header.SubmeshCount;
+
+  output.write(s_Padding, header.LodOffset - (header.BoundsOffset + sizeof(MeshFileBounds)));
+  output.write(reinterpret_cast<const char*>(lods), sizeof(MeshFileLod) * header.LodCount);
+  output.write(s_Padding, header.SubmeshOffset - (header.LodOffset + sizeof(MeshFileLod) * header.LodCount));
+  output.write(reinterpret_cast<const char*>(submeshes), sizeof(MeshFileSubmesh) * submeshCount);
+  output.write(s_Padding, header.MaterialOffset - (header.SubmeshOffset + sizeof(MeshFileSubmesh) * submeshCount));
+  output.write(reinterpret_cast<const char*>(materials), sizeof(MeshFileMaterial) * header.MaterialCount);
+  output.write(s_Padding, header.ClusterOffset - (header.MaterialOffset + sizeof(MeshFileMaterial) * header.MaterialCount));
+  output.write(reinterpret_cast<const char*>(clusters), sizeof(MeshCluster) * header.ClusterCount);
+}
+
+MeshFile::MeshFile(MeshFile&& other) noexcept :
+  m_File(std::move(other.m_File)),
+  m_Header(other.m_Header)
+{
+  other.m_Header = nullptr;
+}
+
+MeshFile& MeshFile::operator=(MeshFile&& other) noexcept
+{
+  m_File = std::move(other.m_File);
+  m_Header = other.m_Header;
+  other.m_Header = nullptr;
+
+  return *this;
+}
+
+bool MeshFile::Write(const std::string& filename, const Vertex* vertices, UINT vertexCount, const DWORD* indices, UINT indexCount, const MeshFileTables& tables, VertexPackingStatistics& statistics) noexcept
+{
+  if (tables.Lods.empty() || tables.Submeshes.size() % tables.Lods.size()) return false;
+
+  MeshFileHeader header = {};
+
+  header.Magic = s_Magic;
+  header.Version = MeshFile::Version;
+  header.VertexStride = sizeof(PackedVertex);
+  header.VertexCount = vertexCount;
+  header.IndexCount = indexCount;
+  header.IndexStride = IndexStride(vertexCount);
+
+  std::vector<BYTE> encoded;
+  DWORD previous = 0;
+
+  IndexCodec::Encode(indices, indexCount, previous, encoded);
+
+  header.VertexOffset = Align16(sizeof(MeshFileHeader));
+  header.IndexOffset = Align16(header.VertexOffset + sizeof(PackedVertex) * static_cast<uint64_t>(vertexCount));
+  header.IndexSize = encoded.size();
+  header.BoundsOffset = Align16(header.IndexOffset + header.IndexSize);
+
+  PlaceTables(header, static_cast<UINT>(tables.Lods.size()), static_cast<UINT>(tables.Submeshes.size() / tables.Lods.size()),
+    static_cast<UINT>(tables.Materials.size()), static_cast<UINT>(tables.Clusters.size()));
+
+  MeshFileBounds bounds = {};
+  std::vector<PackedVertex> packed(vertexCount);
+
+  if (vertexCount)
+  {
+    const auto* points = &vertices->Position;
+
+    BoundingBox::CreateFromPoints(bounds.AABB, vertexCount, points, sizeof(Vertex));
+    BoundingSphere::CreateFromPoints(bounds.Sphere, vertexCount, points, sizeof(Vertex));
+    BoundingOrientedBox::CreateFromPoints(bounds.OBB, vertexCount, points, sizeof(Vertex));
+
+    XMFLOAT3 minimum = vertices->Position;
+    XMFLOAT3 maximum = vertices->Position;
+
+    for (UINT i = 1; i < vertexCount; ++i)
+    {
+      const auto& position = vertices[i].Position;
+
+      minimum = { std::min(minimum.x, position.x), std::min(minimum.y, position.y), std::min(minimum.z, position.z) };
+      maximum = { std::max(maximum.x, position.x), std::max(maximum.y, position.y), std::max(maximum.z, position.z) };
+    }
+
+    SetQuantization(header, minimum, maximum);
+
+    MeshOptimizer::PackVertices(vertices, vertexCount, header.PositionOffset, header.PositionScale, packed.data(), statistics);
+  }
+
+  // write next to the target and swap it in afterwards, so an interrupted cook never leaves a truncated file behind
+  // threads cooking the same content at once each write their own temporary file, the last move wins
+  const auto temporary = filename + "." + std::to_string(GetCurrentThreadId()) + ".tmp";
+
+  {
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+
+    if (!output.is_open()) return false;
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(s_Padding, header.VertexOffset - sizeof(header));
+    output.write(reinterpret_cast<const char*>(packed.data()), sizeof(PackedVertex) * static_cast<uint64_t>(vertexCount));
+    output.write(s_Padding, header.IndexOffset - (header.VertexOffset + sizeof(PackedVertex) * static_cast<uint64_t>(vertexCount)));
+    output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    output.write(s_Padding, header.BoundsOffset - (header.IndexOffset + header.IndexSize));
+    output.write(reinterpret_cast<const char*>(&bounds), sizeof(bounds));
+
+    WriteTables(output, header, tables.Lods.data(), tables.Submeshes.data(), tables.Materials.data(), tables.Clusters.data());
+
+    if (!output.good()) return false;
+  }
+
+  return MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
+
+bool MeshFile::Open(const std::string& filename) noexcept
+{
+  Close();
+
+  if (!m_File.Open(filename)) return false;
+
+  const auto size = static_cast<uint64_t>(m_File.Size());
+  const auto* header = reinterpret_cast<const MeshFileHeader*>(m_File.Data());
+
+  // everything the accessors rely on has to be inside the mapped file
+  bool valid =
+    size >= sizeof(MeshFileHeader) &&
+    header->Magic == s_Magic &&
+    header->Version == MeshFile::Version &&
+    header->VertexStride == sizeof(PackedVertex) &&
+    header->VertexOffset + sizeof(PackedVertex) * static_cast<uint64_t>(header->VertexCount) <= size &&
+    header->IndexStride == IndexStride(header->VertexCount) &&
+    header->IndexOffset + header->IndexSize <= size &&
+    header->BoundsOffset + sizeof(MeshFileBounds) <= size &&
+    header->LodCount > 0 &&
+    header->SubmeshCount > 0 &&
+    header->MaterialCount > 0 &&
+    header->LodOffset + sizeof(MeshFileLod) * static_cast<uint64_t>(header->LodCount) <= size &&
+    header->SubmeshOffset + sizeof(MeshFileSubmesh) * static_cast<uint64_t>(header->LodCount) * header->SubmeshCount <= size &&
+    header->MaterialOffset + sizeof(MeshFileMaterial) * static_cast<uint64_t>(header->MaterialCount) <= size &&
+    header->ClusterOffset + sizeof(MeshCluster) * static_cast<uint64_t>(header->ClusterCount) <= size;
+
+  // every submesh has to stay inside the index blob and its clusters inside the submesh
+  for (uint64_t i = 0; valid && i < static_cast<uint64_t>(header->LodCount) * header->SubmeshCount; ++i)
+  {
+    const auto& submesh = reinterpret_cast<const MeshFileSubmesh*>(m_File.Data() + header->SubmeshOffset)[i];
+
+    valid =
+      submesh.Material < header->MaterialCount &&
+      static_cast<uint64_t>(submesh.IndexStart) + submesh.IndexCount <= header->IndexCount &&
+      static_cast<uint64_t>(submesh.ClusterStart) + submesh.ClusterCount <= header->ClusterCount;
+
+    for (UINT c = 0; valid && c < submesh.ClusterCount; ++c)
+    {
+      const auto& cluster = reinterpret_cast<const MeshCluster*>(m_File.Data() + header->ClusterOffset)[submesh.ClusterStart + c];
+
+      valid = cluster.IndexStart >= submesh.IndexStart && static_cast<uint64_t>(cluster.IndexStart) + cluster.IndexCount <= static_cast<uint64_t>(submesh.IndexStart) + submesh.IndexCount;
+    }
+  }
+
+  // the names have to be terminated
+  for (UINT i = 0; valid && i < header->MaterialCount; ++i)
+  {
+    const auto& material = reinterpret_cast<const MeshFileMaterial*>(m_File.Data() + header->MaterialOffset)[i];
+
+    valid = material.Name[sizeof(material.Name) - 1] == '\0' && material.Texture[sizeof(material.Texture) - 1] == '\0';
+  }
+
+  if (!valid)
+  {
+    m_File.Close();
+
+    return false;
+  }
+
+  m_Header = header;
+
+  return true;
+}
+
+void MeshFile::Close(void) noexcept
+{
+  m_Header = nullptr;
+  m_File.Close();
+}
+
+MeshFileWriter::MeshFileWriter(const std::string& filename) :
+  m_Filename(filename),
+  m_Temporary(filename + "." + std::to_string(GetCurrentThreadId())),
+  m_Output(m_Temporary + ".tmp", std::ios::binary | std::ios::trunc),
+  m_VertexSpill(m_Temporary + ".vertices.tmp", std::ios::binary | std::ios::trunc | std::ios::in | std::ios::out),
+  m_IndexSpill(m_Temporary + ".indices.tmp", std::ios::binary | std::ios::trunc | std::ios::in | std::ios::out)
+{
+  // the header is written last, once all counts are known
+  const MeshFileHeader header = {};
+
+  m_Output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_Output.write(s_Padding, Align16(sizeof(header)) - sizeof(header));
+}
+
+MeshFileWriter::~MeshFileWriter(void) noexcept
+{
+  m_Output.close();
+  m_VertexSpill.close();
+  m_IndexSpill.close();
+
+  std::remove((m_Temporary + ".vertices.tmp").c_str());
+  std::remove((m_Temporary + ".indices.tmp").c_str());
+
+  if (!m_Finished) std::remove((m_Temporary + ".tmp").c_str());
+}
+
+bool MeshFileWriter::Vertices(const Vertex* vertices, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    const auto& position = vertices[i].Position;
+
+    m_Min = { std::min(m_Min.x, position.x), std::min(m_Min.y, position.y), std::min(m_Min.z, position.z) };
+    m_Max = { std::max(m_Max.x, position.x), std::max(m_Max.y, position.y), std::max(m_Max.z, position.z) };
+  }
+
+  m_VertexSpill.write(reinterpret_cast<const char*>(vertices), sizeof(Vertex) * count);
+  m_VertexCount += count;
+
+  return m_VertexSpill.good() && m_VertexCount <= UINT_MAX;
+}
+
+bool MeshFileWriter::Indices(const DWORD* indices, size_t count)
+{
+  m_IndexSpill.write(reinterpret_cast<const char*>(indices), sizeof(DWORD) * count);
+  m_IndexCount += count;
+
+  return m_IndexSpill.good() && m_IndexCount <= UINT_MAX;
+}
+
+bool MeshFileWriter::Finish(void)
+{
+  MeshFileHeader header = {};
+
+  header.Magic = s_Magic;
+  header.Version = MeshFile::Version;
+  header.VertexStride = sizeof(PackedVertex);
+  header.VertexCount = static_cast<uint32_t>(m_VertexCount);
+  header.IndexCount = static_cast<uint32_t>(m_IndexCount);
+  header.IndexStride = IndexStride(m_VertexCount);
+  header.VertexOffset = Align16(sizeof(MeshFileHeader));
+  header.IndexOffset = Align16(header.VertexOffset + sizeof(PackedVertex) * m_VertexCount);
+
+  if (m_VertexCount) SetQuantization(header, m_Min, m_Max);
+
+  // pack the spilled vertices batch by batch now that the AABB is known
+  std::vector<Vertex> vertices(s_PackBatch);
+  std::vector<PackedVertex> packed(s_PackBatch);
+
+  m_VertexSpill.seekg(0);
+
+  while (m_VertexSpill.read(reinterpret_cast<char*>(vertices.data()), sizeof(Vertex) * s_PackBatch) || m_VertexSpill.gcount())
+  {
+    const size_t count = static_cast<size_t>(m_VertexSpill.gcount()) / sizeof(Vertex);
+
+    MeshOptimizer::PackVertices(vertices.data(), count, header.PositionOffset, header.PositionScale, packed.data(), m_Statistics);
+
+    m_Output.write(reinterpret_cast<const char*>(packed.data()), sizeof(PackedVertex) * count);
+  }
+
+  m_Output.write(s_Padding, header.IndexOffset - (header.VertexOffset + sizeof(PackedVertex) * m_VertexCount));
+
+  // encode the spilled indices through a fixed size buffer, a whole number of codec blocks at a time
+  std::vector<DWORD> indices(IndexCodec::BlockSize * 64);
+  std::vector<BYTE> encoded;
+  DWORD previous = 0;
+
+  m_IndexSpill.seekg(0);
+
+  while (m_IndexSpill.read(reinterpret_cast<char*>(indices.data()), sizeof(DWORD) * indices.size()) || m_IndexSpill.gcount())
+  {
+    encoded.clear();
+
+    IndexCodec::Encode(indices.data(), static_cast<size_t>(m_IndexSpill.gcount()) / sizeof(DWORD), previous, encoded);
+
+    m_Output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    header.IndexSize += encoded.size();
+  }
+
+  header.BoundsOffset = Align16(header.IndexOffset + header.IndexSize);
+
+  MeshFileBounds bounds = {};
+
+  if (m_VertexCount)
+  {
+    BoundingBox::CreateFromPoints(bounds.AABB, XMLoadFloat3(&m_Min), XMLoadFloat3(&m_Max));
+    BoundingSphere::CreateFromBoundingBox(bounds.Sphere, bounds.AABB);
+    BoundingOrientedBox::CreateFromBoundingBox(bounds.OBB, bounds.AABB);
+  }
+
+  m_Output.write(s_Padding, header.BoundsOffset - (header.IndexOffset + header.IndexSize));
+  m_Output.write(reinterpret_cast<const char*>(&bounds), sizeof(bounds));
+
+  const MeshFileLod lod = { header.IndexCount / 3, 0.0f };
+  const MeshFileSubmesh submesh = { 0, 0, header.IndexCount, 0, 0 };
+  const MeshFileMaterial material = {};
+
+  PlaceTables(header, 1, 1, 1, 0);
+  WriteTables(m_Output, header, &lod, &submesh, &material, nullptr);
+
+  m_Output.seekp(0);
+  m_Output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  if (!m_Output.good()) return false;
+
+  m_Output.close();
+
+  m_Finished = MoveFileExA((m_Temporary + ".tmp").c_str(), m_Filename.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+
+  return m_Finished;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "IndexCodec.h"
+#include "MeshOptimizer.h"
+#include "MeshClusterizer.h"
+
+// on disk layout of a cooked mesh: header, vertex blob, index blob, bounds, LOD, submesh, material and cluster table
+// every blob starts 16 byte aligned, vertices are stored as PackedVertex exactly as they are uploaded to the GPU
+// indices are compressed with IndexCodec and decoded to 16 bit if every vertex is reachable with them, else to 32 bit
+// every LOD has the same submeshes, one index range per material, all of them share the vertex blob
+// the clusters split the submeshes of LOD 0 into ranges that are culled one by one, a submesh without clusters is only culled as a whole
+struct MeshFileHeader
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t VertexStride;
+  uint32_t VertexCount;
+  uint32_t IndexCount;
+  uint32_t IndexStride;   // of the decoded indices
+  uint64_t VertexOffset;
+  uint64_t IndexOffset;
+  uint64_t IndexSize;     // of the encoded indices
+  uint64_t BoundsOffset;
+  XMFLOAT3 PositionOffset; // a packed position decodes to PositionOffset + unorm * PositionScale
+  XMFLOAT3 PositionScale;
+  uint32_t LodCount;
+  uint64_t LodOffset;
+  uint32_t SubmeshCount;   // per LOD
+  uint64_t SubmeshOffset;
+  uint32_t MaterialCount;
+  uint64_t MaterialOffset;
+  uint32_t ClusterCount;
+  uint64_t ClusterOffset;
+};
+
+// local space bounds of all vertices, computed once while cooking
+struct MeshFileBounds
+{
+  BoundingBox AABB;
+  BoundingSphere Sphere;
+  BoundingOrientedBox OBB;
+};
+
+// one level of detail, LOD 0 is the full mesh and every following one has fewer triangles
+struct MeshFileLod
+{
+  uint32_t TriangleCount; // of all its submeshes
+  float Error;            // largest distance of its surface from the full mesh in object space units
+  uint32_t Reserved[2];
+};
+
+// the triangles of one material in one LOD, a coarser LOD may share the range of the one before it
+struct MeshFileSubmesh
+{
+  uint32_t Material;
+  uint32_t IndexStart;
+  uint32_t IndexCount;
+  uint32_t ClusterStart;  // only LOD 0 has clusters
+  uint32_t ClusterCount;
+  uint32_t Reserved[3];
+};
+
+struct MeshFileMaterial
+{
+  char Name[64];
+  char Texture[192];      // relative to the working directory, empty for the texture the mesh is created with
+};
+
+// the tables MeshFile::Write stores next to the vertices and indices
+struct MeshFileTables
+{
+  std::vector<MeshFileLod> Lods;
+  std::vector<MeshFileSubmesh> Submeshes;   // the same number for every LOD, LOD by LOD and sorted by material inside each
+  std::vector<MeshFileMaterial> Materials;
+  std::vector<MeshCluster> Clusters;
+};
+
+class MeshFile
+{
+public:
+  MeshFile(void) noexcept = default;
+  MeshFile(MeshFile&& other) noexcept;
+  ~MeshFile(void) noexcept = default;
+
+  MeshFile& operator=(MeshFile&& other) noexcept;
+
+  // packs the vertices on the way out and adds their quantization error to statistics
+  static bool Write(const std::string& filename, const Vertex* vertices, UINT vertexCount, const DWORD* indices, UINT indexCount, const MeshFileTables& tables, VertexPackingStatistics& statistics) noexcept;
+
+  // raised with every change of the layout or the cook, part of the import cache key so every mesh is cooked again
+  static constexpr uint32_t Version = 9;
+
+  bool Open(const std::string& filename) noexcept;
+  void Close(void) noexcept;
+
+  inline bool IsOpen(void) const noexcept { return m_Header != nullptr; }
+
+  inline UINT VertexCount(void) const noexcept { return m_Header->VertexCount; }
+  inline UINT IndexCount(void) const noexcept { return m_Header->IndexCount; }
+
+  inline const PackedVertex* Vertices(void) const noexcept { return reinterpret_cast<const PackedVertex*>(m_File.Data() + m_Header->VertexOffset); }
+  inline UINT IndexStride(void) const noexcept { return m_Header->IndexStride; }
+  inline const MeshFileBounds& Bounds(void) const noexcept { return *reinterpret_cast<const MeshFileBounds*>(m_File.Data() + m_Header->BoundsOffset); }
+  inline const XMFLOAT3& PositionOffset(void) const noexcept { return m_Header->PositionOffset; }
+  inline const XMFLOAT3& PositionScale(void) const noexcept { return m_Header->PositionScale; }
+  inline UINT LodCount(void) const noexcept { return m_Header->LodCount; }
+  inline const MeshFileLod* Lods(void) const noexcept { return reinterpret_cast<const MeshFileLod*>(m_File.Data() + m_Header->LodOffset); }
+  inline UINT SubmeshCount(void) const noexcept { return m_Header->SubmeshCount; }
+  // SubmeshCount submeshes per LOD
+  inline const MeshFileSubmesh* Submeshes(void) const noexcept { return reinterpret_cast<const MeshFileSubmesh*>(m_File.Data() + m_Header->SubmeshOffset); }
+  inline UINT MaterialCount(void) const noexcept { return m_Header->MaterialCount; }
+  inline const MeshFileMaterial* Materials(void) const noexcept { return reinterpret_cast<const MeshFileMaterial*>(m_File.Data() + m_Header->MaterialOffset); }
+  inline UINT ClusterCount(void) const noexcept { return m_Header->ClusterCount; }
+  inline const MeshCluster* Clusters(void) const noexcept { return reinterpret_cast<const MeshCluster*>(m_File.Data() + m_Header->ClusterOffset); }
+
+  // decodes IndexCount indices of IndexStride bytes each
+  inline bool DecodeIndices(void* indices) const noexcept { return IndexCodec::Decode(reinterpret_cast<const BYTE*>(m_File.Data() + m_Header->IndexOffset), static_cast<size_t>(m_Header->IndexSize), m_Header->IndexCount, m_Header->IndexStride, indices); }
+
+private:
+  MappedFile m_File;
+  const MeshFileHeader* m_Header = nullptr;
+
+};
+
+// writes a cooked mesh batch by batch, vertices and indices are spilled to temporary files
+// the vertices can only be packed once the AABB of all of them is known, the index stride once the vertex count is
+// the sphere and oriented box of a streamed mesh are derived from its AABB, it is written as a single LOD and submesh without clusters
+class MeshFileWriter : public ObjSink
+{
+public:
+  MeshFileWriter(const std::string& filename);
+  ~MeshFileWriter(void) noexcept;
+
+  virtual bool Vertices(const Vertex* vertices, size_t count) override;
+  virtual bool Indices(const DWORD* indices, size_t count) override;
+
+  bool Finish(void);
+
+  inline const VertexPackingStatistics& Statistics(void) const noexcept { return m_Statistics; }
+
+private:
+  std::string m_Filename;
+  std::string m_Temporary;  // the name of the temporary files without extension, per thread so concurrent writers of the same artifact never share them
+  std::ofstream m_Output;
+  std::fstream m_VertexSpill;
+  std::fstream m_IndexSpill;
+
+  uint64_t m_VertexCount = 0;
+  uint64_t m_IndexCount = 0;
+  XMFLOAT3 m_Min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+  XMFLOAT3 m_Max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+  VertexPackingStatistics m_Statistics;
+  bool m_Finished = false;
+
+};
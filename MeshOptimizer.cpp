@@ -0,0 +1,612 @@
+#include "MeshOptimizer.h"
+
+// tuning values from the original paper, the cache is modelled as LRU with 32 entries
+static constexpr int s_CacheSize = 32;
+static constexpr float s_CacheDecayPower = 1.5f;
+static constexpr float s_LastTriangleScore = 0.75f;
+static constexpr float s_ValenceBoostScale = 2.0f;
+static constexpr float s_ValenceBoostPower = 0.5f;
+
+static float VertexScore(const int cachePosition, const UINT remaining) noexcept
+{
+  // vertices without triangles left must never attract a triangle
+  if (remaining == 0) return -1.0f;
+
+  float score = 0.0f;
+
+  if (cachePosition >= 0)
+  {
+    // the three vertices of the last triangle get a fixed score so the next triangle does not simply reuse them all
+    if (cachePosition < 3) score = s_LastTriangleScore;
+    else score = powf(1.0f - (cachePosition - 3) * (1.0f / (s_CacheSize - 3)), s_CacheDecayPower);
+  }
+
+  // vertices with few triangles left are finished first to free up the cache
+  return score + s_ValenceBoostScale * powf(static_cast<float>(remaining), -s_ValenceBoostPower);
+}
+
+void MeshOptimizer::OptimizeVertexCache(DWORD* indices, size_t indexCount, size_t vertexCount)
+{
+  const size_t triangleCount = indexCount / 3;
+
+  if (triangleCount < 2) return;
+
+  // triangles per vertex, the first remaining[v] entries of a vertex are the ones not emitted yet
+  std::vector<UINT> offsets(vertexCount + 1, 0);
+  std::vector<UINT> remaining(vertexCount, 0);
+  std::vector<UINT> adjacency(triangleCount * 3);
+
+  for (size_t i = 0; i < triangleCount * 3; ++i) ++remaining[indices[i]];
+  for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + remaining[v];
+
+  std::vector<UINT> fill(offsets.begin(), offsets.end() - 1);
+
+  for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[indices[i]]++] = static_cast<UINT>(i / 3);
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScore(vertexCount);
+  std::vector<float> triangleScore(triangleCount);
+  std::vector<bool> emitted(triangleCount, false);
+
+  for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = VertexScore(-1, remaining[v]);
+
+  int best = 0;
+
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    if (triangleScore[t] > triangleScore[best]) best = static_cast<int>(t);
+  }
+
+  std::vector<DWORD> output;
+  output.reserve(triangleCount * 3);
+
+  std::array<DWORD, s_CacheSize + 3> cache;
+  std::array<DWORD, s_CacheSize + 3> next;
+  size_t cacheCount = 0;
+  size_t cursor = 0;
+
+  while (output.size() < triangleCount * 3)
+  {
+    // nothing in the cache has triangles left, continue with the next triangle in input order
+    if (best < 0)
+    {
+      while (emitted[cursor]) ++cursor;
+
+      best = static_cast<int>(cursor);
+    }
+
+    const DWORD* triangle = &indices[best * 3];
+
+    emitted[best] = true;
+
+    for (int k = 0; k < 3; ++k)
+    {
+      const DWORD v = triangle[k];
+      UINT* begin = &adjacency[offsets[v]];
+      UINT* end = begin + remaining[v];
+      UINT* it = std::find(begin, end, static_cast<UINT>(best));
+
+      // move the emitted triangle out of the active range
+      if (it != end)
+      {
+        std::swap(*it, *(end - 1));
+        --remaining[v];
+      }
+
+      output.push_back(v);
+    }
+
+    // the triangle's vertices move to the front, everything else is pushed back by up to three slots
+    size_t nextCount = 0;
+
+    for (int k = 0; k < 3; ++k)
+    {
+      if (std::find(next.begin(), next.begin() + nextCount, triangle[k]) == next.begin() + nextCount) next[nextCount++] = triangle[k];
+    }
+
+    for (size_t i = 0; i < cacheCount; ++i)
+    {
+      if (std::find(next.begin(), next.begin() + nextCount, cache[i]) == next.begin() + nextCount) next[nextCount++] = cache[i];
+    }
+
+    for (size_t i = 0; i < nextCount; ++i)
+    {
+      const DWORD v = next[i];
+
+      cachePosition[v] = (i < s_CacheSize) ? static_cast<int>(i) : -1;
+      vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+    }
+
+    // only triangles touching the cache changed their score, the best of them is emitted next
+    best = -1;
+    float bestScore = -1.0f;
+
+    for (size_t i = 0; i < nextCount; ++i)
+    {
+      const DWORD v = next[i];
+
+      for (UINT a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+      {
+        const UINT t = adjacency[a];
+
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+        if (triangleScore[t] > bestScore)
+        {
+          best = static_cast<int>(t);
+          bestScore = triangleScore[t];
+        }
+      }
+    }
+
+    cacheCount = std::min<size_t>(nextCount, s_CacheSize);
+    std::copy(next.begin(), next.begin() + cacheCount, cache.begin());
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+}
+
+VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const DWORD* indices, size_t indexCount, size_t vertexCount, UINT cacheSize, VertexCacheType type)
+{
+  VertexCacheStatistics statistics;
+
+  const size_t triangleCount = indexCount / 3;
+
+  if (triangleCount == 0 || cacheSize == 0) return statistics;
+
+  std::vector<bool> referenced(vertexCount, false);
+  size_t unique = 0;
+
+  for (size_t i = 0; i < indexCount; ++i)
+  {
+    if (!referenced[indices[i]]) ++unique;
+
+    referenced[indices[i]] = true;
+  }
+
+  if (type == VertexCacheType::FIFO)
+  {
+    // a vertex is still cached if fewer than cacheSize misses happened since it was transformed
+    std::vector<UINT> timestamp(vertexCount, 0);
+    UINT time = cacheSize + 1;
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+      if (time - timestamp[indices[i]] > cacheSize)
+      {
+        timestamp[indices[i]] = time++;
+        ++statistics.Transformed;
+      }
+    }
+  }
+  else
+  {
+    std::vector<DWORD> cache;
+    cache.reserve(cacheSize + 1);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+      const auto it = std::find(cache.begin(), cache.end(), indices[i]);
+
+      if (it == cache.end())
+      {
+        ++statistics.Transformed;
+
+        cache.insert(cache.begin(), indices[i]);
+
+        if (cache.size() > cacheSize) cache.pop_back();
+      }
+      else
+      {
+        std::rotate(cache.begin(), it, it + 1);
+      }
+    }
+  }
+
+  statistics.ACMR = static_cast<float>(statistics.Transformed) / triangleCount;
+  statistics.ATVR = static_cast<float>(statistics.Transformed) / unique;
+
+  return statistics;
+}
+
+// the clustering uses the same FIFO size the cook statistics are reported for
+static constexpr UINT s_ClusterCacheSize = 16;
+static constexpr int s_OverdrawViewportSize = 256;
+
+struct Float3
+{
+  float x, y, z;
+};
+
+static inline Float3 Subtract(const Float3& a, const Float3& b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static inline Float3 Cross(const Float3& a, const Float3& b) noexcept { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+static inline float Dot(const Float3& a, const Float3& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static inline float Length(const Float3& a) noexcept { return sqrtf(Dot(a, a)); }
+static inline Float3 Load(const Vertex& vertex) noexcept { return { vertex.Position.x, vertex.Position.y, vertex.Position.z }; }
+
+// a new cluster starts wherever the triangle order can be broken up while the ACMR of the part before stays within threshold times that of its hard cluster
+static void GenerateClusters(const DWORD* indices, size_t triangleCount, size_t vertexCount, float threshold, std::vector<UINT>& clusters)
+{
+  std::vector<UINT> timestamp(vertexCount, 0);
+  UINT time = s_ClusterCacheSize + 1;
+
+  const auto misses = [&](size_t triangle)
+  {
+    UINT count = 0;
+
+    for (size_t k = triangle * 3; k < triangle * 3 + 3; ++k)
+    {
+      if (time - timestamp[indices[k]] > s_ClusterCacheSize)
+      {
+        timestamp[indices[k]] = time++;
+        ++count;
+      }
+    }
+
+    return count;
+  };
+
+  // flushing the cache between clusters
+  const auto flush = [&]() { time += s_ClusterCacheSize + 1; };
+
+  // hard boundaries are triangles where every vertex misses anyway, splitting there is free
+  // the first triangle always starts a cluster, it misses less than 3 times if it is degenerate
+  std::vector<UINT> hard(1, 0);
+
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    if (misses(t) == 3 && t > 0) hard.push_back(static_cast<UINT>(t));
+  }
+
+  hard.push_back(static_cast<UINT>(triangleCount));
+
+  for (size_t h = 0; h + 1 < hard.size(); ++h)
+  {
+    const UINT begin = hard[h];
+    const UINT end = hard[h + 1];
+
+    flush();
+
+    UINT total = 0;
+
+    for (UINT t = begin; t < end; ++t) total += misses(t);
+
+    // soft boundaries split a hard cluster as soon as the part before is within threshold of the whole cluster's ACMR
+    const float target = threshold * total / (end - begin);
+
+    flush();
+
+    clusters.push_back(begin);
+
+    UINT start = begin;
+    UINT clusterMisses = 0;
+
+    for (UINT t = begin; t < end; ++t)
+    {
+      clusterMisses += misses(t);
+
+      if (t + 1 < end && clusterMisses <= target * (t + 1 - start))
+      {
+        clusters.push_back(t + 1);
+
+        start = t + 1;
+        clusterMisses = 0;
+
+        flush();
+      }
+    }
+  }
+
+  clusters.push_back(static_cast<UINT>(triangleCount));
+}
+
+void MeshOptimizer::OptimizeOverdraw(DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, float threshold)
+{
+  const size_t triangleCount = indexCount / 3;
+
+  if (triangleCount < 2) return;
+
+  std::vector<UINT> clusters;
+
+  GenerateClusters(indices, triangleCount, vertexCount, threshold, clusters);
+
+  const size_t clusterCount = clusters.size() - 1;
+
+  if (clusterCount < 2) return;
+
+  // area weighted centroids and normals, the length of the cross product is twice the triangle area
+  std::vector<Float3> centroids(clusterCount, Float3{});
+  std::vector<Float3> normals(clusterCount, Float3{});
+  std::vector<float> areas(clusterCount, 0.0f);
+  Float3 meshCentroid = {};
+  float meshArea = 0.0f;
+
+  for (size_t c = 0; c < clusterCount; ++c)
+  {
+    for (UINT t = clusters[c]; t < clusters[c + 1]; ++t)
+    {
+      const Float3 a = Load(vertices[indices[t * 3]]);
+      const Float3 b = Load(vertices[indices[t * 3 + 1]]);
+      const Float3 d = Load(vertices[indices[t * 3 + 2]]);
+
+      const Float3 normal = Cross(Subtract(b, a), Subtract(d, a));
+      const float area = Length(normal);
+
+      centroids[c].x += (a.x + b.x + d.x) * area;
+      centroids[c].y += (a.y + b.y + d.y) * area;
+      centroids[c].z += (a.z + b.z + d.z) * area;
+
+      normals[c].x += normal.x;
+      normals[c].y += normal.y;
+      normals[c].z += normal.z;
+
+      areas[c] += area * 3.0f;
+    }
+
+    meshCentroid.x += centroids[c].x;
+    meshCentroid.y += centroids[c].y;
+    meshCentroid.z += centroids[c].z;
+    meshArea += areas[c];
+  }
+
+  if (meshArea <= 0.0f) return;
+
+  meshCentroid = { meshCentroid.x / meshArea, meshCentroid.y / meshArea, meshCentroid.z / meshArea };
+
+  // clusters far out along their own normal occlude the rest of the mesh from most directions
+  std::vector<float> occlusion(clusterCount, 0.0f);
+
+  for (size_t c = 0; c < clusterCount; ++c)
+  {
+    const float length = Length(normals[c]);
+
+    if (areas[c] <= 0.0f || length <= 0.0f) continue;
+
+    const Float3 centroid = { centroids[c].x / areas[c], centroids[c].y / areas[c], centroids[c].z / areas[c] };
+
+    occlusion[c] = Dot(Subtract(centroid, meshCentroid), normals[c]) / length;
+  }
+
+  std::vector<UINT> order(clusterCount);
+
+  for (size_t c = 0; c < clusterCount; ++c) order[c] = static_cast<UINT>(c);
+
+  std::stable_sort(order.begin(), order.end(), [&](UINT a, UINT b) { return occlusion[a] > occlusion[b]; });
+
+  std::vector<DWORD> output;
+  output.reserve(triangleCount * 3);
+
+  for (const UINT c : order) output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+
+  // the clusters are consecutive ranges from the first to the last triangle, so the same count means every triangle is drawn exactly once
+  if (output.size() != triangleCount * 3)
+  {
+    Log::Error("OptimizeOverdraw: the clusters cover " + std::to_string(output.size() / 3) + " of " + std::to_string(triangleCount) + " triangles");
+    return;
+  }
+
+  std::copy(output.begin(), output.end(), indices);
+}
+
+OverdrawStatistics MeshOptimizer::AnalyzeOverdraw(const DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount)
+{
+  OverdrawStatistics statistics;
+
+  const size_t triangleCount = indexCount / 3;
+
+  if (triangleCount == 0 || vertexCount == 0) return statistics;
+
+  // the mesh is scaled into the unit sphere, so every view is an orthographic projection of the same size
+  Float3 minimum = Load(vertices[0]);
+  Float3 maximum = minimum;
+
+  for (size_t v = 1; v < vertexCount; ++v)
+  {
+    const Float3 p = Load(vertices[v]);
+
+    minimum = { std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z) };
+    maximum = { std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z) };
+  }
+
+  const Float3 center = { (minimum.x + maximum.x) * 0.5f, (minimum.y + maximum.y) * 0.5f, (minimum.z + maximum.z) * 0.5f };
+  const float radius = Length(Subtract(maximum, center));
+
+  if (radius <= 0.0f) return statistics;
+
+  // the six axes and the eight diagonals
+  static const Float3 s_Directions[] =
+  {
+    { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+    { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, -1.0f },
+    { -1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, -1.0f }, { -1.0f, -1.0f, 1.0f }, { -1.0f, -1.0f, -1.0f },
+  };
+
+  const float size = static_cast<float>(s_OverdrawViewportSize);
+
+  std::vector<float> depth(s_OverdrawViewportSize * s_OverdrawViewportSize);
+  std::vector<Float3> projected(vertexCount);
+
+  for (const auto& direction : s_Directions)
+  {
+    const Float3 forward = { direction.x / Length(direction), direction.y / Length(direction), direction.z / Length(direction) };
+    const Float3 up = fabsf(forward.y) > 0.9f ? Float3{ 1.0f, 0.0f, 0.0f } : Float3{ 0.0f, 1.0f, 0.0f };
+    const Float3 side = Cross(up, forward);
+    const Float3 right = { side.x / Length(side), side.y / Length(side), side.z / Length(side) };
+    const Float3 top = Cross(forward, right);
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+      const Float3 p = Subtract(Load(vertices[v]), center);
+
+      projected[v] = { (Dot(p, right) / radius * 0.5f + 0.5f) * size, (Dot(p, top) / radius * 0.5f + 0.5f) * size, Dot(p, forward) / radius };
+    }
+
+    std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+      const Float3& a = projected[indices[t * 3]];
+      const Float3& b = projected[indices[t * 3 + 1]];
+      const Float3& c = projected[indices[t * 3 + 2]];
+
+      // counter clockwise triangles are front facing, right and top form a left handed screen space with forward
+      const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+
+      if (area >= 0.0f) continue;
+
+      const int x0 = std::max(0, static_cast<int>(floorf(std::min({ a.x, b.x, c.x }))));
+      const int y0 = std::max(0, static_cast<int>(floorf(std::min({ a.y, b.y, c.y }))));
+      const int x1 = std::min(s_OverdrawViewportSize - 1, static_cast<int>(ceilf(std::max({ a.x, b.x, c.x }))));
+      const int y1 = std::min(s_OverdrawViewportSize - 1, static_cast<int>(ceilf(std::max({ a.y, b.y, c.y }))));
+
+      for (int y = y0; y <= y1; ++y)
+      {
+        for (int x = x0; x <= x1; ++x)
+        {
+          const float px = x + 0.5f;
+          const float py = y + 0.5f;
+
+          // edge functions, all of them are non positive inside a clockwise triangle in this space
+          const float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+          const float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+          const float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+
+          if (w0 > 0.0f || w1 > 0.0f || w2 > 0.0f) continue;
+
+          const float z = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+          float& stored = depth[y * s_OverdrawViewportSize + x];
+
+          if (z >= stored) continue;
+
+          if (stored == std::numeric_limits<float>::max()) ++statistics.Covered;
+
+          stored = z;
+          ++statistics.Shaded;
+        }
+      }
+    }
+  }
+
+  if (statistics.Covered) statistics.Overdraw = static_cast<float>(statistics.Shaded) / statistics.Covered;
+
+  return statistics;
+}
+
+// a typical L1 line size and a 16 KB cache in front of the vertex fetch
+static constexpr size_t s_FetchLineSize = 64;
+static constexpr UINT s_FetchCacheLines = 256;
+
+size_t MeshOptimizer::OptimizeVertexFetch(Vertex* vertices, DWORD* indices, size_t indexCount, size_t vertexCount)
+{
+  static constexpr DWORD s_Unused = std::numeric_limits<DWORD>::max();
+
+  std::vector<DWORD> remap(vertexCount, s_Unused);
+  DWORD next = 0;
+
+  for (size_t i = 0; i < indexCount; ++i)
+  {
+    DWORD& target = remap[indices[i]];
+
+    if (target == s_Unused) target = next++;
+
+    indices[i] = target;
+  }
+
+  std::vector<Vertex> reordered(next);
+
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    if (remap[v] != s_Unused) reordered[remap[v]] = vertices[v];
+  }
+
+  std::copy(reordered.begin(), reordered.end(), vertices);
+
+  return next;
+}
+
+VertexFetchStatistics MeshOptimizer::AnalyzeVertexFetch(const DWORD* indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+{
+  VertexFetchStatistics statistics;
+
+  if (indexCount == 0 || vertexCount == 0 || vertexSize == 0) return statistics;
+
+  std::vector<bool> referenced(vertexCount, false);
+  size_t unique = 0;
+
+  // same FIFO timestamps as the vertex cache simulation, one per cache line
+  std::vector<UINT> timestamp((vertexCount * vertexSize + s_FetchLineSize - 1) / s_FetchLineSize, 0);
+  UINT time = s_FetchCacheLines + 1;
+
+  for (size_t i = 0; i < indexCount; ++i)
+  {
+    if (!referenced[indices[i]]) ++unique;
+
+    referenced[indices[i]] = true;
+
+    // a vertex can straddle two lines
+    const size_t first = indices[i] * vertexSize / s_FetchLineSize;
+    const size_t last = (indices[i] * vertexSize + vertexSize - 1) / s_FetchLineSize;
+
+    for (size_t line = first; line <= last; ++line)
+    {
+      if (time - timestamp[line] > s_FetchCacheLines)
+      {
+        timestamp[line] = time++;
+        statistics.BytesFetched += s_FetchLineSize;
+      }
+    }
+  }
+
+  statistics.Overfetch = static_cast<float>(statistics.BytesFetched) / (unique * vertexSize);
+
+  return statistics;
+}
+
+static inline uint16_t QuantizeUnorm16(const float value, const float offset, const float inverseScale) noexcept
+{
+  const float normalized = std::min(std::max((value - offset) * inverseScale, 0.0f), 1.0f);
+
+  return static_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+}
+
+void MeshOptimizer::PackVertices(const Vertex* vertices, size_t count, const XMFLOAT3& offset, const XMFLOAT3& scale, PackedVertex* packed, VertexPackingStatistics& statistics) noexcept
+{
+  // a flat axis has no extent, every vertex sits at its offset
+  const XMFLOAT3 inverse = { scale.x > 0.0f ? 1.0f / scale.x : 0.0f, scale.y > 0.0f ? 1.0f / scale.y : 0.0f, scale.z > 0.0f ? 1.0f / scale.z : 0.0f };
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const Vertex& vertex = vertices[i];
+    PackedVertex& target = packed[i];
+
+    target.Position[0] = QuantizeUnorm16(vertex.Position.x, offset.x, inverse.x);
+    target.Position[1] = QuantizeUnorm16(vertex.Position.y, offset.y, inverse.y);
+    target.Position[2] = QuantizeUnorm16(vertex.Position.z, offset.z, inverse.z);
+    target.Position[3] = 65535;
+    target.TexCoord[0] = PackedVector::XMConvertFloatToHalf(vertex.TexCoord.x);
+    target.TexCoord[1] = PackedVector::XMConvertFloatToHalf(vertex.TexCoord.y);
+
+    // decode exactly like the input assembler and the vertex shader do
+    const Float3 position = Load(vertex);
+    const Float3 decoded =
+    {
+      offset.x + target.Position[0] / 65535.0f * scale.x,
+      offset.y + target.Position[1] / 65535.0f * scale.y,
+      offset.z + target.Position[2] / 65535.0f * scale.z,
+    };
+
+    const float positionError = Length(Subtract(decoded, position));
+    const float u = PackedVector::XMConvertHalfToFloat(target.TexCoord[0]) - vertex.TexCoord.x;
+    const float v = PackedVector::XMConvertHalfToFloat(target.TexCoord[1]) - vertex.TexCoord.y;
+    const float texCoordError = sqrtf(u * u + v * v);
+
+    statistics.PositionMaxError = std::max(statistics.PositionMaxError, positionError);
+    statistics.TexCoordMaxError = std::max(statistics.TexCoordMaxError, texCoordError);
+    statistics.PositionSquaredError += positionError * positionError;
+    statistics.TexCoordSquaredError += texCoordError * texCoordError;
+  }
+
+  statistics.Count += count;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+enum class VertexCacheType
+{
+  FIFO,
+  LRU,
+};
+
+struct VertexCacheStatistics
+{
+  UINT Transformed = 0; // vertex shader invocations
+  float ACMR = 0.0f;    // average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+  float ATVR = 0.0f;    // average transformed vertex ratio, transformed vertices per vertex (1.0 is optimal)
+};
+
+struct OverdrawStatistics
+{
+  UINT Covered = 0;        // pixels covered at least once, summed over all views
+  UINT Shaded = 0;         // pixels that passed the depth test, summed over all views
+  float Overdraw = 0.0f;   // shaded per covered pixel (1.0 is optimal)
+};
+
+struct VertexFetchStatistics
+{
+  UINT BytesFetched = 0;   // bytes read from memory in cache lines
+  float Overfetch = 0.0f;  // fetched per referenced vertex bytes (1.0 is optimal)
+};
+
+// accumulates over several calls of MeshOptimizer::PackVertices
+struct VertexPackingStatistics
+{
+  size_t Count = 0;
+  float PositionMaxError = 0.0f;     // object space units
+  float TexCoordMaxError = 0.0f;     // texture space units
+  double PositionSquaredError = 0.0;
+  double TexCoordSquaredError = 0.0;
+
+  inline float PositionRMSError(void) const noexcept { return Count ? static_cast<float>(sqrt(PositionSquaredError / Count)) : 0.0f; }
+  inline float TexCoordRMSError(void) const noexcept { return Count ? static_cast<float>(sqrt(TexCoordSquaredError / Count)) : 0.0f; }
+};
+
+// index and vertex buffer optimizations that run while a mesh is cooked
+class MeshOptimizer
+{
+public:
+  // reorders the triangles of a triangle list for the post transform vertex cache (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+  static void OptimizeVertexCache(DWORD* indices, size_t indexCount, size_t vertexCount);
+
+  // simulates a post transform vertex cache of cacheSize entries
+  static VertexCacheStatistics AnalyzeVertexCache(const DWORD* indices, size_t indexCount, size_t vertexCount, UINT cacheSize, VertexCacheType type = VertexCacheType::FIFO);
+
+  // reorders clusters of a cache optimized triangle list so outward facing parts are drawn first (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+  // threshold is the paper's heuristic, not a bound on the result: a run of triangles between hard boundaries is only split where the part before stays within
+  // threshold times the run's own ACMR, 1.05 usually costs a few percent more vertex shader invocations but the reordering of the clusters is not checked against it
+  static void OptimizeOverdraw(DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, float threshold);
+
+  // moves every vertex to the position of its first use in the index list and remaps the indices, unreferenced vertices are dropped
+  // returns the new vertex count
+  static size_t OptimizeVertexFetch(Vertex* vertices, DWORD* indices, size_t indexCount, size_t vertexCount);
+
+  // simulates a cache of 64 byte lines that every index reads its vertex through
+  static VertexFetchStatistics AnalyzeVertexFetch(const DWORD* indices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+
+  // quantizes positions to unorm16 inside offset + [0, scale] and texture coordinates to half, the color is dropped
+  static void PackVertices(const Vertex* vertices, size_t count, const XMFLOAT3& offset, const XMFLOAT3& scale, PackedVertex* packed, VertexPackingStatistics& statistics) noexcept;
+
+  // rasterizes the mesh with depth test and back face culling from a fixed set of directions around it
+  static OverdrawStatistics AnalyzeOverdraw(const DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount);
+
+private:
+  MeshOptimizer(void) noexcept = delete;
+  ~MeshOptimizer(void) noexcept = delete;
+
+};
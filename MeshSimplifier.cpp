@@ -0,0 +1,549 @@
+#include "MeshSimplifier.h"
+
+static constexpr DWORD s_None = std::numeric_limits<DWORD>::max();
+
+// open edges are weighted higher so borders keep their shape, seams may move a little more freely
+static constexpr float s_BorderWeight = 10.0f;
+static constexpr float s_SeamWeight = 1.0f;
+
+enum VertexKind : BYTE
+{
+  Manifold,  // interior vertex, may collapse onto any neighbour
+  Border,    // on exactly one open edge loop, may collapse along it
+  Seam,      // on exactly one UV seam (two vertices at the same position), both collapse along it
+  Locked,    // everything else
+  KindCount,
+};
+
+// can a vertex of the first kind collapse onto a vertex of the second kind
+static const bool s_CanCollapse[KindCount][KindCount] =
+{
+  { true, true, true, true },
+  { false, true, false, false },
+  { false, false, true, false },
+  { false, false, false, false },
+};
+
+// does an edge between the two kinds show up in both directions, i.e. in two triangles
+static const bool s_HasOpposite[KindCount][KindCount] =
+{
+  { true, true, true, true },
+  { true, false, true, false },
+  { true, true, true, true },
+  { true, false, true, false },
+};
+
+struct Vector3
+{
+  float x, y, z;
+};
+
+static inline Vector3 operator-(const Vector3& a, const Vector3& b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static inline Vector3 operator*(const Vector3& a, const float s) noexcept { return { a.x * s, a.y * s, a.z * s }; }
+static inline float Dot(const Vector3& a, const Vector3& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static inline Vector3 Cross(const Vector3& a, const Vector3& b) noexcept { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+// normalizes in place and returns the previous length
+static inline float Normalize(Vector3& v) noexcept
+{
+  const float length = sqrtf(Dot(v, v));
+
+  if (length > 0.0f) v = v * (1.0f / length);
+
+  return length;
+}
+
+// symmetric 3x3 matrix A, vector b and scalar c of the squared distance to a set of weighted planes, w is the total weight
+struct Quadric
+{
+  float a00, a11, a22;
+  float a10, a20, a21;
+  float b0, b1, b2;
+  float c;
+  float w;
+
+  void Add(const Quadric& other) noexcept
+  {
+    a00 += other.a00; a11 += other.a11; a22 += other.a22;
+    a10 += other.a10; a20 += other.a20; a21 += other.a21;
+    b0 += other.b0; b1 += other.b1; b2 += other.b2;
+    c += other.c;
+    w += other.w;
+  }
+
+  // average squared distance of v to the planes
+  float Error(const Vector3& v) const noexcept
+  {
+    const float rx = a00 * v.x + 2.0f * (b0 + a10 * v.y);
+    const float ry = a11 * v.y + 2.0f * (b1 + a21 * v.z);
+    const float rz = a22 * v.z + 2.0f * (b2 + a20 * v.x);
+
+    const float r = c + rx * v.x + ry * v.y + rz * v.z;
+
+    return w > 0.0f ? fabsf(r) / w : 0.0f;
+  }
+
+  static Quadric FromPlane(const Vector3& n, const float d, const float weight) noexcept
+  {
+    Quadric q;
+
+    q.a00 = n.x * n.x * weight; q.a11 = n.y * n.y * weight; q.a22 = n.z * n.z * weight;
+    q.a10 = n.y * n.x * weight; q.a20 = n.z * n.x * weight; q.a21 = n.z * n.y * weight;
+    q.b0 = n.x * d * weight; q.b1 = n.y * d * weight; q.b2 = n.z * d * weight;
+    q.c = d * d * weight;
+    q.w = weight;
+
+    return q;
+  }
+};
+
+// for every vertex the other two corners of each triangle it is part of, in winding order
+struct EdgeAdjacency
+{
+  struct Edge
+  {
+    DWORD next;
+    DWORD prev;
+  };
+
+  std::vector<UINT> offsets;
+  std::vector<Edge> edges;
+
+  // remap merges vertices at the same position when given
+  void Build(const DWORD* indices, size_t indexCount, size_t vertexCount, const DWORD* remap)
+  {
+    offsets.assign(vertexCount + 1, 0);
+    edges.resize(indexCount);
+
+    for (size_t i = 0; i < indexCount; ++i) ++offsets[(remap ? remap[indices[i]] : indices[i]) + 1];
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+
+    std::vector<UINT> fill(offsets.begin(), offsets.end() - 1);
+
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+      DWORD corners[3] = { indices[i], indices[i + 1], indices[i + 2] };
+
+      if (remap) for (auto& corner : corners) corner = remap[corner];
+
+      for (int k = 0; k < 3; ++k) edges[fill[corners[k]]++] = { corners[(k + 1) % 3], corners[(k + 2) % 3] };
+    }
+  }
+
+  bool HasEdge(const DWORD a, const DWORD b) const noexcept
+  {
+    for (UINT e = offsets[a]; e < offsets[a + 1]; ++e)
+    {
+      if (edges[e].next == b) return true;
+    }
+
+    return false;
+  }
+};
+
+struct Collapse
+{
+  DWORD from;
+  DWORD to;
+  bool bidirectional;
+  float error;
+};
+
+struct PositionHash
+{
+  size_t operator()(const std::array<uint32_t, 3>& key) const noexcept { return (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u); }
+};
+
+// remap points every vertex to the first vertex at the same position, wedge links all vertices at one position to a ring
+static void BuildPositionRemap(const Vertex* vertices, size_t vertexCount, std::vector<DWORD>& remap, std::vector<DWORD>& wedge)
+{
+  std::unordered_map<std::array<uint32_t, 3>, DWORD, PositionHash> first;
+
+  first.reserve(vertexCount);
+  remap.resize(vertexCount);
+  wedge.resize(vertexCount);
+
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    std::array<uint32_t, 3> key;
+
+    memcpy(key.data(), &vertices[v].Position, sizeof(key));
+
+    const auto entry = first.insert({ key, static_cast<DWORD>(v) });
+    const DWORD r = entry.first->second;
+
+    remap[v] = r;
+    wedge[v] = static_cast<DWORD>(v);
+
+    if (r != v)
+    {
+      wedge[v] = wedge[r];
+      wedge[r] = static_cast<DWORD>(v);
+    }
+  }
+}
+
+// loop and loopback point along the open edge leaving and entering a vertex, s_None if there is none
+static void ClassifyVertices(const EdgeAdjacency& adjacency, size_t vertexCount, const std::vector<DWORD>& remap, const std::vector<DWORD>& wedge,
+  std::vector<BYTE>& kind, std::vector<DWORD>& loop, std::vector<DWORD>& loopback)
+{
+  kind.assign(vertexCount, Locked);
+  loop.assign(vertexCount, s_None);
+  loopback.assign(vertexCount, s_None);
+
+  // a vertex with more than one open edge in one direction points to itself
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    const DWORD vertex = static_cast<DWORD>(v);
+
+    for (UINT e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+    {
+      const DWORD target = adjacency.edges[e].next;
+
+      if (target == vertex || adjacency.HasEdge(target, vertex)) continue;
+
+      loopback[target] = loopback[target] == s_None ? vertex : target;
+      loop[vertex] = loop[vertex] == s_None ? target : vertex;
+    }
+  }
+
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    if (remap[v] != v)
+    {
+      kind[v] = kind[remap[v]];
+
+      continue;
+    }
+
+    if (wedge[v] == v)
+    {
+      // no seam, all open edges belong to a border
+      if (loop[v] == s_None && loopback[v] == s_None) kind[v] = Manifold;
+      else if (loop[v] != v && loopback[v] != v && loop[v] != s_None && loopback[v] != s_None) kind[v] = Border;
+    }
+    else if (wedge[wedge[v]] == v)
+    {
+      // two vertices at one position, each needs exactly one open edge in and out and those have to meet at the same positions
+      const DWORD w = wedge[v];
+
+      const bool open =
+        loop[v] != s_None && loop[v] != v && loopback[v] != s_None && loopback[v] != v &&
+        loop[w] != s_None && loop[w] != w && loopback[w] != s_None && loopback[w] != w;
+
+      if (open && remap[loopback[v]] == remap[loop[w]] && remap[loop[v]] == remap[loopback[w]]) kind[v] = Seam;
+    }
+  }
+}
+
+static void AddTriangleQuadrics(const DWORD* indices, size_t indexCount, const std::vector<Vector3>& positions, const std::vector<DWORD>& remap, std::vector<Quadric>& quadrics)
+{
+  for (size_t i = 0; i < indexCount; i += 3)
+  {
+    const Vector3& p0 = positions[indices[i]];
+    const Vector3& p1 = positions[indices[i + 1]];
+    const Vector3& p2 = positions[indices[i + 2]];
+
+    Vector3 normal = Cross(p1 - p0, p2 - p0);
+    const float area = Normalize(normal);
+
+    const Quadric q = Quadric::FromPlane(normal, -Dot(normal, p0), sqrtf(area));
+
+    for (int k = 0; k < 3; ++k) quadrics[remap[indices[i + k]]].Add(q);
+  }
+}
+
+// a plane through every open edge, perpendicular to its triangle, keeps borders and seams from drifting sideways
+static void AddEdgeQuadrics(const DWORD* indices, size_t indexCount, const std::vector<Vector3>& positions, const std::vector<DWORD>& remap,
+  const std::vector<BYTE>& kind, const std::vector<DWORD>& loop, const std::vector<DWORD>& loopback, std::vector<Quadric>& quadrics)
+{
+  for (size_t i = 0; i < indexCount; i += 3)
+  {
+    for (int e = 0; e < 3; ++e)
+    {
+      const DWORD i0 = indices[i + e];
+      const DWORD i1 = indices[i + (e + 1) % 3];
+      const DWORD i2 = indices[i + (e + 2) % 3];
+
+      const BYTE k0 = kind[i0];
+      const BYTE k1 = kind[i1];
+
+      const bool open0 = k0 == Border || k0 == Seam;
+      const bool open1 = k1 == Border || k1 == Seam;
+
+      // also for edges from a border to a locked corner, or the corner would not resist the neighbouring collapses
+      if (!open0 && !open1) continue;
+      if (open0 && loop[i0] != i1) continue;
+      if (open1 && loopback[i1] != i0) continue;
+
+      // seam edges exist on both sides of the seam
+      if (s_HasOpposite[k0][k1] && remap[i1] > remap[i0]) continue;
+
+      const Vector3& p0 = positions[i0];
+
+      Vector3 edge = positions[i1] - p0;
+      const float length = Normalize(edge);
+
+      // the altitude from the third corner onto the edge is the plane normal
+      const Vector3 p20 = positions[i2] - p0;
+      Vector3 normal = p20 - edge * Dot(p20, edge);
+
+      Normalize(normal);
+
+      const float weight = (k0 == Border || k1 == Border) ? s_BorderWeight : s_SeamWeight;
+      const Quadric q = Quadric::FromPlane(normal, -Dot(normal, p0), length * weight);
+
+      quadrics[remap[i0]].Add(q);
+      quadrics[remap[i1]].Add(q);
+    }
+  }
+}
+
+static void PickCollapses(const std::vector<DWORD>& indices, const std::vector<DWORD>& remap, const std::vector<BYTE>& kind, const std::vector<DWORD>& loop, std::vector<Collapse>& collapses)
+{
+  collapses.clear();
+
+  for (size_t i = 0; i < indices.size(); i += 3)
+  {
+    for (int e = 0; e < 3; ++e)
+    {
+      const DWORD i0 = indices[i + e];
+      const DWORD i1 = indices[i + (e + 1) % 3];
+
+      // zero length edges are left alone
+      if (remap[i0] == remap[i1]) continue;
+
+      const BYTE k0 = kind[i0];
+      const BYTE k1 = kind[i1];
+
+      if (!s_CanCollapse[k0][k1] && !s_CanCollapse[k1][k0]) continue;
+
+      // interior and seam edges are seen twice, once from each triangle
+      if (s_HasOpposite[k0][k1] && remap[i1] > remap[i0]) continue;
+
+      // two border or seam vertices without an open edge between them sit on different loops
+      if (k0 == k1 && (k0 == Border || k0 == Seam) && loop[i0] != i1) continue;
+
+      if (s_CanCollapse[k0][k1] && s_CanCollapse[k1][k0]) collapses.push_back({ i0, i1, true, 0.0f });
+      else if (s_CanCollapse[k0][k1]) collapses.push_back({ i0, i1, false, 0.0f });
+      else collapses.push_back({ i1, i0, false, 0.0f });
+    }
+  }
+}
+
+static void RankCollapses(std::vector<Collapse>& collapses, const std::vector<Vector3>& positions, const std::vector<DWORD>& remap, const std::vector<Quadric>& quadrics)
+{
+  for (auto& collapse : collapses)
+  {
+    const float forward = quadrics[remap[collapse.from]].Error(positions[collapse.to]);
+
+    if (!collapse.bidirectional)
+    {
+      collapse.error = forward;
+
+      continue;
+    }
+
+    const float backward = quadrics[remap[collapse.to]].Error(positions[collapse.from]);
+
+    if (backward < forward) std::swap(collapse.from, collapse.to);
+
+    collapse.error = std::min(forward, backward);
+  }
+}
+
+// moving from onto to must not turn any of the remaining triangles around from
+// the adjacency and both vertices are in welded positions
+static bool FlipsTriangles(const EdgeAdjacency& adjacency, const std::vector<Vector3>& positions, const std::vector<DWORD>& remap, const std::vector<DWORD>& collapseRemap, const DWORD from, const DWORD to)
+{
+  const Vector3& p0 = positions[from];
+  const Vector3& p1 = positions[to];
+
+  for (UINT e = adjacency.offsets[from]; e < adjacency.offsets[from + 1]; ++e)
+  {
+    const DWORD a = remap[collapseRemap[adjacency.edges[e].next]];
+    const DWORD b = remap[collapseRemap[adjacency.edges[e].prev]];
+
+    // triangles that vanish with this collapse or already vanished with an earlier one
+    if (a == to || b == to || a == b) continue;
+
+    const Vector3 edge = positions[b] - positions[a];
+
+    if (Dot(Cross(edge, p0 - positions[a]), Cross(edge, p1 - positions[a])) <= 0.0f) return true;
+  }
+
+  return false;
+}
+
+static void RemapLoops(std::vector<DWORD>& loop, const std::vector<DWORD>& collapseRemap)
+{
+  for (size_t v = 0; v < loop.size(); ++v)
+  {
+    if (loop[v] == s_None) continue;
+
+    const DWORD next = loop[v];
+    const DWORD target = collapseRemap[next];
+
+    // the loop continues past a vertex that collapsed onto this one
+    loop[v] = (target == v) ? loop[next] : target;
+  }
+}
+
+float MeshSimplifier::Simplify(const DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, size_t targetIndexCount, float targetError, std::vector<DWORD>& output)
+{
+  output.assign(indices, indices + indexCount - indexCount % 3);
+
+  if (vertexCount == 0 || output.size() <= targetIndexCount) return 0.0f;
+
+  // errors are computed inside the unit cube and scaled back at the end
+  Vector3 minimum = { vertices[0].Position.x, vertices[0].Position.y, vertices[0].Position.z };
+  Vector3 maximum = minimum;
+
+  for (size_t v = 1; v < vertexCount; ++v)
+  {
+    const auto& p = vertices[v].Position;
+
+    minimum = { std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z) };
+    maximum = { std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z) };
+  }
+
+  const float extent = std::max({ maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z });
+  const float scale = extent > 0.0f ? 1.0f / extent : 0.0f;
+
+  std::vector<Vector3> positions(vertexCount);
+
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    const auto& p = vertices[v].Position;
+
+    positions[v] = Vector3{ p.x - minimum.x, p.y - minimum.y, p.z - minimum.z } * scale;
+  }
+
+  std::vector<DWORD> remap;
+  std::vector<DWORD> wedge;
+
+  BuildPositionRemap(vertices, vertexCount, remap, wedge);
+
+  EdgeAdjacency adjacency;
+
+  adjacency.Build(output.data(), output.size(), vertexCount, nullptr);
+
+  std::vector<BYTE> kind;
+  std::vector<DWORD> loop;
+  std::vector<DWORD> loopback;
+
+  ClassifyVertices(adjacency, vertexCount, remap, wedge, kind, loop, loopback);
+
+  std::vector<Quadric> quadrics(vertexCount, Quadric{});
+
+  AddTriangleQuadrics(output.data(), output.size(), positions, remap, quadrics);
+  AddEdgeQuadrics(output.data(), output.size(), positions, remap, kind, loop, loopback, quadrics);
+
+  const float errorLimit = targetError * scale * targetError * scale;
+  float resultError = 0.0f;
+
+  std::vector<Collapse> collapses;
+  std::vector<UINT> order;
+  std::vector<DWORD> collapseRemap(vertexCount);
+  std::vector<bool> touched(vertexCount);
+
+  // every pass collapses a set of edges that share no vertex, cheapest first
+  while (output.size() > targetIndexCount)
+  {
+    // positions are welded here, so the flip test sees the triangles on both sides of a seam
+    adjacency.Build(output.data(), output.size(), vertexCount, remap.data());
+
+    PickCollapses(output, remap, kind, loop, collapses);
+
+    if (collapses.empty()) break;
+
+    RankCollapses(collapses, positions, remap, quadrics);
+
+    order.resize(collapses.size());
+
+    for (size_t c = 0; c < collapses.size(); ++c) order[c] = static_cast<UINT>(c);
+
+    std::sort(order.begin(), order.end(), [&](UINT a, UINT b) { return collapses[a].error < collapses[b].error; });
+
+    for (size_t v = 0; v < vertexCount; ++v) collapseRemap[v] = static_cast<DWORD>(v);
+
+    std::fill(touched.begin(), touched.end(), false);
+
+    // most collapses remove two triangles and lock a handful of neighbouring collapses for this pass,
+    // so the error allowed in one pass is a bit above that of the collapse that would reach the goal on its own
+    const size_t triangleGoal = (output.size() - targetIndexCount) / 3;
+    size_t edgeGoal = triangleGoal / 2;
+    size_t triangleCollapses = 0;
+    size_t edgeCollapses = 0;
+
+    for (const UINT c : order)
+    {
+      const Collapse& collapse = collapses[c];
+
+      if (collapse.error > errorLimit || triangleCollapses >= triangleGoal) break;
+
+      const float errorGoal = edgeGoal < order.size() ? 1.5f * collapses[order[edgeGoal]].error : std::numeric_limits<float>::max();
+
+      if (collapse.error > errorGoal && triangleCollapses > triangleGoal / 6) break;
+
+      const DWORD from = collapse.from;
+      const DWORD to = collapse.to;
+      const DWORD r0 = remap[from];
+      const DWORD r1 = remap[to];
+
+      if (touched[r0] || touched[r1]) continue;
+
+      // the other side of a seam follows along its own half of the seam
+      const DWORD s0 = wedge[from];
+      const DWORD s1 = kind[from] == Seam ? (loop[from] == to ? loopback[s0] : loop[s0]) : s_None;
+
+      if (kind[from] == Seam && (s1 == s_None || remap[s1] != r1)) continue;
+
+      if (FlipsTriangles(adjacency, positions, remap, collapseRemap, r0, r1))
+      {
+        ++edgeGoal;
+
+        continue;
+      }
+
+      quadrics[r1].Add(quadrics[r0]);
+
+      collapseRemap[from] = to;
+
+      if (kind[from] == Seam) collapseRemap[s0] = s1;
+
+      touched[r0] = true;
+      touched[r1] = true;
+
+      triangleCollapses += kind[from] == Border ? 1 : 2;
+      ++edgeCollapses;
+
+      resultError = std::max(resultError, collapse.error);
+    }
+
+    if (edgeCollapses == 0) break;
+
+    RemapLoops(loop, collapseRemap);
+    RemapLoops(loopback, collapseRemap);
+
+    // remap and drop the triangles that became degenerate
+    size_t count = 0;
+
+    for (size_t i = 0; i < output.size(); i += 3)
+    {
+      const DWORD a = collapseRemap[output[i]];
+      const DWORD b = collapseRemap[output[i + 1]];
+      const DWORD d = collapseRemap[output[i + 2]];
+
+      if (a == b || b == d || d == a) continue;
+
+      output[count++] = a;
+      output[count++] = b;
+      output[count++] = d;
+    }
+
+    output.resize(count);
+  }
+
+  return extent * sqrtf(resultError);
+}
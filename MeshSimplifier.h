@@ -0,0 +1,17 @@
+#pragma once
+
+// edge collapse simplification with quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics")
+class MeshSimplifier
+{
+public:
+  // removes triangles until at most targetIndexCount indices are left or the next collapse would move the surface further than targetError
+  // vertices are only merged onto other vertices, the result indexes the same vertex buffer
+  // borders and UV seams only collapse along themselves, vertices where they meet or branch never move
+  // returns the largest deviation from the input surface in object space units
+  static float Simplify(const DWORD* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, size_t targetIndexCount, float targetError, std::vector<DWORD>& output);
+
+private:
+  MeshSimplifier(void) noexcept = delete;
+  ~MeshSimplifier(void) noexcept = delete;
+
+};
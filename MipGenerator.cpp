@@ -0,0 +1,231 @@
+#include "MipGenerator.h"
+
+#include <thread>
+#include <emmintrin.h>
+
+// levels with fewer rows per core are filtered on the calling thread alone
+static constexpr UINT s_MinRowsPerThread = 32;
+// linear values are encoded to 8 bit sRGB through a table with this many steps between 0 and 1
+static constexpr int s_EncodeSteps = 1 << 14;
+
+static inline float ToLinear(const float srgb) noexcept { return (srgb <= 0.04045f) ? srgb / 12.92f : powf((srgb + 0.055f) / 1.055f, 2.4f); }
+static inline float ToSrgb(const float linear) noexcept { return (linear <= 0.0031308f) ? linear * 12.92f : 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f; }
+
+// 8 bit sRGB to linear and back, filled once by the first import that needs them
+struct SrgbTables
+{
+  float Decode[256];
+  BYTE Encode[s_EncodeSteps + 1];
+
+  SrgbTables(void) noexcept
+  {
+    for (int i = 0; i < 256; ++i) Decode[i] = ToLinear(i / 255.0f);
+    for (int i = 0; i <= s_EncodeSteps; ++i) Encode[i] = static_cast<BYTE>(ToSrgb(static_cast<float>(i) / s_EncodeSteps) * 255.0f + 0.5f);
+  }
+};
+
+static const SrgbTables& Tables8(void) noexcept
+{
+  static const SrgbTables tables;
+
+  return tables;
+}
+
+// 16 bit sRGB to linear, encoding 16 bit goes through ToSrgb since a table would not fit into the cache
+static const std::vector<float>& Decode16(void)
+{
+  static const std::vector<float> table = [](void)
+  {
+    std::vector<float> linear(65536);
+
+    for (size_t i = 0; i < linear.size(); ++i) linear[i] = ToLinear(i / 65535.0f);
+
+    return linear;
+  }();
+
+  return table;
+}
+
+// runs filter(first, last) over [0, rows) in one range of rows per thread, up to maxThreads of them or one per core
+template <typename Filter>
+static void ForEachRowRange(const UINT rows, const UINT maxThreads, const Filter& filter)
+{
+  const UINT threads = std::max(1u, std::min(maxThreads ? maxThreads : std::thread::hardware_concurrency(), rows / s_MinRowsPerThread));
+
+  std::vector<std::thread> workers;
+
+  for (UINT t = 1; t < threads; ++t) workers.emplace_back([&filter, rows, threads, t](void) { filter(rows * t / threads, rows * (t + 1) / threads); });
+
+  filter(0, rows / threads);
+
+  for (auto& worker : workers) worker.join();
+}
+
+// a whole pixel of level 0 as linear RGBA
+static inline __m128 Load8(const BYTE* p, const float* decode) noexcept { return _mm_setr_ps(decode[p[0]], decode[p[1]], decode[p[2]], p[3] * (1.0f / 255.0f)); }
+
+static inline __m128 Load16(const BYTE* p, const float* decode) noexcept
+{
+  uint16_t samples[4];
+
+  memcpy(samples, p, sizeof(samples));
+
+  return _mm_setr_ps(decode[samples[0]], decode[samples[1]], decode[samples[2]], samples[3] * (1.0f / 65535.0f));
+}
+
+// filters rows [first, last) of level 1 from the encoded level 0, every pixel is loaded through a table
+template <size_t PixelSize>
+static void FilterEncoded(const BYTE* source, const UINT sourceWidth, const UINT sourceHeight, float* target, const UINT width, const UINT first, const UINT last) noexcept
+{
+  const float* decode = (PixelSize == 8) ? Decode16().data() : Tables8().Decode;
+  const size_t pitch = static_cast<size_t>(sourceWidth) * PixelSize;
+  // a level 1 pixel wide or high has its single column or row counted twice
+  const size_t right = (sourceWidth > 1) ? PixelSize : 0;
+  const size_t below = (sourceHeight > 1) ? pitch : 0;
+  const __m128 quarter = _mm_set1_ps(0.25f);
+
+  for (UINT y = first; y < last; ++y)
+  {
+    const BYTE* row = source + 2 * y * pitch;
+    float* out = target + static_cast<size_t>(y) * width * 4;
+
+    for (UINT x = 0; x < width; ++x, row += 2 * PixelSize, out += 4)
+    {
+      const auto load = (PixelSize == 8) ? Load16 : Load8;
+      const __m128 top = _mm_add_ps(load(row, decode), load(row + right, decode));
+      const __m128 bottom = _mm_add_ps(load(row + below, decode), load(row + below + right, decode));
+
+      _mm_storeu_ps(out, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+    }
+  }
+}
+
+// filters rows [first, last) of a level from the linear pixels of the level above
+static void FilterLinear(const float* source, const UINT sourceWidth, const UINT sourceHeight, float* target, const UINT width, const UINT first, const UINT last) noexcept
+{
+  const size_t pitch = static_cast<size_t>(sourceWidth) * 4;
+  const size_t right = (sourceWidth > 1) ? 4 : 0;
+  const size_t below = (sourceHeight > 1) ? pitch : 0;
+  const __m128 quarter = _mm_set1_ps(0.25f);
+
+  for (UINT y = first; y < last; ++y)
+  {
+    const float* row = source + 2 * y * pitch;
+    float* out = target + static_cast<size_t>(y) * width * 4;
+
+    for (UINT x = 0; x < width; ++x, row += 8, out += 4)
+    {
+      const __m128 top = _mm_add_ps(_mm_loadu_ps(row), _mm_loadu_ps(row + right));
+      const __m128 bottom = _mm_add_ps(_mm_loadu_ps(row + below), _mm_loadu_ps(row + below + right));
+
+      _mm_storeu_ps(out, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+    }
+  }
+}
+
+static void Encode8(const float* source, BYTE* target, const size_t count) noexcept
+{
+  const BYTE* encode = Tables8().Encode;
+  const __m128 scale = _mm_setr_ps(s_EncodeSteps, s_EncodeSteps, s_EncodeSteps, 255.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  for (size_t i = 0; i < count; ++i, source += 4, target += 4)
+  {
+    // rounded to the nearest table entry, alpha to the nearest value
+    const __m128i steps = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source), zero), one), scale));
+    alignas(16) int32_t index[4];
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(index), steps);
+
+    target[0] = encode[index[0]];
+    target[1] = encode[index[1]];
+    target[2] = encode[index[2]];
+    target[3] = static_cast<BYTE>(index[3]);
+  }
+}
+
+static void Encode16(const float* source, BYTE* target, const size_t count) noexcept
+{
+  for (size_t i = 0; i < count; ++i, source += 4, target += 8)
+  {
+    uint16_t samples[4];
+
+    for (int c = 0; c < 4; ++c)
+    {
+      const float value = std::min(std::max(source[c], 0.0f), 1.0f);
+
+      samples[c] = static_cast<uint16_t>(((c == 3) ? value : ToSrgb(value)) * 65535.0f + 0.5f);
+    }
+
+    memcpy(target, samples, sizeof(samples));
+  }
+}
+
+UINT MipGenerator::LevelCount(UINT width, UINT height, DXGI_FORMAT format) noexcept
+{
+  switch (format)
+  {
+  case DXGI_FORMAT_R8G8B8A8_UNORM:
+  case DXGI_FORMAT_B8G8R8A8_UNORM:
+  case DXGI_FORMAT_B8G8R8X8_UNORM:
+  case DXGI_FORMAT_R16G16B16A16_UNORM:
+    break;
+
+  default:
+    return 1;
+  }
+
+  UINT levels = 1;
+
+  for (UINT size = std::max(width, height); size > 1; size >>= 1) ++levels;
+
+  return levels;
+}
+
+void MipGenerator::Generate(std::vector<BYTE>& pixels, UINT width, UINT height, DXGI_FORMAT format, UINT threads)
+{
+  const UINT levels = LevelCount(width, height, format);
+  const size_t pixelSize = (format == DXGI_FORMAT_R16G16B16A16_UNORM) ? 8 : 4;
+
+  if (levels == 1) return;
+
+  size_t size = 0;
+
+  for (UINT level = 0; level < levels; ++level) size += static_cast<size_t>(LevelSize(width, level)) * LevelSize(height, level) * pixelSize;
+
+  pixels.resize(size);
+
+  // linear pixels of the level above and the one that is filtered from it
+  std::vector<float> above;
+  std::vector<float> linear;
+  size_t offset = static_cast<size_t>(width) * height * pixelSize;
+
+  for (UINT level = 1; level < levels; ++level)
+  {
+    const UINT sourceWidth = LevelSize(width, level - 1);
+    const UINT sourceHeight = LevelSize(height, level - 1);
+    const UINT levelWidth = LevelSize(width, level);
+    const UINT levelHeight = LevelSize(height, level);
+
+    linear.resize(static_cast<size_t>(levelWidth) * levelHeight * 4);
+
+    BYTE* const target = pixels.data() + offset;
+
+    ForEachRowRange(levelHeight, threads, [&](const UINT first, const UINT last)
+    {
+      if (level > 1) FilterLinear(above.data(), sourceWidth, sourceHeight, linear.data(), levelWidth, first, last);
+      else if (pixelSize == 8) FilterEncoded<8>(pixels.data(), sourceWidth, sourceHeight, linear.data(), levelWidth, first, last);
+      else FilterEncoded<4>(pixels.data(), sourceWidth, sourceHeight, linear.data(), levelWidth, first, last);
+
+      const size_t begin = static_cast<size_t>(first) * levelWidth;
+      const size_t count = static_cast<size_t>(last - first) * levelWidth;
+
+      if (pixelSize == 8) Encode16(linear.data() + begin * 4, target + begin * 8, count);
+      else Encode8(linear.data() + begin * 4, target + begin * 4, count);
+    });
+
+    offset += static_cast<size_t>(levelWidth) * levelHeight * pixelSize;
+    above.swap(linear);
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// builds the mip chain of a texture on the CPU while it is imported, every level is a 2x2 box filter of the one above
+// color is averaged in linear space and encoded as sRGB again, alpha is averaged as it is
+// the previous level is kept as linear floats so the filter runs on whole pixels with SSE2, the rows of a level are split across threads
+// an odd last column or row of a level is dropped, as a GPU box filter would do it
+class MipGenerator
+{
+public:
+  // levels down to 1x1 for the formats Generate filters, 1 for every other one
+  static UINT LevelCount(UINT width, UINT height, DXGI_FORMAT format) noexcept;
+
+  static inline UINT LevelSize(UINT size, UINT level) noexcept { return std::max(1u, size >> level); }
+
+  // pixels holds level 0 without padding, the following levels are appended to it in the same layout
+  // the rows of a level are split across up to threads threads, 0 uses one per core
+  static void Generate(std::vector<BYTE>& pixels, UINT width, UINT height, DXGI_FORMAT format, UINT threads = 0);
+
+private:
+  MipGenerator(void) noexcept = delete;
+  ~MipGenerator(void) noexcept = delete;
+
+};
@@ -6,28 +6,24 @@ Model::Model(const std::string& object, const std::string& texture, XMFLOAT3 pos
   m_position(position),
   m_rotation(rotation),
   m_mesh(nullptr),
+  m_texture(TextureCache::Acquire(std::wstring(texture.begin(), texture.end()))),
   m_Solid(solid)
 {
-  Mesh::GetMesh(object, texture, m_mesh);
+  Mesh::GetMesh(object, m_mesh);
 }
 
 void Model::LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList)
 {
   m_mesh->LoadResources(device, commandList);
 
-  std::vector<Vertex> vertices;
-
-  vertices.resize(m_mesh->VertexCount());
-  memcpy(vertices.data(), m_mesh->Vertices(), sizeof(Vertex) * m_mesh->VertexCount());
-
-  m_BoundingVolume = BoundingVolume(vertices);
+  // the local bounds belong to the mesh, models never move so they are transformed once
+  m_BoundingVolume = BoundingVolume(m_mesh->Bounds());
   m_BoundingVolume.Update(&m_position, &m_rotation);
 }
 
 void Model::Update(int frameIndex)
 {
   m_mesh->Update(frameIndex);
-  m_BoundingVolume.Update(&m_position, &m_rotation);
 
   static const auto scale = XMVECTOR{ 1.0f, 1.0f, 1.0f, 1.0f };  // this static local variables reduce
   static const auto origin = XMVECTOR{ 0.0f, 0.0f, 0.0f, 1.0f }; // each stackframe by 16 bytes
@@ -41,17 +37,82 @@ void Model::Update(int frameIndex)
   const XMMATRIX v = XMLoadFloat4x4(&Camera::GetViewMatrix());
   const XMMATRIX p = XMLoadFloat4x4(&Camera::GetProjectionMatrix());
 
-  XMStoreFloat4x4(&m_constantBuffer.wvpMat, m * v * p);
+  const XMMATRIX d = XMLoadFloat4x4(&m_mesh->Dequantization());
+
+  XMStoreFloat4x4(&m_constantBuffer.wvpMat, d * m * v * p);
 }
 
-void Model::PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, UINT8* cbAddress, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress)
+void Model::PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, UINT8* cbAddress, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress, UINT lod, UINT& textureArray)
 {
 	commandList->SetGraphicsRoot32BitConstants(0, sizeof(ConstantBuffer) / sizeof(float), &m_constantBuffer, 0);
 
-  m_mesh->PopulateCommandList(commandList, cbvAddress);
+  m_mesh->PopulateCommandList(commandList, cbvAddress, lod, m_visibleClusters, m_texture, textureArray);
+}
+
+UINT Model::SelectLod(const float projectionScale) const noexcept
+{
+  const auto& sphere = m_BoundingVolume.m_SphereTransformed;
+  const auto distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&sphere.Center) - XMLoadFloat3(&Camera::m_Position))) - sphere.Radius;
+
+  // models are not scaled, so the object space error of a LOD is its world space error
+  // from inside the bounds some part of the mesh can be arbitrarily close
+  if (distance <= 0.0f) return 0;
+
+  const auto& lods = m_mesh->Lods();
+  UINT lod = 0;
+
+  while (lod + 1 < lods.size() && lods[lod + 1].Error * projectionScale < m_lodPixelError * distance) ++lod;
+
+  return lod;
+}
+
+UINT Model::CullClusters(void)
+{
+  const auto& clusters = m_mesh->Clusters();
+
+  m_visibleClusters.assign(clusters.size(), true);
+
+  if (clusters.empty()) return 0;
+
+  // the frustum and the camera move into object space once instead of every cluster into world space
+  static const auto scale = XMVECTOR{ 1.0f, 1.0f, 1.0f, 1.0f };
+  static const auto origin = XMVECTOR{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+  const auto world = XMMatrixAffineTransformation(scale, origin, XMLoadFloat4(&m_rotation), XMLoadFloat3(&m_position));
+  const auto inverse = XMMatrixInverse(nullptr, world);
+
+  BoundingOrientedBox frustum;
+  XMFLOAT3 position;
+
+  Camera::Frustum().m_OBBTransformed.Transform(frustum, inverse);
+  XMStoreFloat3(&position, XMVector3TransformCoord(XMLoadFloat3(&Camera::m_Position), inverse));
+
+  UINT rejected = 0;
+
+  for (size_t c = 0; c < clusters.size(); ++c)
+  {
+    const auto& cluster = clusters[c];
+
+    if (!MeshClusterizer::IsBackfacing(cluster, position) && frustum.Intersects(BoundingSphere(cluster.Center, cluster.Radius))) continue;
+
+    m_visibleClusters[c] = false;
+    rejected += cluster.IndexCount / 3;
+  }
+
+  return rejected;
+}
+
+UINT Model::TriangleCount(const UINT lod) const noexcept
+{
+  const auto& lods = m_mesh->Lods();
+
+  return lods.empty() ? 0 : lods[std::min<size_t>(lod, lods.size() - 1)].TriangleCount;
 }
 
 void Model::Release()
 {
   if (m_mesh) m_mesh->Release();
+
+  TextureCache::Release(m_texture);
+  m_texture = TextureCache::InvalidHandle;
 }
@@ -11,18 +11,32 @@ public:
 
   void LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList);
   void Update(int frameIndex);
-  void PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, UINT8* cbAddress, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress);
+  // textureArray is the texture array bound to the command list, as Mesh::PopulateCommandList keeps it
+  void PopulateCommandList(ComPtr<ID3D12GraphicsCommandList>& commandList, UINT8* cbAddress, D3D12_GPU_VIRTUAL_ADDRESS cbvAddress, UINT lod, UINT& textureArray);
+
+  // the coarsest LOD whose error projects to less than a pixel at the current camera distance
+  // projectionScale converts a size at distance 1 into pixels, half the viewport height times the vertical focal length
+  UINT SelectLod(const float projectionScale) const noexcept;
+  UINT TriangleCount(const UINT lod) const noexcept;
+
+  // tests the clusters of LOD 0 against the camera frustum and position, PopulateCommandList only draws the ones that pass
+  // returns the number of triangles rejected
+  UINT CullClusters(void);
   void Release();
 
   inline const bool isSolid(void) const noexcept { return m_Solid; }
 
 private:
   static constexpr int m_constantBufferAlignedSize = (sizeof(ConstantBuffer) + 255) & ~255;
+  static constexpr float m_lodPixelError = 1.0f;
 
   XMFLOAT3 m_position;
   XMFLOAT4 m_rotation;
   Mesh* m_mesh;
+  // the texture of the materials of the mesh that have none of their own
+  UINT m_texture;
   ConstantBuffer m_constantBuffer;
+  std::vector<bool> m_visibleClusters;
   const bool m_Solid;
 
 public:
@@ -1,28 +1,10 @@
 #include "ObjLoader.h"
 
-// TODO Neuerstellen des OBJLoaders
+#include "MappedFile.h"
+#include "ObjTokenizer.h"
 
-static vector<std::string> split(const std::string& str, const std::string& delim)
-{
-	vector<std::string> tokens;
-	size_t	prev = 0,
-					pos = 0;
-
-	do
-	{
-		pos = str.find(delim, prev);
-
-		if (pos == std::string::npos) pos = str.length();
-
-		std::string token = str.substr(prev, pos - prev);
-
-		if (!token.empty()) tokens.push_back(token);
-
-		prev = pos + delim.length();
-	} while (pos < str.length() && prev < str.length());
-
-	return tokens;
-}
+#include <climits>
+#include <thread>
 
 struct V2
 {
@@ -43,75 +25,851 @@ struct V3
 	V3(const float x, const float y, const float z) : x(x), y(y), z(z) {}
 };
 
-static std::vector<V3> positions;
-static std::vector<V2> texCoords;
-static std::vector<Vertex> vertices;
-static std::vector<DWORD> indices;
+static constexpr uint64_t s_EmptyKey = ~0ull;
+
+// open addressing hash table from a (position, texcoord) pair to the index of its welded vertex
+class WeldTable
+{
+public:
+	// empties the table but keeps its current size
+	void Reset(void)
+	{
+		if (m_Keys.empty()) m_Keys.resize(1024);
+
+		std::fill(m_Keys.begin(), m_Keys.end(), s_EmptyKey);
+		m_Values.resize(m_Keys.size());
+		m_Count = 0;
+	}
+
+	// returns the index stored for key, or stores and returns value if the key is new
+	DWORD Insert(const uint64_t key, const DWORD value)
+	{
+		if (2 * (m_Count + 1) > m_Keys.size()) Grow();
+
+		const size_t mask = m_Keys.size() - 1;
+
+		for (size_t slot = Hash(key) & mask;; slot = (slot + 1) & mask)
+		{
+			if (m_Keys[slot] == key) return m_Values[slot];
+
+			if (m_Keys[slot] == s_EmptyKey)
+			{
+				m_Keys[slot] = key;
+				m_Values[slot] = value;
+				++m_Count;
+
+				return value;
+			}
+		}
+	}
+
+private:
+	static inline size_t Hash(const uint64_t key) noexcept { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32); }
+
+	void Grow(void)
+	{
+		std::vector<uint64_t> keys(m_Keys.size() * 2, s_EmptyKey);
+		std::vector<DWORD> values(keys.size());
+		const size_t mask = keys.size() - 1;
+
+		for (size_t i = 0; i < m_Keys.size(); ++i)
+		{
+			if (m_Keys[i] == s_EmptyKey) continue;
+
+			size_t slot = Hash(m_Keys[i]) & mask;
+
+			while (keys[slot] != s_EmptyKey) slot = (slot + 1) & mask;
+
+			keys[slot] = m_Keys[i];
+			values[slot] = m_Values[i];
+		}
+
+		m_Keys.swap(keys);
+		m_Values.swap(values);
+	}
+
+	std::vector<uint64_t> m_Keys;
+	std::vector<DWORD> m_Values;
+	size_t m_Count = 0;
+};
+
+// exact powers of ten representable as double, used by the fast float path
+static constexpr double s_Pow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool IsBlank(const char c) noexcept { return c == ' ' || c == '\t' || c == '\r'; }
+static inline bool IsDigit(const char c) noexcept { return static_cast<unsigned char>(c - '0') < 10; }
+
+static inline const char* SkipBlanks(const char* p, const char* end) noexcept
+{
+	while (p < end && IsBlank(*p)) ++p;
+
+	return p;
+}
+
+// saturates below 10^9, larger indices are invalid anyway and no index can reach s_NoTexCoord
+static const char* ScanInt(const char* p, const char* end, int& out) noexcept
+{
+	const bool negative = p < end && *p == '-';
+
+	if (p < end && (*p == '-' || *p == '+')) ++p;
+
+	int value = 0;
+
+	for (; p < end && IsDigit(*p); ++p)
+	{
+		if (value < 100000000) value = value * 10 + (*p - '0');
+	}
+
+	out = negative ? -value : value;
+
+	return p;
+}
+
+// [+-]digits[.digits][(e|E)[+-]digits]
+// mantissas of up to 15 significant digits with a small exponent are exact in double precision and are
+// converted with a single multiplication or division, everything else is handed to strtof
+static const char* ScanFloat(const char* p, const char* end, float& out) noexcept
+{
+	const char* const start = p;
+	const bool negative = p < end && *p == '-';
+
+	if (p < end && (*p == '-' || *p == '+')) ++p;
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+
+	while (p < end && IsDigit(*p))
+	{
+		mantissa = mantissa * 10 + (*p++ - '0');
+		if (mantissa) ++digits;
+	}
+
+	if (p < end && *p == '.')
+	{
+		++p;
+
+		while (p < end && IsDigit(*p))
+		{
+			mantissa = mantissa * 10 + (*p++ - '0');
+			if (mantissa) ++digits;
+			--exponent;
+		}
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		int e = 0;
+
+		p = ScanInt(p + 1, end, e);
+		exponent += e;
+	}
+
+	if (digits <= 15 && exponent >= -22 && exponent <= 22)
+	{
+		const double value = (exponent < 0) ? mantissa / s_Pow10[-exponent] : mantissa * s_Pow10[exponent];
+
+		out = static_cast<float>(negative ? -value : value);
+
+		return p;
+	}
+
+	// the mapped file is not zero terminated, so strtof gets a terminated copy of the token
+	char buffer[64];
+	const size_t length = std::min(static_cast<size_t>(p - start), sizeof(buffer) - 1);
+
+	memcpy(buffer, start, length);
+	buffer[length] = '\0';
+
+	out = strtof(buffer, nullptr);
+
+	return p;
+}
+
+// the texCoord of a corner without one, every index that is written in the file resolves to something larger
+static constexpr int s_NoTexCoord = INT_MIN;
+
+// a face corner as written in the file, already converted to 0-based indices (texCoord s_NoTexCoord if there is none)
+struct Corner
+{
+	int position;
+	int texCoord;
+};
+
+// everything parsed from one newline aligned slice of the file
+struct Chunk
+{
+	const char* begin;
+	const char* end;
+
+	std::vector<V3> positions;
+	std::vector<V2> texCoords;
+	std::vector<Corner> corners;
+
+	// corners whose negative (relative) index was resolved against this chunk's own counts and still has to be
+	// rebased by the number of positions/texcoords in all chunks before it
+	std::vector<size_t> relativePositions;
+	std::vector<size_t> relativeTexCoords;
+
+	// usemtl lines with the number of corners before them, mtllib lines with their file names
+	std::vector<std::pair<size_t, std::string>> materials;
+	std::vector<std::string> libraries;
+
+	// face lines are skipped by a streaming import, they are read in a second pass
+	bool attributesOnly;
+	bool valid;
+};
+
+// files below this size per thread are not worth the thread start up
+static constexpr size_t s_MinChunkSize = 1 << 20;
+
+// upper bounds of one batch handed to an ObjSink by a streaming import
+static constexpr size_t s_BatchVertices = 1 << 16;
+static constexpr size_t s_BatchIndices = 3 << 16;
+
+// per loader scratch memory, every vector keeps its capacity for the next import
+struct ObjScratch
+{
+	std::vector<V3> positions;
+	std::vector<V2> texCoords;
+	std::vector<Corner> corners;
+	std::vector<Chunk> chunks;
+	WeldTable weld;
+
+	// material of every face, as index into materials
+	std::vector<UINT> faceMaterials;
+	std::vector<std::string> materials;
+	std::vector<std::string> libraries;
+	std::vector<DWORD> groupedIndices;
+
+	std::vector<Vertex> batchVertices;
+	std::vector<DWORD> batchIndices;
+};
+
+static inline void AddCorner(Chunk& chunk, const int position, const int texCoord)
+{
+	const size_t corner = chunk.corners.size();
+
+	const bool relativeTexCoord = texCoord < 0 && texCoord != s_NoTexCoord;
+
+	if (position < 0) chunk.relativePositions.push_back(corner);
+	if (relativeTexCoord) chunk.relativeTexCoords.push_back(corner);
+
+	// negative indices count back from the current end, an index 0 becomes -1 and is rejected by Merge
+	chunk.corners.push_back({
+		(position < 0) ? static_cast<int>(chunk.positions.size()) + position : position - 1,
+		relativeTexCoord ? static_cast<int>(chunk.texCoords.size()) + texCoord : (texCoord == s_NoTexCoord) ? s_NoTexCoord : texCoord - 1
+	});
+}
+
+// corners are "v", "v/vt", "v//vn" or "v/vt/vn", the normal is not part of our vertex format
+static inline const char* ScanCorner(const char* p, const char* const end, int& position, int& texCoord) noexcept
+{
+	int normal = 0;
+
+	position = 0;
+	texCoord = s_NoTexCoord;
+
+	p = ScanInt(SkipBlanks(p, end), end, position);
+
+	// "v//vn" and "v/" have no texCoord, "v/0" has an invalid one
+	if (p < end && *p == '/')
+	{
+		if (++p < end && (IsDigit(*p) || *p == '-' || *p == '+')) p = ScanInt(p, end, texCoord);
+		if (p < end && *p == '/') p = ScanInt(p + 1, end, normal);
+	}
+
+	return p;
+}
+
+// a face corner exactly as written in the file, 1-based or negative, texCoord s_NoTexCoord if there is none
+struct FileCorner
+{
+	int position;
+	int texCoord;
+};
+
+// triangulates the corners of the face in [p, end) as a fan around the first one and passes every triangle to emit
+// returns false if a corner has no position, the face has less than three corners or emit fails
+template <typename Emit>
+static bool ScanFace(const char* p, const char* const end, Emit&& emit)
+{
+	FileCorner triangle[3] = {};
+	int corners = 0;
+
+	// a comment may follow the corners
+	for (p = SkipBlanks(p, end); p < end && *p != '#'; p = SkipBlanks(p, end))
+	{
+		// the first corner stays, every new one replaces the last one after the triangle it closes is emitted
+		FileCorner& corner = triangle[std::min(corners, 2)];
+
+		p = ScanCorner(p, end, corner.position, corner.texCoord);
+
+		if (corner.position == 0) return false;
+
+		if (++corners >= 3)
+		{
+			if (!emit(triangle)) return false;
 
-static void add(const std::string& face)
+			triangle[1] = triangle[2];
+		}
+	}
+
+	return corners >= 3;
+}
+
+// the rest of the line without surrounding blanks
+static std::string Rest(const char* p, const char* end)
 {
-	const auto comps = split(face, "/");
+	p = SkipBlanks(p, end);
 
-	const int first  = atoi(comps[0].c_str()) - 1;
-	const int second = atoi(comps[1].c_str()) - 1;
+	while (end > p && IsBlank(end[-1])) --end;
 
-	const auto& position = positions[first];
-	const auto& texcoord = texCoords[second];
+	return std::string(p, end);
+}
 
-	const Vertex vertex = {
-		{ position.x, position.y, position.z },
-		{ 1.0f, 1.0f, 1.0f, 1.0f },	// color - white/opaque
-		{ texcoord.u, texcoord.v }
+static inline bool IsKeyword(const char* p, const char* const end, const char* keyword, const size_t length) noexcept
+{
+	return static_cast<size_t>(end - p) > length && memcmp(p, keyword, length) == 0 && IsBlank(p[length]);
+}
+
+// the file names after the mtllib keyword, several libraries may be listed on one line
+static void ParseLibraries(const char* p, const char* const end, std::vector<std::string>& libraries)
+{
+	for (p = SkipBlanks(p, end); p < end; p = SkipBlanks(p, end))
+	{
+		const char* name = p;
+
+		while (p < end && !IsBlank(*p)) ++p;
+
+		libraries.emplace_back(name, p);
+	}
+}
+
+// parses a single line [p, end) into chunk, returns false if the line is a malformed face
+static bool ParseLine(const char* p, const char* const end, Chunk& chunk)
+{
+	p = SkipBlanks(p, end);
+
+	if (end - p < 2) return true;
+
+	if (p[0] == 'v' && IsBlank(p[1]))
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+
+		p = ScanFloat(SkipBlanks(p + 2, end), end, x);
+		p = ScanFloat(SkipBlanks(p, end), end, y);
+		p = ScanFloat(SkipBlanks(p, end), end, z);
+
+		chunk.positions.emplace_back(x, y, z);
+	}
+	else if (p[0] == 'v' && p[1] == 't' && end - p > 2 && IsBlank(p[2]))
+	{
+		float u = 0.0f, v = 0.0f;
+
+		p = ScanFloat(SkipBlanks(p + 3, end), end, u);
+		p = ScanFloat(SkipBlanks(p, end), end, v);
+
+		chunk.texCoords.emplace_back(u, 1.0f - v);
+	}
+	else if (p[0] == 'f' && IsBlank(p[1]) && !chunk.attributesOnly)
+	{
+		return ScanFace(p + 2, end, [&chunk](const FileCorner (&triangle)[3])
+		{
+			for (const auto& corner : triangle) AddCorner(chunk, corner.position, corner.texCoord);
+
+			return true;
+		});
+	}
+	else if (IsKeyword(p, end, "usemtl", 6) && !chunk.attributesOnly)
+	{
+		chunk.materials.emplace_back(chunk.corners.size(), Rest(p + 6, end));
+	}
+	else if (IsKeyword(p, end, "mtllib", 6) && !chunk.attributesOnly)
+	{
+		ParseLibraries(p + 6, end, chunk.libraries);
+	}
+
+	return true;
+}
+
+// calls parse(line, eol) for every line of [p, end) until it returns false, eol is the newline or end
+// the newlines are found a block at a time by ObjTokenizer, the lines of a block by walking the set bits of its mask
+template <typename Parse>
+static bool ForEachLine(const char* p, const char* const end, Parse&& parse)
+{
+	const auto lines = [&](const char* const block, uint64_t newlines) -> bool
+	{
+		for (; newlines; newlines &= newlines - 1)
+		{
+			const char* const eol = block + ObjTokenizer::LowestBit(newlines);
+
+			if (!parse(p, eol)) return false;
+
+			p = eol + 1;
+		}
+
+		return true;
 	};
 
-	vertices.emplace_back(vertex);
-	const DWORD index = indices.size();
-	indices.push_back(index);
+	const char* block = p;
+
+	for (; static_cast<size_t>(end - block) >= ObjTokenizer::BlockSize; block += ObjTokenizer::BlockSize)
+	{
+		if (!lines(block, ObjTokenizer::FindNewlines(block))) return false;
+	}
+
+	if (block < end)
+	{
+		// the last block goes through a padded copy, the loads never read past the text
+		char tail[ObjTokenizer::BlockSize] = {};
+
+		memcpy(tail, block, end - block);
+
+		if (!lines(block, ObjTokenizer::FindNewlines(tail))) return false;
+	}
+
+	// the last line may have no newline
+	return p >= end || parse(p, end);
 }
 
-void OBJLoader::Load(const std::string& filename, Vertex*& outVertices, int& vcount, DWORD*& outIndices, int& icount) noexcept
+static void ParseChunk(Chunk& chunk)
 {
-	std::string to;
-	std::ifstream t(filename);
+	chunk.positions.resize(0);
+	chunk.texCoords.resize(0);
+	chunk.corners.resize(0);
+	chunk.relativePositions.resize(0);
+	chunk.relativeTexCoords.resize(0);
+	chunk.materials.resize(0);
+	chunk.libraries.resize(0);
 
-	indices.resize(0);
-	vertices.resize(0);
-	positions.resize(0);
-	texCoords.resize(0);
+	chunk.valid = ForEachLine(chunk.begin, chunk.end, [&chunk](const char* line, const char* const eol)
+	{
+		return ParseLine(line, eol, chunk);
+	});
+}
+
+// splits [data, data + size) into up to one chunk per thread, 0 threads uses one per core, every chunk but the first starts right after a newline
+static void Split(ObjScratch& scratch, const char* data, const size_t size, const bool attributesOnly, const UINT maxThreads)
+{
+	auto& chunks = scratch.chunks;
 
-	while (std::getline(t, to))
+	const size_t threads = maxThreads ? maxThreads : std::max(1u, std::thread::hardware_concurrency());
+	const size_t count = std::max<size_t>(1, std::min(threads, size / s_MinChunkSize));
+	const char* const end = data + size;
+
+	chunks.resize(count);
+
+	const char* begin = data;
+
+	for (size_t i = 0; i < count; ++i)
 	{
-		const auto comps = split(to, " ");
+		const char* split = (i + 1 == count) ? end : data + size / count * (i + 1);
+
+		if (split < begin) split = begin;
+
+		const char* eol = static_cast<const char*>(memchr(split, '\n', end - split));
+
+		chunks[i].begin = begin;
+		chunks[i].end = (eol && i + 1 < count) ? eol + 1 : end;
+		chunks[i].attributesOnly = attributesOnly;
+
+		begin = chunks[i].end;
+	}
+}
+
+// assigns every face the material of the last usemtl before it, the first material is the one without name
+static void MergeMaterials(ObjScratch& scratch)
+{
+	auto& faceMaterials = scratch.faceMaterials;
+	auto& materials = scratch.materials;
 
-		if (comps.size() == 0) continue;
+	materials.assign(1, std::string());
+	scratch.libraries.resize(0);
+	faceMaterials.resize(scratch.corners.size() / 3);
 
-		if (comps[0] == "#") continue;
-		if (comps[0] == "o") continue;
-		if (comps[0] == "s") continue;
+	UINT current = 0;
+	size_t face = 0;
+	size_t cornerBase = 0;
 
-		if (comps[0] == "v")
+	for (const auto& chunk : scratch.chunks)
+	{
+		for (const auto& material : chunk.materials)
 		{
-			positions.emplace_back(strtof(comps[1].c_str(), nullptr), strtof(comps[2].c_str(), nullptr), strtof(comps[3].c_str(), nullptr));
+			const size_t first = (cornerBase + material.first) / 3;
+
+			std::fill(faceMaterials.begin() + face, faceMaterials.begin() + first, current);
+			face = first;
+
+			current = static_cast<UINT>(std::find(materials.begin(), materials.end(), material.second) - materials.begin());
+
+			if (current == materials.size()) materials.push_back(material.second);
 		}
-		else if (comps[0] == "vt")
+
+		scratch.libraries.insert(scratch.libraries.end(), chunk.libraries.begin(), chunk.libraries.end());
+
+		cornerBase += chunk.corners.size();
+	}
+
+	std::fill(faceMaterials.begin() + face, faceMaterials.end(), current);
+}
+
+// concatenates the chunk attributes and rebases their corners, returns false if any index is out of range
+static bool Merge(ObjScratch& scratch)
+{
+	auto& positions = scratch.positions;
+	auto& texCoords = scratch.texCoords;
+	auto& corners = scratch.corners;
+
+	size_t positionCount = 0, texCoordCount = 0, cornerCount = 0;
+
+	for (const auto& chunk : scratch.chunks)
+	{
+		if (!chunk.valid) return false;
+
+		positionCount += chunk.positions.size();
+		texCoordCount += chunk.texCoords.size();
+		cornerCount += chunk.corners.size();
+	}
+
+	positions.resize(positionCount);
+	texCoords.resize(texCoordCount);
+	corners.resize(cornerCount);
+
+	// exclusive prefix sums over the chunk counts are the offsets of every chunk in the merged arrays
+	size_t positionBase = 0, texCoordBase = 0, cornerBase = 0;
+
+	for (const auto& chunk : scratch.chunks)
+	{
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + positionBase);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + texCoordBase);
+		std::copy(chunk.corners.begin(), chunk.corners.end(), corners.begin() + cornerBase);
+
+		for (const auto corner : chunk.relativePositions) corners[cornerBase + corner].position += static_cast<int>(positionBase);
+		for (const auto corner : chunk.relativeTexCoords) corners[cornerBase + corner].texCoord += static_cast<int>(texCoordBase);
+
+		positionBase += chunk.positions.size();
+		texCoordBase += chunk.texCoords.size();
+		cornerBase += chunk.corners.size();
+	}
+
+	for (const auto& corner : corners)
+	{
+		if (corner.position < 0 || corner.position >= static_cast<int>(positionCount)) return false;
+		if (corner.texCoord != s_NoTexCoord && (corner.texCoord < 0 || corner.texCoord >= static_cast<int>(texCoordCount))) return false;
+	}
+
+	MergeMaterials(scratch);
+
+	return true;
+}
+
+// welding runs serially in face order, which makes the output independent of the number of chunks
+static void Weld(ObjScratch& scratch, std::vector<Vertex>& vertices, std::vector<DWORD>& indices)
+{
+	auto& weld = scratch.weld;
+	const auto& positions = scratch.positions;
+	const auto& texCoords = scratch.texCoords;
+
+	weld.Reset();
+
+	for (const auto& corner : scratch.corners)
+	{
+		// corners sharing position and texture coordinate are the same vertex
+		const uint64_t key = (static_cast<uint64_t>(corner.position) << 32) | static_cast<uint32_t>(corner.texCoord);
+		const DWORD index = weld.Insert(key, static_cast<DWORD>(vertices.size()));
+
+		indices.push_back(index);
+
+		if (index < vertices.size()) continue;
+
+		// a corner without texture coordinate is treated as "vt 0 0"
+		const auto& p = positions[corner.position];
+		const auto t = (corner.texCoord == s_NoTexCoord) ? V2(0.0f, 1.0f) : texCoords[corner.texCoord];
+
+		const Vertex vertex = {
+			{ p.x, p.y, p.z },
+			{ 1.0f, 1.0f, 1.0f, 1.0f },	// color - white/opaque
+			{ t.u, t.v }
+		};
+
+		vertices.emplace_back(vertex);
+	}
+}
+
+// moves the triangles into one consecutive range per material, the order inside a material stays the same
+static void Group(ObjScratch& scratch, std::vector<DWORD>& indices, std::vector<ObjSubmesh>& submeshes)
+{
+	const auto& faceMaterials = scratch.faceMaterials;
+	const auto& materials = scratch.materials;
+	auto& grouped = scratch.groupedIndices;
+
+	// exclusive prefix sums over the faces per material are the first face of every range
+	std::vector<DWORD> offsets(materials.size() + 1, 0);
+
+	for (const auto material : faceMaterials) ++offsets[material + 1];
+	for (size_t m = 0; m < materials.size(); ++m) offsets[m + 1] += offsets[m];
+
+	submeshes.resize(0);
+
+	for (size_t m = 0; m < materials.size(); ++m)
+	{
+		if (offsets[m + 1] > offsets[m]) submeshes.push_back({ materials[m], std::string(), offsets[m] * 3, (offsets[m + 1] - offsets[m]) * 3 });
+	}
+
+	grouped.resize(indices.size());
+
+	for (size_t face = 0; face < faceMaterials.size(); ++face)
+	{
+		const DWORD target = offsets[faceMaterials[face]]++ * 3;
+
+		std::copy(indices.begin() + face * 3, indices.begin() + face * 3 + 3, grouped.begin() + target);
+	}
+
+	indices.swap(grouped);
+}
+
+// reads newmtl and map_Kd from the material libraries, texture paths are relative to their library
+static void ResolveTextures(const std::string& directory, const std::vector<std::string>& libraries, std::vector<ObjSubmesh>& submeshes)
+{
+	for (const auto& library : libraries)
+	{
+		std::ifstream input(directory + library);
+
+		if (!input.is_open())
 		{
-			texCoords.emplace_back(strtof(comps[1].c_str(), nullptr), 1.0f - strtof(comps[2].c_str(), nullptr));
+			Log::Error("Material library " + directory + library + " couldn't be loaded.");
+
+			continue;
 		}
-		else if (comps[0] == "f")
+
+		const auto libraryDirectory = directory + library.substr(0, library.find_last_of("/\\") + 1);
+
+		std::string line;
+		std::string material;
+
+		while (std::getline(input, line))
 		{
-			add(comps[1]);
-			add(comps[2]);
-			add(comps[3]);
+			const char* const end = line.data() + line.size();
+			const char* p = SkipBlanks(line.data(), end);
+
+			if (IsKeyword(p, end, "newmtl", 6)) material = Rest(p + 6, end);
+			else if (IsKeyword(p, end, "map_Kd", 6))
+			{
+				// options like -s or -o come before the file name
+				auto texture = Rest(p + 6, end);
+				const auto blank = texture.find_last_of(" \t");
+
+				if (blank != std::string::npos) texture = texture.substr(blank + 1);
+
+				for (auto& submesh : submeshes) if (submesh.Material == material) submesh.Texture = libraryDirectory + texture;
+			}
 		}
 	}
+}
+
+// the first chunk is parsed on this thread while the others run in parallel
+static void ParseChunks(ObjScratch& scratch)
+{
+	std::vector<std::thread> workers;
+
+	for (size_t i = 1; i < scratch.chunks.size(); ++i) workers.emplace_back(ParseChunk, std::ref(scratch.chunks[i]));
+
+	ParseChunk(scratch.chunks[0]);
+
+	for (auto& worker : workers) worker.join();
+}
+
+// second pass of a streaming import: welds the faces batch by batch against the merged attributes
+// vertices are only shared inside a batch, so the memory needed does not grow with the file
+static bool StreamFaces(ObjScratch& scratch, const char* p, const char* const end, ObjSink& sink)
+{
+	auto& weld = scratch.weld;
+	auto& vertices = scratch.batchVertices;
+	auto& indices = scratch.batchIndices;
+	const auto& positions = scratch.positions;
+	const auto& texCoords = scratch.texCoords;
+
+	// number of v/vt lines seen so far, negative indices are relative to these
+	int positionCount = 0;
+	int texCoordCount = 0;
+	DWORD base = 0;
+
+	const auto flush = [&](void) -> bool
+	{
+		if (!vertices.empty() && !sink.Vertices(vertices.data(), vertices.size())) return false;
+		if (!indices.empty() && !sink.Indices(indices.data(), indices.size())) return false;
+
+		base += static_cast<DWORD>(vertices.size());
+
+		vertices.resize(0);
+		indices.resize(0);
+		weld.Reset();
+
+		return true;
+	};
+
+	vertices.resize(0);
+	indices.resize(0);
+	weld.Reset();
+
+	const bool parsed = ForEachLine(p, end, [&](const char* line, const char* const eol)
+	{
+		line = SkipBlanks(line, eol);
+
+		if (eol - line < 2) return true;
+
+		if (line[0] == 'v' && IsBlank(line[1])) ++positionCount;
+		else if (line[0] == 'v' && line[1] == 't' && eol - line > 2 && IsBlank(line[2])) ++texCoordCount;
+		else if (line[0] == 'f' && IsBlank(line[1]))
+		{
+			return ScanFace(line + 2, eol, [&](const FileCorner (&triangle)[3])
+			{
+				// a triangle never spans two batches, the triangles of one polygon may
+				if (vertices.size() + 3 > s_BatchVertices || indices.size() + 3 > s_BatchIndices)
+				{
+					if (!flush()) return false;
+				}
+
+				for (const auto& corner : triangle)
+				{
+					const int first = (corner.position < 0) ? positionCount + corner.position : corner.position - 1;
+					const int second = (corner.texCoord == s_NoTexCoord) ? s_NoTexCoord : (corner.texCoord < 0) ? texCoordCount + corner.texCoord : corner.texCoord - 1;
+
+					if (first < 0 || first >= static_cast<int>(positions.size())) return false;
+					if (second != s_NoTexCoord && (second < 0 || second >= static_cast<int>(texCoords.size()))) return false;
+
+					const uint64_t key = (static_cast<uint64_t>(first) << 32) | static_cast<uint32_t>(second);
+					const DWORD index = weld.Insert(key, static_cast<DWORD>(vertices.size()));
+
+					indices.push_back(base + index);
+
+					if (index < vertices.size()) continue;
+
+					const auto& v = positions[first];
+					const auto t = (second == s_NoTexCoord) ? V2(0.0f, 1.0f) : texCoords[second];
+
+					vertices.push_back({ { v.x, v.y, v.z }, { 1.0f, 1.0f, 1.0f, 1.0f }, { t.u, t.v } });
+				}
+
+				return true;
+			});
+		}
+
+		return true;
+	});
+
+	return parsed && flush();
+}
+
+OBJLoader::OBJLoader(UINT threads) : m_Scratch(new ObjScratch()), m_Threads(threads) {}
+
+OBJLoader::~OBJLoader(void) noexcept = default;
+
+bool OBJLoader::Import(const std::string& filename) noexcept
+{
+	auto& scratch = *m_Scratch;
+
+	m_Vertices.resize(0);
+	m_Indices.resize(0);
+	m_Submeshes.resize(0);
+
+	MappedFile file;
+
+	if (!file.Open(filename))
+	{
+		Log::Error("Obj File couldn't be loaded.");
+
+		return false;
+	}
+
+	Split(scratch, file.Data(), file.Size(), false, m_Threads);
+	ParseChunks(scratch);
+
+	if (!Merge(scratch))
+	{
+		Log::Error("Obj File contains an invalid face.");
+
+		return false;
+	}
+
+	Weld(scratch, m_Vertices, m_Indices);
+	Group(scratch, m_Indices, m_Submeshes);
+	ResolveTextures(filename.substr(0, filename.find_last_of("/\\") + 1), scratch.libraries, m_Submeshes);
+
+	return true;
+}
+
+bool OBJLoader::Stream(const std::string& filename, ObjSink& sink) noexcept
+{
+	auto& scratch = *m_Scratch;
+
+	m_Vertices.resize(0);
+	m_Indices.resize(0);
+	m_Submeshes.resize(0);
+
+	MappedFile file;
+
+	if (!file.Open(filename))
+	{
+		Log::Error("Obj File couldn't be loaded.");
+
+		return false;
+	}
+
+	// first pass: only positions and texture coordinates, which faces anywhere in the file may reference
+	Split(scratch, file.Data(), file.Size(), true, m_Threads);
+	ParseChunks(scratch);
+
+	if (!Merge(scratch) || !StreamFaces(scratch, file.Data(), file.Data() + file.Size(), sink))
+	{
+		Log::Error("Obj File contains an invalid face.");
+
+		return false;
+	}
+
+	return true;
+}
+
+void OBJLoader::Libraries(const char* data, size_t size, std::vector<std::string>& libraries)
+{
+	const char* const end = data + size;
+
+	for (const char* p = data; p < end;)
+	{
+		const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+
+		if (!eol) eol = end;
+
+		const char* keyword = SkipBlanks(p, eol);
+
+		if (IsKeyword(keyword, eol, "mtllib", 6)) ParseLibraries(keyword + 6, eol, libraries);
+
+		p = eol + 1;
+	}
+}
+
+void OBJLoader::Load(const std::string& filename, Vertex*& outVertices, int& vcount, DWORD*& outIndices, int& icount) noexcept
+{
+	OBJLoader loader;
+
+	outVertices = nullptr;
+	outIndices = nullptr;
+	vcount = 0;
+	icount = 0;
+
+	if (!loader.Import(filename)) return;
 
-	vcount = (int)vertices.size();
+	vcount = (int)loader.m_Vertices.size();
 	outVertices = new Vertex[vcount];
 
-	memcpy(outVertices, vertices.data(), vcount * sizeof(Vertex));
+	memcpy(outVertices, loader.m_Vertices.data(), vcount * sizeof(Vertex));
 
-	icount = (int)indices.size();
+	icount = (int)loader.m_Indices.size();
 	outIndices = new DWORD[icount];
 
-	memcpy(outIndices, indices.data(), sizeof(DWORD)* icount);
+	memcpy(outIndices, loader.m_Indices.data(), sizeof(DWORD)* icount);
 }
@@ -1,10 +1,62 @@
 #pragma once
 
+struct ObjScratch;
+
+// the faces of one material, see OBJLoader::Submeshes
+struct ObjSubmesh
+{
+  std::string Material;
+  std::string Texture;  // map_Kd of the material relative to the working directory, empty if it has none
+  DWORD IndexStart;
+  DWORD IndexCount;
+};
+
+// receives the result of OBJLoader::Stream in batches, the indices refer to all vertices received so far
+class ObjSink
+{
+public:
+  virtual ~ObjSink(void) noexcept = default;
+
+  virtual bool Vertices(const Vertex* vertices, size_t count) = 0;
+  virtual bool Indices(const DWORD* indices, size_t count) = 0;
+};
+
+// an OBJLoader can be used by one thread at a time, different instances import concurrently
+// large files are parsed in chunks on up to threads threads, 0 uses one per core, loaders that import concurrently share the cores between them
 class OBJLoader
 {
 public:
+  explicit OBJLoader(UINT threads = 0);
+  ~OBJLoader(void) noexcept;
+
+  OBJLoader(const OBJLoader&) = delete;
+  OBJLoader& operator=(const OBJLoader&) = delete;
+
+  // copies the result into new[] arrays, imports with a loader of its own
   static void Load(const std::string& filename, Vertex*& outVertices, int& vcount, DWORD*& outIndices, int& icount) noexcept;
 
-  OBJLoader(void) noexcept = delete;
-  ~OBJLoader(void) noexcept = delete;
+  // the mtllib file names of the OBJ file in data, relative to the directory of the file
+  static void Libraries(const char* data, size_t size, std::vector<std::string>& libraries);
+
+  // faces with more than three corners are split into a fan around their first corner, normals are skipped
+  bool Import(const std::string& filename) noexcept;
+  // imports without holding the vertices and indices of the whole file, they are passed to sink in fixed size batches
+  // only the positions and texture coordinates of the file are kept in memory, Vertices and Indices stay empty
+  // materials are ignored, the faces arrive in file order
+  bool Stream(const std::string& filename, ObjSink& sink) noexcept;
+
+  // valid until the next Import on this loader
+  inline const std::vector<Vertex>& Vertices(void) const noexcept { return m_Vertices; }
+  inline const std::vector<DWORD>& Indices(void) const noexcept { return m_Indices; }
+  // the indices are grouped by usemtl into one consecutive range per material, in the order the materials are first used
+  // faces before the first usemtl belong to a material without name, a file without usemtl is a single submesh
+  inline const std::vector<ObjSubmesh>& Submeshes(void) const noexcept { return m_Submeshes; }
+
+private:
+  std::unique_ptr<ObjScratch> m_Scratch;
+  UINT m_Threads;
+  std::vector<Vertex> m_Vertices;
+  std::vector<DWORD> m_Indices;
+  std::vector<ObjSubmesh> m_Submeshes;
+
 };
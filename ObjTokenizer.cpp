@@ -0,0 +1,87 @@
+#include "ObjTokenizer.h"
+
+#include <immintrin.h>
+
+typedef uint64_t (*ClassifyBlock)(const char* block);
+
+static uint64_t ClassifyScalar(const char* block)
+{
+  uint64_t newlines = 0;
+
+  for (size_t i = 0; i < ObjTokenizer::BlockSize; ++i)
+  {
+    if (block[i] == '\n') newlines |= 1ull << i;
+  }
+
+  return newlines;
+}
+
+static uint64_t ClassifySSE2(const char* block)
+{
+  const __m128i newline = _mm_set1_epi8('\n');
+
+  uint64_t newlines = 0;
+
+  for (size_t i = 0; i < ObjTokenizer::BlockSize; i += 16)
+  {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+
+    newlines |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << i;
+  }
+
+  return newlines;
+}
+
+static uint64_t ClassifyAVX2(const char* block)
+{
+  const __m256i newline = _mm256_set1_epi8('\n');
+  const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline))) |
+    (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)))) << 32);
+}
+
+struct Classifier
+{
+  ClassifyBlock Function;
+  const char* Name;
+};
+
+static Classifier SelectClassifier(void) noexcept
+{
+  int info[4];
+
+  __cpuid(info, 0);
+
+  const int leaves = info[0];
+
+  __cpuid(info, 1);
+
+  const bool sse2 = (info[3] & (1 << 26)) != 0;
+  // AVX2 also needs the OS to save the YMM registers
+  const bool ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+
+  if (ymm && leaves >= 7)
+  {
+    __cpuidex(info, 7, 0);
+
+    if (info[1] & (1 << 5)) return { ClassifyAVX2, "AVX2" };
+  }
+
+  if (sse2) return { ClassifySSE2, "SSE2" };
+
+  return { ClassifyScalar, "scalar" };
+}
+
+static const Classifier s_Classifier = SelectClassifier();
+
+uint64_t ObjTokenizer::FindNewlines(const char* block) noexcept
+{
+  return s_Classifier.Function(block);
+}
+
+const char* ObjTokenizer::InstructionSet(void) noexcept
+{
+  return s_Classifier.Name;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <intrin.h>
+
+// first stage of the OBJ parser in the style of simdjson, classifies the text 64 bytes at a time with AVX2, SSE2 or scalar code
+// the second stage in ObjLoader.cpp walks the set bits of the newline masks to find the records instead of searching every line
+class ObjTokenizer
+{
+public:
+  static constexpr size_t BlockSize = 64;
+
+  // bit i is set if block[i] is a newline, block has to hold BlockSize bytes
+  static uint64_t FindNewlines(const char* block) noexcept;
+
+  // "AVX2", "SSE2" or "scalar", whichever FindNewlines runs on this CPU
+  static const char* InstructionSet(void) noexcept;
+
+  // index of the lowest set bit, bits may not be 0
+  static inline unsigned long LowestBit(const uint64_t bits) noexcept
+  {
+    unsigned long index;
+
+#ifdef _WIN64
+    _BitScanForward64(&index, bits);
+#else
+    if (!_BitScanForward(&index, static_cast<unsigned long>(bits)))
+    {
+      _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+      index += 32;
+    }
+#endif
+
+    return index;
+  }
+
+private:
+  ObjTokenizer(void) noexcept = delete;
+  ~ObjTokenizer(void) noexcept = delete;
+
+};
@@ -5,14 +5,25 @@ struct VS_OUTPUT
 	float2 texcoord : TEXCOORD;
 };
 
-#ifdef TEXTURE
+#ifdef TEXTURE_ARRAY
+Texture2DArray t1: register(t0);
+SamplerState s1 : register(s0);
+
+// the layer of the texture array the draw samples
+cbuffer TextureSlice : register(b1)
+{
+	uint slice;
+};
+#elif defined(TEXTURE)
 Texture2D t1: register(t0);
 SamplerState s1 : register(s0);
 #endif
 
 float4 main(VS_OUTPUT input) : SV_TARGET
 {
-#ifdef TEXTURE
+#ifdef TEXTURE_ARRAY
+	return t1.Sample(s1, float3(input.texcoord, slice));
+#elif defined(TEXTURE)
 	return t1.Sample(s1, input.texcoord);
 #else
 	return input.color;
@@ -0,0 +1,980 @@
+#include "PngDecoder.h"
+
+#include <emmintrin.h>
+
+static const BYTE s_Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+static inline uint32_t ReadBigEndian(const BYTE* p) noexcept
+{
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// reads a deflate stream least significant bit first, 8 bytes at a time while there are that many left
+struct BitReader
+{
+  const BYTE* next;
+  const BYTE* end;
+  uint64_t bits;
+  uint32_t count;     // valid bits in bits, the ones above hold the next byte and are loaded again by the next refill
+  uint32_t overrun;   // zero bytes appended after end
+
+  // at least 56 valid bits afterwards, enough for a length and a distance with their extra bits
+  inline void Refill(void) noexcept
+  {
+    if (end - next >= 8)
+    {
+      uint64_t word;
+
+      memcpy(&word, next, sizeof(word));
+
+      bits |= word << count;
+      next += (63 - count) >> 3;
+      count |= 56;
+    }
+    else
+    {
+      for (; count <= 56; count += 8)
+      {
+        if (next < end) bits |= static_cast<uint64_t>(*next++) << count;
+        else ++overrun;
+      }
+    }
+  }
+
+  inline uint32_t Peek(const uint32_t n) const noexcept { return static_cast<uint32_t>(bits & ((1ull << n) - 1)); }
+
+  inline void Consume(const uint32_t n) noexcept
+  {
+    bits >>= n;
+    count -= n;
+  }
+
+  inline uint32_t Read(const uint32_t n) noexcept
+  {
+    const uint32_t value = Peek(n);
+
+    Consume(n);
+
+    return value;
+  }
+
+  // false once bits past the end of the stream were consumed
+  inline bool Valid(void) const noexcept { return overrun * 8 <= count; }
+};
+
+// codes up to this length are decoded with a single table lookup
+static constexpr uint32_t s_FastBits = 10;
+
+// canonical Huffman code of deflate
+struct Huffman
+{
+  uint16_t fast[1 << s_FastBits];   // symbol << 4 | length indexed by the next s_FastBits bits, 0 for longer codes
+  uint16_t counts[16];              // number of codes of every length
+  uint16_t symbols[288];            // ordered by code length, then by symbol
+
+  // false if the lengths describe more codes than there are, fewer are fine for a distance code with a single symbol
+  bool Build(const BYTE* lengths, const uint32_t n) noexcept
+  {
+    uint16_t offsets[16];
+
+    memset(counts, 0, sizeof(counts));
+
+    for (uint32_t i = 0; i < n; ++i) ++counts[lengths[i]];
+
+    counts[0] = 0;
+
+    int left = 1;
+
+    for (uint32_t length = 1; length < 16; ++length)
+    {
+      left = (left << 1) - counts[length];
+
+      if (left < 0) return false;
+    }
+
+    offsets[1] = 0;
+
+    for (uint32_t length = 1; length < 15; ++length) offsets[length + 1] = offsets[length] + counts[length];
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      if (lengths[i]) symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+    }
+
+    memset(fast, 0, sizeof(fast));
+
+    // the stream holds every code starting with its most significant bit, so the table is indexed by the reversed codes
+    uint32_t code = 0;
+    uint32_t index = 0;
+
+    for (uint32_t length = 1; length <= s_FastBits; ++length, code <<= 1)
+    {
+      for (uint32_t i = 0; i < counts[length]; ++i, ++code, ++index)
+      {
+        uint32_t reversed = 0;
+
+        for (uint32_t bit = 0; bit < length; ++bit) reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+
+        const uint16_t entry = static_cast<uint16_t>(symbols[index] << 4 | length);
+
+        for (; reversed < (1u << s_FastBits); reversed += 1u << length) fast[reversed] = entry;
+      }
+    }
+
+    return true;
+  }
+
+  // the next symbol or -1 if the bits are no code, the reader needs at least 15 valid bits
+  inline int Decode(BitReader& reader) const noexcept
+  {
+    const uint32_t entry = fast[reader.Peek(s_FastBits)];
+
+    if (entry)
+    {
+      reader.Consume(entry & 15);
+
+      return static_cast<int>(entry >> 4);
+    }
+
+    // a code longer than s_FastBits, walked bit by bit through the counts
+    int code = 0;
+    int first = 0;
+    int index = 0;
+
+    for (uint32_t length = 1; length < 16; ++length)
+    {
+      code |= static_cast<int>((reader.bits >> (length - 1)) & 1);
+
+      if (code - first < counts[length])
+      {
+        reader.Consume(length);
+
+        return symbols[index + code - first];
+      }
+
+      index += counts[length];
+      first = (first + counts[length]) << 1;
+      code <<= 1;
+    }
+
+    return -1;
+  }
+};
+
+static const uint16_t s_LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const BYTE s_LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t s_DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const BYTE s_DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const BYTE s_CodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// decodes the symbols of one compressed block up to its end of block symbol into [out, end), or until end is reached
+// a match is copied 8 bytes at a time, so up to 7 bytes after end may be overwritten
+static bool InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, BYTE* const begin, BYTE*& out, BYTE* const end) noexcept
+{
+  while (out != end)
+  {
+    reader.Refill();
+
+    const int symbol = literals.Decode(reader);
+
+    if (symbol < 256)
+    {
+      if (symbol < 0) return false;
+
+      *out++ = static_cast<BYTE>(symbol);
+
+      continue;
+    }
+
+    if (symbol == 256) return true;
+    if (symbol > 285) return false;
+
+    // a stream with more data than the rows need is cut off at end
+    const size_t length = std::min<size_t>(s_LengthBase[symbol - 257] + reader.Read(s_LengthExtra[symbol - 257]), end - out);
+    const int code = distances.Decode(reader);
+
+    if (code < 0 || code >= 30) return false;
+
+    const uint32_t distance = s_DistanceBase[code] + reader.Read(s_DistanceExtra[code]);
+
+    if (distance > static_cast<size_t>(out - begin)) return false;
+
+    const BYTE* from = out - distance;
+    BYTE* const stop = out + length;
+
+    if (distance >= 8)
+    {
+      for (; out < stop; out += 8, from += 8) memcpy(out, from, 8);
+    }
+    else if (distance == 1)
+    {
+      memset(out, *from, length);
+    }
+    else
+    {
+      while (out < stop) *out++ = *from++;
+    }
+
+    out = stop;
+  }
+
+  return true;
+}
+
+// reads the code lengths of a block with dynamic Huffman codes
+static bool ReadDynamicCodes(BitReader& reader, Huffman& literals, Huffman& distances) noexcept
+{
+  BYTE lengths[286 + 30] = {};
+
+  reader.Refill();
+
+  const uint32_t literalCount = reader.Read(5) + 257;
+  const uint32_t distanceCount = reader.Read(5) + 1;
+  const uint32_t codeLengthCount = reader.Read(4) + 4;
+
+  if (literalCount > 286 || distanceCount > 30) return false;
+
+  for (uint32_t i = 0; i < codeLengthCount; ++i)
+  {
+    reader.Refill();
+    lengths[s_CodeLengthOrder[i]] = static_cast<BYTE>(reader.Read(3));
+  }
+
+  Huffman codeLengths;
+
+  if (!codeLengths.Build(lengths, 19)) return false;
+
+  memset(lengths, 0, 19);
+
+  for (uint32_t i = 0; i < literalCount + distanceCount;)
+  {
+    reader.Refill();
+
+    const int symbol = codeLengths.Decode(reader);
+
+    if (symbol < 0) return false;
+
+    if (symbol < 16)
+    {
+      lengths[i++] = static_cast<BYTE>(symbol);
+
+      continue;
+    }
+
+    // 16 repeats the previous length, 17 and 18 repeat zeros
+    BYTE length = 0;
+    uint32_t repeat;
+
+    if (symbol == 16)
+    {
+      if (i == 0) return false;
+
+      length = lengths[i - 1];
+      repeat = 3 + reader.Read(2);
+    }
+    else if (symbol == 17)
+    {
+      repeat = 3 + reader.Read(3);
+    }
+    else
+    {
+      repeat = 11 + reader.Read(7);
+    }
+
+    if (i + repeat > literalCount + distanceCount) return false;
+
+    memset(lengths + i, length, repeat);
+    i += repeat;
+  }
+
+  // a block without end of block symbol could never end
+  if (lengths[256] == 0) return false;
+
+  return literals.Build(lengths, literalCount) && distances.Build(lengths + literalCount, distanceCount) && reader.Valid();
+}
+
+// the sums of Adler-32 are reduced every 5552 bytes, the most that can be added before the second one overflows 32 bits
+static constexpr uint32_t s_AdlerModulo = 65521;
+static constexpr size_t s_AdlerChunk = 5552;
+
+// Adler-32 of [data, data + size), 16 bytes at a time with SSE2
+// for a block of 16 bytes the second sum grows by 16 times the first sum before it plus the bytes weighted 16 down to 1
+static uint32_t Adler32(const BYTE* data, size_t size) noexcept
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weightsLow = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+  const __m128i weightsHigh = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+
+  uint32_t a = 1;
+  uint32_t b = 0;
+
+  while (size)
+  {
+    const size_t n = std::min(size, s_AdlerChunk);
+    const size_t blocks = n / 16;
+
+    __m128i sums = zero;      // the bytes of the chunk so far
+    __m128i before = zero;    // sums before every block, added up
+    __m128i weighted = zero;
+
+    for (size_t i = 0; i < blocks; ++i)
+    {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+
+      before = _mm_add_epi32(before, sums);
+      sums = _mm_add_epi32(sums, _mm_sad_epu8(bytes, zero));
+      weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weightsLow));
+      weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weightsHigh));
+    }
+
+    uint32_t lanes[3][4];
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[0]), sums);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[1]), before);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[2]), weighted);
+
+    // the sums of _mm_sad_epu8 are in lanes 0 and 2
+    const uint64_t sum = static_cast<uint64_t>(lanes[0][0]) + lanes[0][2];
+    const uint64_t sumBefore = static_cast<uint64_t>(lanes[1][0]) + lanes[1][2];
+    const uint64_t weightedSum = static_cast<uint64_t>(lanes[2][0]) + lanes[2][1] + lanes[2][2] + lanes[2][3];
+
+    uint64_t b64 = b + 16 * (blocks * a + sumBefore) + weightedSum;
+    uint64_t a64 = a + sum;
+
+    for (size_t i = blocks * 16; i < n; ++i)
+    {
+      a64 += data[i];
+      b64 += a64;
+    }
+
+    a = static_cast<uint32_t>(a64 % s_AdlerModulo);
+    b = static_cast<uint32_t>(b64 % s_AdlerModulo);
+
+    data += n;
+    size -= n;
+  }
+
+  return b << 16 | a;
+}
+
+// inflates the zlib stream [data, data + size) into exactly size bytes at out, which needs 8 bytes of slack after them
+static bool Inflate(const BYTE* data, const size_t size, BYTE* out, const size_t outSize) noexcept
+{
+  // deflate without preset dictionary
+  if (size < 2 || (data[0] & 15) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20) != 0) return false;
+
+  BitReader reader = { data + 2, data + size, 0, 0, 0 };
+  BYTE* const begin = out;
+  BYTE* const end = out + outSize;
+
+  std::unique_ptr<Huffman[]> codes(new Huffman[2]);
+  Huffman& literals = codes[0];
+  Huffman& distances = codes[1];
+
+  bool last;
+
+  do
+  {
+    reader.Refill();
+
+    last = reader.Read(1) != 0;
+
+    const uint32_t type = reader.Read(2);
+
+    if (type == 0)
+    {
+      // stored block, its length follows at the next byte boundary
+      reader.Consume(reader.count & 7);
+
+      const uint32_t length = reader.Read(16);
+
+      if ((length ^ reader.Read(16)) != 0xFFFF) return false;
+
+      size_t left = std::min<size_t>(length, end - out);
+
+      for (; left && reader.count >= 8; --left) *out++ = static_cast<BYTE>(reader.Read(8));
+
+      if (left)
+      {
+        if (left > static_cast<size_t>(reader.end - reader.next)) return false;
+
+        memcpy(out, reader.next, left);
+
+        out += left;
+        reader.next += left;
+        reader.bits = 0;
+      }
+    }
+    else if (type == 1)
+    {
+      BYTE lengths[288 + 30];
+
+      memset(lengths, 8, 144);
+      memset(lengths + 144, 9, 112);
+      memset(lengths + 256, 7, 24);
+      memset(lengths + 280, 8, 8);
+      memset(lengths + 288, 5, 30);
+
+      literals.Build(lengths, 288);
+      distances.Build(lengths + 288, 30);
+
+      if (!InflateBlock(reader, literals, distances, begin, out, end)) return false;
+    }
+    else if (type == 2)
+    {
+      if (!ReadDynamicCodes(reader, literals, distances) || !InflateBlock(reader, literals, distances, begin, out, end)) return false;
+    }
+    else
+    {
+      return false;
+    }
+
+    if (!reader.Valid()) return false;
+  } while (!last && out != end);
+
+  if (out != end) return false;
+
+  // once all rows are there the rest of the stream is not inflated, the Adler-32 of the rows is the last 4 bytes of the image data
+  return size >= 6 && Adler32(begin, outSize) == ReadBigEndian(data + size - 4);
+}
+
+// the header and chunks of a PNG file that Decode needs
+struct PngImage
+{
+  UINT width;
+  UINT height;
+  uint32_t depth;
+  uint32_t colorType;
+  uint32_t channels;
+  bool interlaced;
+
+  BYTE palette[256][4];
+  uint32_t paletteSize;
+
+  // pixels of this gray value or color are transparent, set by a tRNS chunk
+  bool hasKey;
+  uint16_t key[3];
+
+  std::vector<BYTE> stream;   // the IDAT chunks joined
+};
+
+static bool ParseImage(const BYTE* data, const size_t size, PngImage& image, const bool headerOnly)
+{
+  if (!PngDecoder::IsPng(data, size)) return false;
+
+  image.paletteSize = 0;
+  image.hasKey = false;
+  image.stream.resize(0);
+
+  // the image data is most of the file, joining it then never grows the vector
+  if (!headerOnly) image.stream.reserve(size);
+
+  bool header = false;
+
+  for (size_t offset = sizeof(s_Signature); size - offset >= 12;)
+  {
+    const uint32_t length = ReadBigEndian(data + offset);
+    const BYTE* const type = data + offset + 4;
+    const BYTE* const chunk = data + offset + 8;
+
+    // a cut off file fails in Inflate if image data is missing
+    if (length > size - offset - 12) break;
+
+    offset += 12 + static_cast<size_t>(length);
+
+    if (memcmp(type, "IHDR", 4) == 0)
+    {
+      if (header || length != 13) return false;
+
+      image.width = ReadBigEndian(chunk);
+      image.height = ReadBigEndian(chunk + 4);
+      image.depth = chunk[8];
+      image.colorType = chunk[9];
+      image.interlaced = chunk[12] == 1;
+
+      // the bit depths every color type allows
+      static const uint32_t depths[7] = { 1 | 2 | 4 | 8 | 16, 0, 8 | 16, 1 | 2 | 4 | 8, 8 | 16, 0, 8 | 16 };
+      static const uint32_t channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+
+      if (image.colorType > 6 || (image.depth & (image.depth - 1)) != 0 || (depths[image.colorType] & image.depth) == 0 || chunk[10] != 0 || chunk[11] != 0 || chunk[12] > 1) return false;
+
+      // larger textures cannot be created anyway, which also keeps all sizes below far from overflowing
+      if (image.width == 0 || image.height == 0 || image.width > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION || image.height > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION) return false;
+
+      image.channels = channels[image.colorType];
+      header = true;
+
+      if (headerOnly) return true;
+    }
+    else if (!header)
+    {
+      return false;
+    }
+    else if (memcmp(type, "IDAT", 4) == 0)
+    {
+      image.stream.insert(image.stream.end(), chunk, chunk + length);
+    }
+    else if (!image.stream.empty())
+    {
+      // the IDAT chunks follow each other, nothing after them changes the pixels
+      break;
+    }
+    else if (memcmp(type, "PLTE", 4) == 0)
+    {
+      if (length % 3 != 0 || length > 3 * 256) return false;
+
+      image.paletteSize = length / 3;
+
+      for (uint32_t i = 0; i < image.paletteSize; ++i)
+      {
+        image.palette[i][0] = chunk[3 * i];
+        image.palette[i][1] = chunk[3 * i + 1];
+        image.palette[i][2] = chunk[3 * i + 2];
+        image.palette[i][3] = 255;
+      }
+    }
+    else if (memcmp(type, "tRNS", 4) == 0)
+    {
+      // bits of a key above the bit depth are ignored, as libpng does
+      const uint32_t mask = (1u << image.depth) - 1;
+
+      if (image.colorType == 3)
+      {
+        for (uint32_t i = 0; i < length && i < image.paletteSize; ++i) image.palette[i][3] = chunk[i];
+      }
+      else if (image.colorType == 0 && length == 2)
+      {
+        image.hasKey = true;
+        image.key[0] = static_cast<uint16_t>((chunk[0] << 8 | chunk[1]) & mask);
+      }
+      else if (image.colorType == 2 && length == 6)
+      {
+        image.hasKey = true;
+
+        for (uint32_t i = 0; i < 3; ++i) image.key[i] = static_cast<uint16_t>((chunk[2 * i] << 8 | chunk[2 * i + 1]) & mask);
+      }
+    }
+    else if (memcmp(type, "IEND", 4) == 0)
+    {
+      break;
+    }
+    else if ((type[0] & 0x20) == 0)
+    {
+      // an unknown chunk that is critical to the image
+      return false;
+    }
+  }
+
+  return header && !image.stream.empty() && (image.colorType != 3 || image.paletteSize > 0);
+}
+
+// origin and spacing of the pixels of one Adam7 pass, an image without interlacing has a single pass over all of them
+struct Pass
+{
+  UINT x;
+  UINT y;
+  UINT dx;
+  UINT dy;
+};
+
+static const Pass s_Adam7[7] = { { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+static const Pass s_Sequential[1] = { { 0, 0, 1, 1 } };
+
+static inline UINT PassWidth(const PngImage& image, const Pass& pass) noexcept { return (image.width > pass.x) ? (image.width - pass.x + pass.dx - 1) / pass.dx : 0; }
+static inline UINT PassHeight(const PngImage& image, const Pass& pass) noexcept { return (image.height > pass.y) ? (image.height - pass.y + pass.dy - 1) / pass.dy : 0; }
+static inline size_t RowBytes(const PngImage& image, const UINT width) noexcept { return (static_cast<size_t>(width) * image.channels * image.depth + 7) / 8; }
+
+// a 3 byte pixel is moved as 2 bytes and 1, copying it through memory would stall store forwarding
+template <size_t Bpp>
+static inline __m128i LoadPixel(const BYTE* p) noexcept
+{
+  if (Bpp == 8) return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+
+  uint32_t value;
+
+  if (Bpp == 4)
+  {
+    memcpy(&value, p, 4);
+  }
+  else
+  {
+    uint16_t low;
+
+    memcpy(&low, p, 2);
+    value = low | static_cast<uint32_t>(p[2]) << 16;
+  }
+
+  return _mm_cvtsi32_si128(static_cast<int>(value));
+}
+
+template <size_t Bpp>
+static inline void StorePixel(BYTE* p, const __m128i pixel) noexcept
+{
+  if (Bpp == 8)
+  {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), pixel);
+
+    return;
+  }
+
+  const uint32_t value = static_cast<uint32_t>(_mm_cvtsi128_si32(pixel));
+
+  if (Bpp == 4)
+  {
+    memcpy(p, &value, 4);
+  }
+  else
+  {
+    const uint16_t low = static_cast<uint16_t>(value);
+
+    memcpy(p, &low, 2);
+    p[2] = static_cast<BYTE>(value >> 16);
+  }
+}
+
+// the filters of 3, 4 and 8 byte pixels keep a whole pixel in a register, the pixel before it is its only dependency
+template <size_t Bpp>
+static void UnfilterSub(BYTE* row, const size_t rowBytes) noexcept
+{
+  __m128i a = _mm_setzero_si128();
+
+  for (size_t i = 0; i < rowBytes; i += Bpp)
+  {
+    a = _mm_add_epi8(a, LoadPixel<Bpp>(row + i));
+    StorePixel<Bpp>(row + i, a);
+  }
+}
+
+template <size_t Bpp>
+static void UnfilterAverage(BYTE* row, const BYTE* prev, const size_t rowBytes) noexcept
+{
+  const __m128i one = _mm_set1_epi8(1);
+
+  __m128i a = _mm_setzero_si128();
+
+  for (size_t i = 0; i < rowBytes; i += Bpp)
+  {
+    const __m128i b = LoadPixel<Bpp>(prev + i);
+    // _mm_avg_epu8 rounds up, the average of the filter rounds down
+    const __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+
+    a = _mm_add_epi8(LoadPixel<Bpp>(row + i), average);
+    StorePixel<Bpp>(row + i, a);
+  }
+}
+
+static inline __m128i Select(const __m128i mask, const __m128i a, const __m128i b) noexcept { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+template <size_t Bpp>
+static void UnfilterPaeth(BYTE* row, const BYTE* prev, const size_t rowBytes) noexcept
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i low = _mm_set1_epi16(0xFF);
+
+  // the left, upper and upper left neighbours as 16 bit lanes
+  __m128i a = zero;
+  __m128i c = zero;
+
+  for (size_t i = 0; i < rowBytes; i += Bpp)
+  {
+    const __m128i b = _mm_unpacklo_epi8(LoadPixel<Bpp>(prev + i), zero);
+    const __m128i x = _mm_unpacklo_epi8(LoadPixel<Bpp>(row + i), zero);
+
+    // distances of the estimate a + b - c from a, b and c
+    const __m128i pa = _mm_sub_epi16(b, c);
+    const __m128i pb = _mm_sub_epi16(a, c);
+    const __m128i pc = _mm_add_epi16(pa, pb);
+    const __m128i da = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+    const __m128i db = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+    const __m128i dc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+    const __m128i smallest = _mm_min_epi16(dc, _mm_min_epi16(da, db));
+
+    // ties prefer a over b over c
+    const __m128i nearest = Select(_mm_cmpeq_epi16(smallest, da), a, Select(_mm_cmpeq_epi16(smallest, db), b, c));
+
+    a = _mm_and_si128(_mm_add_epi16(x, nearest), low);
+    StorePixel<Bpp>(row + i, _mm_packus_epi16(a, a));
+
+    c = b;
+  }
+}
+
+static inline BYTE Paeth(const int a, const int b, const int c) noexcept
+{
+  const int da = abs(b - c);
+  const int db = abs(a - c);
+  const int dc = abs(a + b - 2 * c);
+
+  if (da <= db && da <= dc) return static_cast<BYTE>(a);
+
+  return static_cast<BYTE>((db <= dc) ? b : c);
+}
+
+// reverses the filter of row in place, prev is the unfiltered row above or zeros for the first row of a pass
+static bool Unfilter(const BYTE filter, BYTE* row, const BYTE* prev, const size_t rowBytes, const size_t bpp) noexcept
+{
+  switch (filter)
+  {
+  case 0:
+    return true;
+
+  case 1:
+    if (bpp == 4) UnfilterSub<4>(row, rowBytes);
+    else if (bpp == 8) UnfilterSub<8>(row, rowBytes);
+    else if (bpp == 3) UnfilterSub<3>(row, rowBytes);
+    else for (size_t i = bpp; i < rowBytes; ++i) row[i] += row[i - bpp];
+
+    return true;
+
+  case 2:
+  {
+    size_t i = 0;
+
+    for (; i + 16 <= rowBytes; i += 16)
+    {
+      const __m128i sum = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i)));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), sum);
+    }
+
+    for (; i < rowBytes; ++i) row[i] += prev[i];
+
+    return true;
+  }
+
+  case 3:
+    if (bpp == 4) UnfilterAverage<4>(row, prev, rowBytes);
+    else if (bpp == 8) UnfilterAverage<8>(row, prev, rowBytes);
+    else if (bpp == 3) UnfilterAverage<3>(row, prev, rowBytes);
+    else
+    {
+      for (size_t i = 0; i < bpp; ++i) row[i] += prev[i] >> 1;
+      for (size_t i = bpp; i < rowBytes; ++i) row[i] += static_cast<BYTE>((row[i - bpp] + prev[i]) >> 1);
+    }
+
+    return true;
+
+  case 4:
+    if (bpp == 4) UnfilterPaeth<4>(row, prev, rowBytes);
+    else if (bpp == 8) UnfilterPaeth<8>(row, prev, rowBytes);
+    else if (bpp == 3) UnfilterPaeth<3>(row, prev, rowBytes);
+    else
+    {
+      for (size_t i = 0; i < bpp; ++i) row[i] += prev[i];
+      for (size_t i = bpp; i < rowBytes; ++i) row[i] += Paeth(row[i - bpp], prev[i], prev[i - bpp]);
+    }
+
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+// converts an unfiltered row of width pixels to RGBA, the pixels are written stride bytes apart
+static void ExpandRow(const PngImage& image, const BYTE* row, const UINT width, BYTE* pixels, const size_t stride) noexcept
+{
+  if (image.depth == 16 && image.colorType == 6 && stride == 8)
+  {
+    // only the big endian samples are swapped
+    UINT x = 0;
+
+    for (; x + 2 <= width; x += 2, pixels += 16, row += 16)
+    {
+      const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_or_si128(_mm_slli_epi16(samples, 8), _mm_srli_epi16(samples, 8)));
+    }
+
+    for (; x < width; ++x, pixels += 8, row += 8)
+    {
+      for (uint32_t i = 0; i < 8; i += 2)
+      {
+        pixels[i] = row[i + 1];
+        pixels[i + 1] = row[i];
+      }
+    }
+
+    return;
+  }
+
+  if (image.depth == 16)
+  {
+    for (UINT x = 0; x < width; ++x, pixels += stride, row += 2 * image.channels)
+    {
+      uint16_t sample[4];
+
+      for (uint32_t i = 0; i < image.channels; ++i) sample[i] = static_cast<uint16_t>(row[2 * i] << 8 | row[2 * i + 1]);
+
+      uint16_t rgba[4] = { sample[0], sample[0], sample[0], 0xFFFF };
+
+      if (image.colorType == 2 || image.colorType == 6)
+      {
+        rgba[1] = sample[1];
+        rgba[2] = sample[2];
+      }
+
+      if (image.colorType == 4) rgba[3] = sample[1];
+      else if (image.colorType == 6) rgba[3] = sample[3];
+      else if (image.hasKey && rgba[0] == image.key[0] && (image.colorType == 0 || (rgba[1] == image.key[1] && rgba[2] == image.key[2]))) rgba[3] = 0;
+
+      memcpy(pixels, rgba, sizeof(rgba));
+    }
+
+    return;
+  }
+
+  if (image.depth < 8)
+  {
+    const uint32_t mask = (1u << image.depth) - 1;
+
+    for (UINT x = 0; x < width; ++x, pixels += stride)
+    {
+      const size_t bit = static_cast<size_t>(x) * image.depth;
+      const uint32_t sample = (row[bit / 8] >> (8 - image.depth - bit % 8)) & mask;
+
+      if (image.colorType == 3)
+      {
+        static const BYTE missing[4] = { 0, 0, 0, 255 };
+
+        memcpy(pixels, (sample < image.paletteSize) ? image.palette[sample] : missing, 4);
+      }
+      else
+      {
+        const BYTE gray = static_cast<BYTE>(sample * 255 / mask);
+
+        pixels[0] = pixels[1] = pixels[2] = gray;
+        pixels[3] = (image.hasKey && sample == image.key[0]) ? 0 : 255;
+      }
+    }
+
+    return;
+  }
+
+  switch (image.colorType)
+  {
+  case 6:
+    if (stride == 4) memcpy(pixels, row, 4 * static_cast<size_t>(width));
+    else for (UINT x = 0; x < width; ++x, pixels += stride, row += 4) memcpy(pixels, row, 4);
+
+    break;
+
+  case 2:
+    for (UINT x = 0; x < width; ++x, pixels += stride, row += 3)
+    {
+      pixels[0] = row[0];
+      pixels[1] = row[1];
+      pixels[2] = row[2];
+      pixels[3] = (image.hasKey && row[0] == image.key[0] && row[1] == image.key[1] && row[2] == image.key[2]) ? 0 : 255;
+    }
+
+    break;
+
+  case 4:
+    for (UINT x = 0; x < width; ++x, pixels += stride, row += 2)
+    {
+      pixels[0] = pixels[1] = pixels[2] = row[0];
+      pixels[3] = row[1];
+    }
+
+    break;
+
+  case 3:
+    for (UINT x = 0; x < width; ++x, pixels += stride)
+    {
+      static const BYTE missing[4] = { 0, 0, 0, 255 };
+
+      memcpy(pixels, (row[x] < image.paletteSize) ? image.palette[row[x]] : missing, 4);
+    }
+
+    break;
+
+  default:
+    for (UINT x = 0; x < width; ++x, pixels += stride)
+    {
+      pixels[0] = pixels[1] = pixels[2] = row[x];
+      pixels[3] = (image.hasKey && row[x] == image.key[0]) ? 0 : 255;
+    }
+
+    break;
+  }
+}
+
+bool PngDecoder::IsPng(const BYTE* data, size_t size) noexcept
+{
+  return size >= sizeof(s_Signature) && memcmp(data, s_Signature, sizeof(s_Signature)) == 0;
+}
+
+bool PngDecoder::ReadInfo(const BYTE* data, size_t size, PngInfo& info) noexcept
+{
+  PngImage image;
+
+  if (!ParseImage(data, size, image, true)) return false;
+
+  info.Width = image.width;
+  info.Height = image.height;
+  info.Format = (image.depth == 16) ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+  info.BytesPerPixel = (image.depth == 16) ? 8 : 4;
+
+  return true;
+}
+
+bool PngDecoder::Decode(const BYTE* data, size_t size, BYTE* pixels, size_t rowPitch) noexcept
+{
+  try
+  {
+    PngImage image;
+
+    if (!ParseImage(data, size, image, false)) return false;
+
+    const Pass* passes = image.interlaced ? s_Adam7 : s_Sequential;
+    const size_t passCount = image.interlaced ? 7 : 1;
+    const size_t pixelSize = (image.depth == 16) ? 8 : 4;
+    // bytes per pixel of the filters, at least one for images with less than 8 bits per pixel
+    const size_t bpp = std::max<size_t>(1, image.channels * image.depth / 8);
+
+    // every row of every pass starts with its filter type
+    size_t filteredSize = 0;
+
+    for (size_t p = 0; p < passCount; ++p)
+    {
+      const UINT width = PassWidth(image, passes[p]);
+
+      if (width) filteredSize += PassHeight(image, passes[p]) * (RowBytes(image, width) + 1);
+    }
+
+    // left uninitialized, Inflate writes every byte
+    std::unique_ptr<BYTE[]> filtered(new BYTE[filteredSize + 8]);
+    std::vector<BYTE> zeros(RowBytes(image, image.width), 0);
+
+    if (!Inflate(image.stream.data(), image.stream.size(), filtered.get(), filteredSize)) return false;
+
+    BYTE* row = filtered.get();
+
+    for (size_t p = 0; p < passCount; ++p)
+    {
+      const Pass& pass = passes[p];
+      const UINT width = PassWidth(image, pass);
+      const UINT height = PassHeight(image, pass);
+      const size_t rowBytes = RowBytes(image, width);
+      const BYTE* prev = zeros.data();
+
+      if (width == 0) continue;
+
+      for (UINT y = 0; y < height; ++y, row += rowBytes + 1)
+      {
+        if (!Unfilter(row[0], row + 1, prev, rowBytes, bpp)) return false;
+
+        ExpandRow(image, row + 1, width, pixels + (pass.y + static_cast<size_t>(y) * pass.dy) * rowPitch + pass.x * pixelSize, pass.dx * pixelSize);
+
+        prev = row + 1;
+      }
+    }
+
+    return true;
+  }
+  catch (const std::bad_alloc&)
+  {
+    return false;
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// what PngDecoder::Decode writes for an image, read from its header
+struct PngInfo
+{
+  UINT Width;
+  UINT Height;
+  DXGI_FORMAT Format;     // DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_UNORM for images with 16 bit samples
+  UINT BytesPerPixel;
+};
+
+// decodes PNG images without WIC, so textures can be imported where there is no COM
+// every color type, bit depth, transparency chunk and Adam7 interlacing is expanded to RGBA
+// the zlib stream is inflated with table driven Huffman decoding, the rows are unfiltered with SSE2 where it pays off
+// the Adler-32 of the image data is verified, chunk CRCs are not, a damaged chunk fails on its structure or on the Adler-32
+class PngDecoder
+{
+public:
+  static bool IsPng(const BYTE* data, size_t size) noexcept;
+
+  static bool ReadInfo(const BYTE* data, size_t size, PngInfo& info) noexcept;
+
+  // writes Height rows of Width * BytesPerPixel bytes, each rowPitch bytes after the one before, to pixels
+  static bool Decode(const BYTE* data, size_t size, BYTE* pixels, size_t rowPitch) noexcept;
+
+private:
+  PngDecoder(void) noexcept = delete;
+  ~PngDecoder(void) noexcept = delete;
+
+};
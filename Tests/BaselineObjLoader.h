@@ -0,0 +1,14 @@
+#pragma once
+
+// ObjLoader.cpp of the baseline, the loader the engine had before OBJLoader, checked in unchanged but for the name of the class
+// it reads triangles of "v/vt" corners (a "v/vt/vn" corner reads as "v/vt") with single blanks between the tokens and ignores everything but v, vt and f
+// anything else, n-gons, negative indices, "v" or "v//vn" corners, tabs or invalid indices, is undefined behaviour, it must only read the files it was written for
+// every corner is a vertex of its own, the indices count up from 0
+class BaselineObjLoader
+{
+public:
+  static void Load(const std::string& filename, Vertex*& outVertices, int& vcount, DWORD*& outIndices, int& icount) noexcept;
+
+  BaselineObjLoader(void) noexcept = delete;
+  ~BaselineObjLoader(void) noexcept = delete;
+};
@@ -0,0 +1,272 @@
+#include "Test.h"
+#include "../BlockCompressor.h"
+#include "../PngDecoder.h"
+
+static const DXGI_FORMAT s_Formats[] = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC7_UNORM };
+static const BlockCompressionQuality s_Qualities[] = { BlockCompressionQuality::Fast, BlockCompressionQuality::Normal, BlockCompressionQuality::Best };
+
+// RGBA8 pixels without padding
+struct Image
+{
+  UINT Width = 0;
+  UINT Height = 0;
+  std::vector<BYTE> Pixels;
+};
+
+// a small hash of a pixel position, the noise of the synthetic images and the garbage in the X of BGRX
+static uint32_t Noise(const UINT x, const UINT y, const uint32_t seed) noexcept
+{
+  uint32_t h = x * 0x9E3779B1u ^ y * 0x85EBCA77u ^ seed * 0xC2B2AE3Du;
+
+  h ^= h >> 15;
+  h *= 0x2C1B3C6Du;
+  h ^= h >> 12;
+
+  return h;
+}
+
+// smooth waves of color and alpha with a little noise, a pixel only depends on its position so a crop is the same image
+static Image Waves(const UINT width, const UINT height)
+{
+  Image image{ width, height, std::vector<BYTE>(static_cast<size_t>(width) * height * 4) };
+
+  const auto clamp = [](const double value) { return static_cast<BYTE>(std::min(255.0, std::max(0.0, value))); };
+
+  for (UINT y = 0; y < height; ++y)
+  {
+    for (UINT x = 0; x < width; ++x)
+    {
+      BYTE* pixel = image.Pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+      const int noise = static_cast<int>(Noise(x, y, 1) % 7) - 3;
+
+      pixel[0] = clamp(128 + 100 * sin(x * 0.11 + y * 0.05) + noise);
+      pixel[1] = clamp(128 + 90 * sin(y * 0.07) * cos(x * 0.04) - noise);
+      pixel[2] = clamp(128 + 80 * cos((x - y) * 0.06) + noise);
+      pixel[3] = clamp(128 + 120 * cos(y * 0.09 - x * 0.03) + noise);
+    }
+  }
+
+  return image;
+}
+
+// a 256 x 256 crop of a shipped texture, it has alpha
+static Image Barrier(void)
+{
+  std::ifstream file("barrier.png", std::ios::binary);
+  const std::vector<BYTE> png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  PngInfo info;
+  Image image{ 256, 256, std::vector<BYTE>(256 * 256 * 4) };
+
+  if (!PngDecoder::ReadInfo(png.data(), png.size(), info) || info.Format != DXGI_FORMAT_R8G8B8A8_UNORM || info.Width < 640 || info.Height < 640) return {};
+
+  std::vector<BYTE> pixels(static_cast<size_t>(info.Width) * info.Height * 4);
+
+  if (!PngDecoder::Decode(png.data(), png.size(), pixels.data(), info.Width * 4)) return {};
+
+  for (UINT y = 0; y < image.Height; ++y) memcpy(image.Pixels.data() + y * image.Width * 4, pixels.data() + ((384 + y) * info.Width + 384) * 4, image.Width * 4);
+
+  return image;
+}
+
+static Image Opaque(Image image)
+{
+  for (size_t i = 3; i < image.Pixels.size(); i += 4) image.Pixels[i] = 255;
+
+  return image;
+}
+
+// the RGBA8 pixels of image in source format, BGRX8 gets garbage in X that the compressor has to ignore
+static std::vector<BYTE> Convert(const Image& image, const DXGI_FORMAT source)
+{
+  std::vector<BYTE> pixels(image.Pixels);
+
+  if (source == DXGI_FORMAT_R8G8B8A8_UNORM) return pixels;
+
+  for (size_t i = 0; i < pixels.size(); i += 4)
+  {
+    std::swap(pixels[i], pixels[i + 2]);
+
+    if (source == DXGI_FORMAT_B8G8R8X8_UNORM) pixels[i + 3] = static_cast<BYTE>(Noise(static_cast<UINT>(i), 0, 2));
+  }
+
+  return pixels;
+}
+
+static std::vector<BYTE> Compress(const std::vector<BYTE>& pixels, const UINT width, const UINT height, const DXGI_FORMAT source, const DXGI_FORMAT target, const BlockCompressionQuality quality, const UINT threads = 0)
+{
+  std::vector<BYTE> blocks(static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * BlockCompressor::BlockSize(target));
+
+  CHECK(BlockCompressor::Compress(pixels.data(), width, height, source, target, quality, blocks.data(), threads));
+
+  return blocks;
+}
+
+static std::vector<BYTE> Decompress(const std::vector<BYTE>& blocks, const UINT width, const UINT height, const DXGI_FORMAT format)
+{
+  std::vector<BYTE> pixels(static_cast<size_t>(width) * height * 4);
+
+  CHECK(BlockCompressor::Decompress(blocks.data(), width, height, format, pixels.data()));
+
+  return pixels;
+}
+
+// compresses image from every source format, they all have to give the same blocks, and returns the PSNR of the decoded pixels
+// opaque images are also compressed from BGRX8 and measured on color only, BC1 is only used for them since it drops alpha
+static double RoundTrip(const Image& image, const bool opaque, const DXGI_FORMAT target, const BlockCompressionQuality quality)
+{
+  const std::vector<BYTE> blocks = Compress(image.Pixels, image.Width, image.Height, DXGI_FORMAT_R8G8B8A8_UNORM, target, quality);
+
+  CHECK(Compress(Convert(image, DXGI_FORMAT_B8G8R8A8_UNORM), image.Width, image.Height, DXGI_FORMAT_B8G8R8A8_UNORM, target, quality) == blocks);
+
+  const std::vector<BYTE> pixels = Decompress(blocks, image.Width, image.Height, target);
+  const size_t count = static_cast<size_t>(image.Width) * image.Height;
+
+  if (!opaque) return BlockCompressor::PSNR(image.Pixels.data(), DXGI_FORMAT_R8G8B8A8_UNORM, pixels.data(), count);
+
+  const std::vector<BYTE> bgrx = Convert(image, DXGI_FORMAT_B8G8R8X8_UNORM);
+
+  CHECK(Compress(bgrx, image.Width, image.Height, DXGI_FORMAT_B8G8R8X8_UNORM, target, quality) == blocks);
+
+  // the decoder writes opaque alpha for opaque blocks
+  for (size_t i = 3; i < pixels.size(); i += 4) CHECK(pixels[i] == 255);
+
+  return BlockCompressor::PSNR(bgrx.data(), DXGI_FORMAT_B8G8R8X8_UNORM, pixels.data(), count);
+}
+
+TEST(BlockCompressorMeetsItsPsnrFloors)
+{
+  const Image waves = Waves(128, 128);
+  const Image barrier = Barrier();
+
+  CHECK(!barrier.Pixels.empty());
+
+  // the lowest PSNR in dB each quality may give, a little below what it gives now
+  static const struct
+  {
+    const char* Name;
+    bool Opaque;
+    DXGI_FORMAT Format;
+    double Floors[3];
+  } s_Cases[] =
+  {
+    { "waves", true, DXGI_FORMAT_BC1_UNORM, { 35.0, 35.5, 35.5 } },
+    { "waves", true, DXGI_FORMAT_BC3_UNORM, { 35.0, 35.5, 35.5 } },
+    { "waves", true, DXGI_FORMAT_BC7_UNORM, { 37.0, 37.0, 41.5 } },
+    { "waves", false, DXGI_FORMAT_BC3_UNORM, { 36.0, 36.5, 36.5 } },
+    { "waves", false, DXGI_FORMAT_BC7_UNORM, { 34.5, 34.5, 34.5 } },
+    { "barrier", true, DXGI_FORMAT_BC1_UNORM, { 45.0, 45.5, 48.0 } },
+    { "barrier", true, DXGI_FORMAT_BC3_UNORM, { 45.0, 45.5, 48.0 } },
+    { "barrier", true, DXGI_FORMAT_BC7_UNORM, { 52.0, 52.5, 57.0 } },
+    { "barrier", false, DXGI_FORMAT_BC3_UNORM, { 46.0, 47.0, 49.0 } },
+    { "barrier", false, DXGI_FORMAT_BC7_UNORM, { 53.5, 54.0, 58.0 } },
+  };
+
+  for (const auto& test : s_Cases)
+  {
+    const Image& source = (test.Name[0] == 'w') ? waves : barrier;
+    const Image image = test.Opaque ? Opaque(source) : source;
+
+    double previous = 0.0;
+
+    for (UINT q = 0; q < 3; ++q)
+    {
+      const double psnr = RoundTrip(image, test.Opaque, test.Format, s_Qualities[q]);
+
+      CHECK(psnr >= test.Floors[q]);
+
+      // a better quality is never noticeably worse
+      CHECK(psnr >= previous - 0.05);
+
+      previous = psnr;
+    }
+  }
+}
+
+// image with its last column and row repeated up to whole blocks, what Compress has to encode partial blocks as
+static Image Extend(const Image& image)
+{
+  Image extended{ (image.Width + 3) & ~3u, (image.Height + 3) & ~3u, {} };
+
+  for (UINT y = 0; y < extended.Height; ++y)
+  {
+    for (UINT x = 0; x < extended.Width; ++x)
+    {
+      const BYTE* pixel = image.Pixels.data() + (static_cast<size_t>(std::min(y, image.Height - 1)) * image.Width + std::min(x, image.Width - 1)) * 4;
+
+      extended.Pixels.insert(extended.Pixels.end(), pixel, pixel + 4);
+    }
+  }
+
+  return extended;
+}
+
+TEST(BlockCompressorEncodesPartialBlocks)
+{
+  // the lowest PSNR in dB of BC1, BC3 and BC7 at any quality, a few pixels of waves are measured so the floors are lower than those of whole images
+  static const double s_Floors[] = { 30.0, 30.0, 31.0 };
+
+  for (const auto& size : { std::make_pair(1u, 1u), std::make_pair(5u, 5u), std::make_pair(13u, 7u), std::make_pair(3u, 9u) })
+  {
+    for (const bool opaque : { true, false })
+    {
+      const Image image = opaque ? Opaque(Waves(size.first, size.second)) : Waves(size.first, size.second);
+      const Image extended = Extend(image);
+
+      for (UINT f = 0; f < 3; ++f)
+      {
+        const DXGI_FORMAT format = s_Formats[f];
+
+        if (format == DXGI_FORMAT_BC1_UNORM && !opaque) continue;
+
+        for (const auto quality : s_Qualities)
+        {
+          const std::vector<BYTE> blocks = Compress(image.Pixels, image.Width, image.Height, DXGI_FORMAT_R8G8B8A8_UNORM, format, quality);
+
+          CHECK(blocks == Compress(extended.Pixels, extended.Width, extended.Height, DXGI_FORMAT_R8G8B8A8_UNORM, format, quality));
+
+          // the decoder only writes the pixels inside the image
+          const std::vector<BYTE> pixels = Decompress(blocks, image.Width, image.Height, format);
+          const std::vector<BYTE> all = Decompress(blocks, extended.Width, extended.Height, format);
+
+          for (UINT y = 0; y < image.Height; ++y) CHECK(std::equal(pixels.begin() + y * image.Width * 4, pixels.begin() + (y + 1) * image.Width * 4, all.begin() + y * extended.Width * 4));
+
+          CHECK(RoundTrip(image, opaque, format, quality) >= s_Floors[f]);
+        }
+      }
+    }
+  }
+}
+
+TEST(BlockCompressorGivesTheSameBlocksOnAnyNumberOfThreads)
+{
+  const Image image = Waves(256, 64);
+
+  for (const DXGI_FORMAT format : s_Formats)
+  {
+    const std::vector<BYTE> blocks = Compress(image.Pixels, image.Width, image.Height, DXGI_FORMAT_R8G8B8A8_UNORM, format, BlockCompressionQuality::Normal, 1);
+
+    for (const UINT threads : { 0u, 2u, 3u, 64u }) CHECK(Compress(image.Pixels, image.Width, image.Height, DXGI_FORMAT_R8G8B8A8_UNORM, format, BlockCompressionQuality::Normal, threads) == blocks);
+  }
+}
+
+TEST(BlockCompressorRejectsWhatItCannotDo)
+{
+  const Image image = Waves(8, 8);
+  BYTE blocks[4 * 16] = {};
+  BYTE pixels[8 * 8 * 4] = {};
+
+  CHECK(!BlockCompressor::Compress(image.Pixels.data(), 0, 8, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_BC1_UNORM, BlockCompressionQuality::Fast, blocks));
+  CHECK(!BlockCompressor::Compress(image.Pixels.data(), 8, 8, DXGI_FORMAT_R16G16B16A16_UNORM, DXGI_FORMAT_BC1_UNORM, BlockCompressionQuality::Fast, blocks));
+  CHECK(!BlockCompressor::Compress(image.Pixels.data(), 8, 8, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_BC2_UNORM, BlockCompressionQuality::Fast, blocks));
+
+  // BC7 blocks of mode 0 and of no mode at all are not decoded, mode 1 and 6 are
+  blocks[0] = 0x01;
+  CHECK(!BlockCompressor::Decompress(blocks, 4, 4, DXGI_FORMAT_BC7_UNORM, pixels));
+  blocks[0] = 0x00;
+  CHECK(!BlockCompressor::Decompress(blocks, 4, 4, DXGI_FORMAT_BC7_UNORM, pixels));
+  blocks[0] = 0x02;
+  CHECK(BlockCompressor::Decompress(blocks, 4, 4, DXGI_FORMAT_BC7_UNORM, pixels));
+  blocks[0] = 0x40;
+  CHECK(BlockCompressor::Decompress(blocks, 4, 4, DXGI_FORMAT_BC7_UNORM, pixels));
+}
@@ -0,0 +1,86 @@
+#include "Test.h"
+#include "../ImportCache.h"
+#include "../ObjLoader.h"
+
+static std::vector<std::string> Libraries(const std::string& content)
+{
+  std::vector<std::string> libraries;
+
+  OBJLoader::Libraries(content.data(), content.size(), libraries);
+
+  return libraries;
+}
+
+static std::string MeshArtifact(const std::string& filename)
+{
+  std::string artifact;
+
+  CHECK(ImportCache::ArtifactFileName(filename, 1, ".mesh", artifact, &OBJLoader::Libraries));
+
+  return artifact;
+}
+
+static const char s_Mesh[] = "mtllib test_import.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl red\nf 1 2 3\n";
+
+TEST(ObjLoaderListsMaterialLibraries)
+{
+  CHECK(Libraries("").empty());
+  CHECK(Libraries("v 0 0 0\nusemtl a\n# mtllib a.mtl\nmtllibs a.mtl\n").empty());
+  CHECK(Libraries("mtllib a.mtl") == std::vector<std::string>({ "a.mtl" }));
+  CHECK(Libraries("mtllib a.mtl\r\n  mtllib\tb.mtl  c/d.mtl \r\nv 0 0 0\nmtllib e.mtl\n") == std::vector<std::string>({ "a.mtl", "b.mtl", "c/d.mtl", "e.mtl" }));
+}
+
+TEST(ImportCacheKeysMeshesByTheirMaterialLibraries)
+{
+  const TemporaryFile mesh("test_import.obj", s_Mesh);
+
+  const std::string missing = MeshArtifact(mesh.Name());
+
+  std::string red;
+  std::string blue;
+
+  {
+    const TemporaryFile library("test_import.mtl", "newmtl red\nmap_Kd red.png\n");
+
+    red = MeshArtifact(mesh.Name());
+
+    CHECK(red == MeshArtifact(mesh.Name()));
+  }
+  {
+    const TemporaryFile library("test_import.mtl", "newmtl red\nmap_Kd blue.png\n");
+
+    blue = MeshArtifact(mesh.Name());
+  }
+
+  CHECK(red != missing);
+  CHECK(blue != missing);
+  CHECK(red != blue);
+
+  // without dependencies only the content of the source counts
+  std::string plain;
+
+  {
+    const TemporaryFile library("test_import.mtl", "newmtl red\nmap_Kd red.png\n");
+
+    CHECK(ImportCache::ArtifactFileName(mesh.Name(), 1, ".mesh", plain));
+  }
+
+  std::string unchanged;
+
+  CHECK(ImportCache::ArtifactFileName(mesh.Name(), 1, ".mesh", unchanged));
+  CHECK(plain == unchanged);
+}
+
+TEST(ImportCacheKeysMeshesByTheirDirectory)
+{
+  CreateDirectoryA("test_import", nullptr);
+
+  {
+    const TemporaryFile here("test_import.obj", s_Mesh);
+    const TemporaryFile there("test_import/test_import.obj", s_Mesh);
+
+    CHECK(MeshArtifact(here.Name()) != MeshArtifact(there.Name()));
+  }
+
+  RemoveDirectoryA("test_import");
+}
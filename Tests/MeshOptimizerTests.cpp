@@ -0,0 +1,140 @@
+#include "Test.h"
+#include "ObjWriter.h"
+#include "../ObjLoader.h"
+#include "../MeshOptimizer.h"
+
+// the triangles of an index list rotated to start at their smallest index and sorted, the winding is kept
+static std::vector<std::array<DWORD, 3>> Triangles(const std::vector<DWORD>& indices)
+{
+  std::vector<std::array<DWORD, 3>> triangles;
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    std::array<DWORD, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+
+    std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+
+    triangles.push_back(triangle);
+  }
+
+  std::sort(triangles.begin(), triangles.end());
+
+  return triangles;
+}
+
+// optimizes indices the way a mesh is cooked, the result has to draw every triangle of the input exactly once
+static void CheckPermutation(const std::vector<Vertex>& vertices, const std::vector<DWORD>& indices)
+{
+  std::vector<DWORD> optimized(indices);
+
+  MeshOptimizer::OptimizeVertexCache(optimized.data(), optimized.size(), vertices.size());
+
+  CHECK(Triangles(optimized) == Triangles(indices));
+
+  MeshOptimizer::OptimizeOverdraw(optimized.data(), optimized.size(), vertices.data(), vertices.size(), 1.05f);
+
+  CHECK(optimized.size() == indices.size());
+  CHECK(Triangles(optimized) == Triangles(indices));
+}
+
+// a closed 2 x 4 x 6 box of size x size quads per side, the sides further out come first in overdraw order
+static void Box(UINT size, std::vector<Vertex>& vertices, std::vector<DWORD>& indices)
+{
+  static const XMFLOAT3 s_Axes[6][3] =
+  {
+    { {  1, 0, 0 }, { 0, 1, 0 }, { 0, 0,  1 } },
+    { { -1, 0, 0 }, { 0, 1, 0 }, { 0, 0, -1 } },
+    { { 0,  1, 0 }, { 0, 0, 1 }, {  1, 0, 0 } },
+    { { 0, -1, 0 }, { 0, 0, 1 }, { -1, 0, 0 } },
+    { { 0, 0,  1 }, { 1, 0, 0 }, { 0,  1, 0 } },
+    { { 0, 0, -1 }, { 1, 0, 0 }, { 0, -1, 0 } },
+  };
+
+  for (const auto& axes : s_Axes)
+  {
+    const DWORD base = static_cast<DWORD>(vertices.size());
+
+    for (UINT y = 0; y <= size; ++y)
+    {
+      for (UINT x = 0; x <= size; ++x)
+      {
+        const float u = 2.0f * x / size - 1.0f;
+        const float v = 2.0f * y / size - 1.0f;
+
+        Vertex vertex = {};
+        vertex.Position = { axes[0].x + u * axes[1].x + v * axes[2].x, 2.0f * (axes[0].y + u * axes[1].y + v * axes[2].y), 3.0f * (axes[0].z + u * axes[1].z + v * axes[2].z) };
+
+        vertices.push_back(vertex);
+      }
+    }
+
+    for (UINT y = 0; y < size; ++y)
+    {
+      for (UINT x = 0; x < size; ++x)
+      {
+        const DWORD corner = base + y * (size + 1) + x;
+
+        indices.insert(indices.end(), { corner, corner + 1, corner + size + 1, corner + 1, corner + size + 2, corner + size + 1 });
+      }
+    }
+  }
+}
+
+TEST(MeshOptimizerKeepsEveryTriangleOfShippedMeshes)
+{
+  OBJLoader loader;
+
+  for (const auto* filename : { "plane.obj", "barrier.obj", "wall.obj", "floor.obj" })
+  {
+    CHECK(loader.Import(filename));
+
+    for (const auto& submesh : loader.Submeshes())
+    {
+      const std::vector<DWORD> indices(loader.Indices().begin() + submesh.IndexStart, loader.Indices().begin() + submesh.IndexStart + submesh.IndexCount);
+
+      CheckPermutation(loader.Vertices(), indices);
+    }
+  }
+}
+
+TEST(MeshOptimizerKeepsEveryTriangleOfGrids)
+{
+  OBJLoader loader;
+
+  for (const UINT size : { 1u, 2u, 16u, 100u })
+  {
+    const TemporaryFile file("test_grid.obj", ObjWriter::Grid(size, ObjCorner::Position, false, false, 0));
+
+    CHECK(loader.Import(file.Name()));
+
+    CheckPermutation(loader.Vertices(), loader.Indices());
+  }
+}
+
+TEST(OptimizeOverdrawKeepsTrianglesBeforeTheFirstHardBoundary)
+{
+  std::vector<Vertex> vertices;
+  std::vector<DWORD> cacheOrder;
+
+  Box(16, vertices, cacheOrder);
+
+  MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), cacheOrder.size(), vertices.size());
+
+  // a first triangle that reuses a vertex misses the cache less than 3 times and is no hard boundary of its own
+  const std::vector<std::vector<DWORD>> firsts = { {}, { 0, 0, 1 }, { 0, 1, 1 }, { 2, 2, 2 } };
+
+  for (const auto& first : firsts)
+  {
+    std::vector<DWORD> indices(first);
+
+    indices.insert(indices.end(), cacheOrder.begin(), cacheOrder.end());
+
+    std::vector<DWORD> optimized(indices);
+
+    MeshOptimizer::OptimizeOverdraw(optimized.data(), optimized.size(), vertices.data(), vertices.size(), 1.05f);
+
+    // the box is written from the x to the z sides, so the clusters are reordered
+    CHECK(optimized != indices);
+    CHECK(Triangles(optimized) == Triangles(indices));
+  }
+}
@@ -0,0 +1,335 @@
+#include "Test.h"
+#include "ObjWriter.h"
+#include "BaselineObjLoader.h"
+#include "ReferenceObjLoader.h"
+
+// the fast float path of OBJLoader may round the last bit differently than strtof
+static bool Near(const float a, const float b) noexcept { return fabsf(a - b) <= 1e-6f * std::max(1.0f, fabsf(a)); }
+
+static bool SameVertex(const Vertex& a, const Vertex& b) noexcept
+{
+  return Near(a.Position.x, b.Position.x) && Near(a.Position.y, b.Position.y) && Near(a.Position.z, b.Position.z) &&
+    Near(a.TexCoord.x, b.TexCoord.x) && Near(a.TexCoord.y, b.TexCoord.y) &&
+    a.Color.x == b.Color.x && a.Color.y == b.Color.y && a.Color.z == b.Color.z && a.Color.w == b.Color.w;
+}
+
+// the vertex of every index, what both loaders have to agree on whichever vertices OBJLoader welds
+static bool SameCorners(const std::vector<Vertex>& vertices, const std::vector<DWORD>& indices, const std::vector<Vertex>& corners)
+{
+  if (indices.size() != corners.size()) return false;
+
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    if (indices[i] >= vertices.size() || !SameVertex(vertices[indices[i]], corners[i])) return false;
+  }
+
+  return true;
+}
+
+// imports filename with loader and with the reference loader, both have to fail or produce the same triangles in the same submeshes
+// the reference reads n-gons and negative indices, which the baseline cannot
+static void CheckAgainstReference(OBJLoader& loader, const std::string& filename)
+{
+  std::vector<Vertex> corners;
+  std::vector<ObjSubmesh> submeshes;
+
+  const bool expected = ReferenceObjLoader::Load(filename, corners, submeshes);
+
+  CHECK(loader.Import(filename) == expected);
+
+  if (!expected) return;
+
+  CHECK(!corners.empty());
+  CHECK(loader.Vertices().size() <= corners.size());
+  CHECK(SameCorners(loader.Vertices(), loader.Indices(), corners));
+  CHECK(loader.Submeshes().size() == submeshes.size());
+
+  for (size_t s = 0; s < std::min(loader.Submeshes().size(), submeshes.size()); ++s)
+  {
+    CHECK(loader.Submeshes()[s].Material == submeshes[s].Material);
+    CHECK(loader.Submeshes()[s].IndexStart == submeshes[s].IndexStart);
+    CHECK(loader.Submeshes()[s].IndexCount == submeshes[s].IndexCount);
+  }
+}
+
+static void CheckAgainstReference(OBJLoader& loader, const std::string& filename, const std::string& content)
+{
+  const TemporaryFile file(filename, content);
+
+  CheckAgainstReference(loader, file.Name());
+}
+
+// imports filename with loader and baselineFilename, the same mesh in a form the baseline reads, with the baseline loader
+// materials is the usemtl of every triangle in file order, the baseline ignores usemtl, so loader has to give its triangles grouped by these in the order they are first used
+// without materials the whole file is a single submesh
+static void CheckFileAgainstBaseline(OBJLoader& loader, const std::string& filename, const std::string& baselineFilename, const std::vector<std::string>& materials = {})
+{
+  Vertex* vertices = nullptr;
+  DWORD* indices = nullptr;
+  int vertexCount = 0;
+  int indexCount = 0;
+
+  BaselineObjLoader::Load(baselineFilename, vertices, vertexCount, indices, indexCount);
+
+  std::vector<Vertex> corners;
+
+  for (int i = 0; i < indexCount; ++i) corners.push_back(vertices[indices[i]]);
+
+  delete[] vertices;
+  delete[] indices;
+
+  CHECK(!corners.empty());
+  CHECK(loader.Import(filename));
+
+  std::vector<std::string> names(1);
+  std::vector<UINT> triangleMaterials(corners.size() / 3, 0);
+
+  if (!materials.empty())
+  {
+    CHECK(materials.size() == triangleMaterials.size());
+
+    names.clear();
+
+    for (size_t t = 0; t < std::min(materials.size(), triangleMaterials.size()); ++t)
+    {
+      triangleMaterials[t] = static_cast<UINT>(std::find(names.begin(), names.end(), materials[t]) - names.begin());
+
+      if (triangleMaterials[t] == names.size()) names.push_back(materials[t]);
+    }
+  }
+
+  std::vector<Vertex> grouped;
+
+  CHECK(loader.Submeshes().size() == names.size());
+
+  for (UINT m = 0; m < names.size(); ++m)
+  {
+    const DWORD start = static_cast<DWORD>(grouped.size());
+
+    for (size_t t = 0; t < triangleMaterials.size(); ++t)
+    {
+      if (triangleMaterials[t] == m) grouped.insert(grouped.end(), corners.begin() + t * 3, corners.begin() + t * 3 + 3);
+    }
+
+    if (m >= loader.Submeshes().size()) continue;
+
+    CHECK(loader.Submeshes()[m].Material == names[m]);
+    CHECK(loader.Submeshes()[m].IndexStart == start);
+    CHECK(loader.Submeshes()[m].IndexCount == grouped.size() - start);
+  }
+
+  CHECK(loader.Vertices().size() <= grouped.size());
+  CHECK(SameCorners(loader.Vertices(), loader.Indices(), grouped));
+}
+
+static void CheckAgainstBaseline(OBJLoader& loader, const std::string& filename, const std::string& content, const std::vector<std::string>& materials = {})
+{
+  const TemporaryFile file(filename, content);
+
+  CheckFileAgainstBaseline(loader, file.Name(), file.Name(), materials);
+}
+
+// the usemtl of every triangle of ObjWriter::Grid
+static std::vector<std::string> GridMaterials(const UINT size, const UINT materials)
+{
+  std::vector<std::string> names;
+
+  for (UINT y = 1; y <= size; ++y) names.insert(names.end(), 2 * size, "material" + std::to_string(y % materials));
+
+  return names;
+}
+
+// collects what a streaming import passes on
+class CollectingSink : public ObjSink
+{
+public:
+  virtual bool Vertices(const Vertex* vertices, size_t count) override
+  {
+    m_Vertices.insert(m_Vertices.end(), vertices, vertices + count);
+
+    return true;
+  }
+
+  virtual bool Indices(const DWORD* indices, size_t count) override
+  {
+    m_Indices.insert(m_Indices.end(), indices, indices + count);
+
+    return true;
+  }
+
+  std::vector<Vertex> m_Vertices;
+  std::vector<DWORD> m_Indices;
+};
+
+static const char s_Triangle[] = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 0 1\nf 1/1 2/2 3/3\n";
+
+TEST(ObjLoaderMatchesBaselineOnShippedMeshes)
+{
+  OBJLoader loader;
+
+  for (const auto* filename : { "plane.obj", "barrier.obj", "wall.obj", "floor.obj" }) CheckFileAgainstBaseline(loader, filename, filename);
+}
+
+TEST(ObjLoaderMatchesBaselineOnGrids)
+{
+  OBJLoader loader;
+
+  CheckAgainstBaseline(loader, "test_grid.obj", ObjWriter::Grid(16, ObjCorner::PositionTexCoord, false, false, 0));
+  CheckAgainstBaseline(loader, "test_grid.obj", ObjWriter::Grid(16, ObjCorner::PositionTexCoordNormal, false, false, 0));
+}
+
+TEST(ObjLoaderMatchesBaselineWithCRLF)
+{
+  OBJLoader loader;
+
+  CheckAgainstBaseline(loader, "test_crlf.obj", "v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nvt 0 0\r\nvt 1 0\r\nvt 0 1\r\nf 1/1 2/2 3/3\r\n");
+  CheckAgainstBaseline(loader, "test_crlf.obj", ObjWriter::Grid(8, ObjCorner::PositionTexCoord, false, false, 0, "\r\n"));
+  CheckAgainstReference(loader, "test_crlf.obj", ObjWriter::Grid(8, ObjCorner::PositionTexCoord, false, true, 2, "\r\n"));
+}
+
+TEST(ObjLoaderMatchesBaselineWithoutTrailingNewline)
+{
+  OBJLoader loader;
+
+  CheckAgainstBaseline(loader, "test_eof.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 0 1\nf 1/1 2/2 3/3");
+  CheckAgainstBaseline(loader, "test_eof.obj", "v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nvt 0 0\r\nvt 1 0\r\nvt 0 1\r\nf 1/1 2/2 3/3\r\nf 3/3 2/2 1/1");
+  CheckAgainstBaseline(loader, "test_eof.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 0 1\nf 1/1 2/2 3/3\nv 1 1 0");
+}
+
+TEST(ObjLoaderMatchesReferenceWithNegativeIndices)
+{
+  OBJLoader loader;
+
+  CheckAgainstReference(loader, "test_negative.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 0 1\nf -3/-3 -2/-2 -1/-1\nv 1 1 0\nvt 1 1\nf -3/-2 -1/-1 -2/-3\nf 1/1 -1/-1 3/-2\n");
+
+  for (const auto corner : { ObjCorner::Position, ObjCorner::PositionTexCoord, ObjCorner::PositionNormal, ObjCorner::PositionTexCoordNormal })
+  {
+    CheckAgainstReference(loader, "test_negative.obj", ObjWriter::Grid(16, corner, true, false, 0));
+  }
+}
+
+TEST(ObjLoaderMatchesReferenceWithPolygons)
+{
+  OBJLoader loader;
+
+  // a quad, a pentagon and a hexagon in every corner format
+  CheckAgainstReference(loader, "test_polygons.obj",
+    "v 0 0 0\nv 1 0 0\nv 2 1 0\nv 1 2 0\nv 0 2 0\nv -1 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvt 0.5 0.5\nvt 0.25 0.75\nvn 0 0 1\n"
+    "f 1 2 3 4\nf 1/1 2/2 3/3 4/4 5/5\nf 1//1 2//1 3//1 4//1 5//1 6//1\nf 6/6/1 5/5/1 4/4/1 3/3/1 2/2/1 1/1/1\n");
+
+  for (const auto corner : { ObjCorner::Position, ObjCorner::PositionTexCoord, ObjCorner::PositionNormal, ObjCorner::PositionTexCoordNormal })
+  {
+    CheckAgainstReference(loader, "test_polygons.obj", ObjWriter::Grid(16, corner, false, true, 0));
+    CheckAgainstReference(loader, "test_polygons.obj", ObjWriter::Grid(16, corner, true, true, 0));
+  }
+}
+
+TEST(ObjLoaderMatchesBaselineWithMaterials)
+{
+  OBJLoader loader;
+
+  // faces before the first usemtl, a material used twice and one with blanks in its name
+  CheckAgainstBaseline(loader, "test_materials.obj",
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\n"
+    "f 1/1 2/2 3/3\nusemtl red\nf 2/2 4/4 3/3\nusemtl  dark blue \t\nf 1/1 2/2 4/4\nusemtl red\nf 3/3 2/2 1/1\n", { "", "red", "dark blue", "red" });
+  CheckAgainstBaseline(loader, "test_materials.obj", ObjWriter::Grid(16, ObjCorner::PositionTexCoord, false, false, 3), GridMaterials(16, 3));
+}
+
+TEST(ObjLoaderMatchesBaselineWithBlanksAndComments)
+{
+  OBJLoader loader;
+
+  // the baseline only reads single blanks, it reads the same mesh written plainly
+  const TemporaryFile file("test_blanks.obj",
+    "# comment\n\no object\ng group\ns off\n  v\t0 0 0\nv 1.5e0   0 0  \n\tv 0 1 0\n\nvt 0 0\nvt 1 0 0\nvt 0 1\nvn 0 0 1\n"
+    "f 1/1/1\t2/2/1  3/3/1 # a comment after the corners\n  f 3/3 2/2 1/1\t\n# f 1 2\n");
+  const TemporaryFile plain("test_plain.obj", "v 0 0 0\nv 1.5e0 0 0\nv 0 1 0\nvt 0 0\nvt 1 0 0\nvt 0 1\nvn 0 0 1\nf 1/1/1 2/2/1 3/3/1\nf 3/3 2/2 1/1\n");
+
+  CheckFileAgainstBaseline(loader, file.Name(), plain.Name());
+}
+
+TEST(ObjLoaderMatchesBaselineOnLargeFiles)
+{
+  OBJLoader loader;
+
+  // several MB, so the file is split into chunks that are parsed in parallel
+  CheckAgainstBaseline(loader, "test_large.obj", ObjWriter::Grid(400, ObjCorner::PositionTexCoord, false, false, 3), GridMaterials(400, 3));
+  CheckAgainstBaseline(loader, "test_large.obj", ObjWriter::Grid(400, ObjCorner::PositionTexCoordNormal, false, false, 0, "\r\n"));
+
+  // negative indices reach across the chunks
+  CheckAgainstReference(loader, "test_large.obj", ObjWriter::Grid(400, ObjCorner::PositionTexCoord, true, true, 3));
+
+  // the scratch buffers of the large imports must not leak into a small one
+  CheckAgainstBaseline(loader, "test_small.obj", s_Triangle);
+}
+
+TEST(ObjLoaderGivesTheSameResultOnAnyNumberOfThreads)
+{
+  const TemporaryFile file("test_threads.obj", ObjWriter::Grid(400, ObjCorner::PositionTexCoord, true, true, 3));
+
+  OBJLoader loader;
+
+  CHECK(loader.Import(file.Name()));
+
+  std::vector<Vertex> corners;
+
+  for (const auto index : loader.Indices()) corners.push_back(loader.Vertices()[index]);
+
+  for (const UINT threads : { 1u, 2u, 3u, 64u })
+  {
+    OBJLoader budgeted(threads);
+
+    CHECK(budgeted.Import(file.Name()));
+    CHECK(SameCorners(budgeted.Vertices(), budgeted.Indices(), corners));
+    CHECK(budgeted.Submeshes().size() == loader.Submeshes().size());
+  }
+}
+
+TEST(ObjLoaderRejectsInvalidFaces)
+{
+  OBJLoader loader;
+
+  const std::string texCoords = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 0 1\n";
+
+  // "f 1/-1 2/-1 3/-1" is only invalid in a file without texcoords
+  std::vector<std::string> contents = { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/-1 2/-1 3/-1\n" };
+
+  for (const auto* face : { "f 1 2 4\n", "f 1 2\n", "f 0 1 2\n", "f -4 1 2\n", "f 1/4 2/1 3/1\n", "f 1 2 x\n", "f 1/-4 2/-4 3/-4\n", "f 1/0 2/0 3/0\n" })
+  {
+    contents.push_back(texCoords + face);
+  }
+
+  for (const auto& content : contents)
+  {
+    const TemporaryFile file("test_invalid.obj", content);
+
+    CollectingSink sink;
+
+    CHECK(!loader.Import(file.Name()));
+    CHECK(!loader.Stream(file.Name(), sink));
+  }
+}
+
+TEST(ObjLoaderStreamMatchesImport)
+{
+  OBJLoader loader;
+
+  for (const auto& content : { std::string(s_Triangle), ObjWriter::Grid(400, ObjCorner::PositionTexCoord, true, true, 0) })
+  {
+    const TemporaryFile file("test_stream.obj", content);
+
+    CHECK(loader.Import(file.Name()));
+
+    const std::vector<Vertex> vertices(loader.Vertices());
+    const std::vector<DWORD> indices(loader.Indices());
+
+    std::vector<Vertex> corners;
+
+    for (const auto index : indices) corners.push_back(vertices[index]);
+
+    CollectingSink sink;
+
+    CHECK(loader.Stream(file.Name(), sink));
+    CHECK(SameCorners(sink.m_Vertices, sink.m_Indices, corners));
+  }
+}
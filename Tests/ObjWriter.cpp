@@ -0,0 +1,86 @@
+#include "ObjWriter.h"
+
+std::string ObjWriter::Grid(UINT size, ObjCorner corner, bool negative, bool quads, UINT materials, const char* newline)
+{
+  std::string obj;
+  char line[128];
+
+  const bool texCoords = corner == ObjCorner::PositionTexCoord || corner == ObjCorner::PositionTexCoordNormal;
+  const bool normals = corner == ObjCorner::PositionNormal || corner == ObjCorner::PositionTexCoordNormal;
+
+  if (normals) obj += std::string("vn 0 0 1") + newline;
+
+  // the vertex of a grid point as a corner of a face, with count vertices written so far
+  const auto append = [&](const UINT vertex, const UINT count)
+  {
+    const long long index = negative ? static_cast<long long>(vertex) - count : vertex + 1ll;
+    const long long normal = negative ? -1 : 1;
+
+    switch (corner)
+    {
+    case ObjCorner::Position: snprintf(line, sizeof(line), " %lld", index); break;
+    case ObjCorner::PositionTexCoord: snprintf(line, sizeof(line), " %lld/%lld", index, index); break;
+    case ObjCorner::PositionNormal: snprintf(line, sizeof(line), " %lld//%lld", index, normal); break;
+    case ObjCorner::PositionTexCoordNormal: snprintf(line, sizeof(line), " %lld/%lld/%lld", index, index, normal); break;
+    }
+
+    obj += line;
+  };
+
+  for (UINT y = 0; y <= size; ++y)
+  {
+    for (UINT x = 0; x <= size; ++x)
+    {
+      snprintf(line, sizeof(line), "v %g %g %g%s", x * 0.25, y * 0.25, ((x * 7 + y * 13) % 17) * 0.125, newline);
+      obj += line;
+
+      if (!texCoords) continue;
+
+      snprintf(line, sizeof(line), "vt %g %g%s", static_cast<double>(x) / size, static_cast<double>(y) / size, newline);
+      obj += line;
+    }
+
+    if (y == 0) continue;
+
+    if (materials)
+    {
+      snprintf(line, sizeof(line), "usemtl material%u%s", y % materials, newline);
+      obj += line;
+    }
+
+    const UINT count = (y + 1) * (size + 1);
+
+    for (UINT x = 0; x < size; ++x)
+    {
+      const UINT a = (y - 1) * (size + 1) + x;
+      const UINT b = a + 1;
+      const UINT c = a + size + 2;
+      const UINT d = a + size + 1;
+
+      if (quads)
+      {
+        obj += "f";
+        append(a, count);
+        append(b, count);
+        append(c, count);
+        append(d, count);
+        obj += newline;
+      }
+      else
+      {
+        obj += "f";
+        append(a, count);
+        append(b, count);
+        append(c, count);
+        obj += newline;
+        obj += "f";
+        append(a, count);
+        append(c, count);
+        append(d, count);
+        obj += newline;
+      }
+    }
+  }
+
+  return obj;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+enum class ObjCorner
+{
+  Position,                 // "v"
+  PositionTexCoord,         // "v/vt"
+  PositionNormal,           // "v//vn"
+  PositionTexCoordNormal,   // "v/vt/vn"
+};
+
+// synthetic OBJ files for the tests and benchmarks
+class ObjWriter
+{
+public:
+  // a grid of size x size quads, every row of vertices is followed by the faces between it and the row before
+  // negative indices count back from the vertices written so far, quads are written as one face instead of two triangles
+  // a material count above 0 switches usemtl every row, newline is "\n" or "\r\n"
+  static std::string Grid(UINT size, ObjCorner corner, bool negative, bool quads, UINT materials, const char* newline = "\n");
+
+private:
+  ObjWriter(void) noexcept = delete;
+  ~ObjWriter(void) noexcept = delete;
+
+};
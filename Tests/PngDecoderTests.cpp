@@ -0,0 +1,277 @@
+#include "Test.h"
+#include "PngWriter.h"
+#include "../PngDecoder.h"
+#include "../ImportCache.h"
+
+// the bit depths of every color type
+static const struct
+{
+  BYTE ColorType;
+  std::vector<BYTE> Depths;
+} s_ColorTypes[] = { { 0, { 1, 2, 4, 8, 16 } }, { 2, { 8, 16 } }, { 3, { 1, 2, 4, 8 } }, { 4, { 8, 16 } }, { 6, { 8, 16 } } };
+
+static const PngDeflate s_Deflates[] = { PngDeflate::Stored, PngDeflate::Fixed, PngDeflate::Mixed };
+
+// what the decoder has to write for source, RGBA8 or RGBA16 for 16 bit images, written pixel by pixel from the PNG specification
+static std::vector<BYTE> Expected(const PngSource& source)
+{
+  const bool wide = (source.Depth == 16);
+  const uint32_t maximum = (1u << source.Depth) - 1;
+  const UINT channels = source.Channels();
+  const size_t count = static_cast<size_t>(source.Width) * source.Height;
+
+  // samples below 8 bits are scaled to 8 bits, the others are kept
+  const auto scale = [&](const uint32_t sample) { return (source.Depth < 8) ? sample * 255 / maximum : sample; };
+  const auto key = [&](const UINT c) { return static_cast<uint32_t>((source.Transparency[2 * c] << 8 | source.Transparency[2 * c + 1]) & maximum); };
+
+  std::vector<BYTE> pixels;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const uint16_t* s = source.Samples.data() + i * channels;
+    uint32_t rgba[4] = { 0, 0, 0, wide ? 0xFFFFu : 0xFFu };
+
+    switch (source.ColorType)
+    {
+    case 0:
+      rgba[0] = rgba[1] = rgba[2] = scale(s[0]);
+
+      if (!source.Transparency.empty() && s[0] == key(0)) rgba[3] = 0;
+
+      break;
+
+    case 2:
+      rgba[0] = s[0];
+      rgba[1] = s[1];
+      rgba[2] = s[2];
+
+      if (!source.Transparency.empty() && s[0] == key(0) && s[1] == key(1) && s[2] == key(2)) rgba[3] = 0;
+
+      break;
+
+    case 3:
+      if (s[0] * 3u < source.Palette.size())
+      {
+        rgba[0] = source.Palette[s[0] * 3];
+        rgba[1] = source.Palette[s[0] * 3 + 1];
+        rgba[2] = source.Palette[s[0] * 3 + 2];
+      }
+
+      if (s[0] < source.Transparency.size()) rgba[3] = source.Transparency[s[0]];
+
+      break;
+
+    case 4:
+      rgba[0] = rgba[1] = rgba[2] = s[0];
+      rgba[3] = s[1];
+
+      break;
+
+    case 6:
+      for (UINT c = 0; c < 4; ++c) rgba[c] = s[c];
+
+      break;
+    }
+
+    for (const uint32_t value : rgba)
+    {
+      if (wide)
+      {
+        const uint16_t sample = static_cast<uint16_t>(value);
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(&sample);
+
+        pixels.insert(pixels.end(), bytes, bytes + 2);
+      }
+      else
+      {
+        pixels.push_back(static_cast<BYTE>(value));
+      }
+    }
+  }
+
+  return pixels;
+}
+
+// decodes png into rows padding bytes apart from each other, empty if it fails
+static std::vector<BYTE> Decode(const std::vector<BYTE>& png, const size_t padding = 0)
+{
+  PngInfo info;
+
+  if (!PngDecoder::ReadInfo(png.data(), png.size(), info)) return {};
+
+  const size_t rowBytes = static_cast<size_t>(info.Width) * info.BytesPerPixel;
+  std::vector<BYTE> rows((rowBytes + padding) * info.Height, 0xCD);
+
+  if (!PngDecoder::Decode(png.data(), png.size(), rows.data(), rowBytes + padding)) return {};
+
+  std::vector<BYTE> pixels;
+
+  for (UINT y = 0; y < info.Height; ++y) pixels.insert(pixels.end(), rows.begin() + y * (rowBytes + padding), rows.begin() + y * (rowBytes + padding) + rowBytes);
+
+  return pixels;
+}
+
+static void CheckDecode(const PngSource& source, const PngDeflate deflate, const size_t chunkSize = SIZE_MAX, const size_t padding = 0)
+{
+  const std::vector<BYTE> png = PngWriter::Write(source, deflate, chunkSize);
+
+  PngInfo info;
+
+  CHECK(PngDecoder::IsPng(png.data(), png.size()));
+  CHECK(PngDecoder::ReadInfo(png.data(), png.size(), info));
+  CHECK(info.Width == source.Width && info.Height == source.Height);
+  CHECK(info.BytesPerPixel == ((source.Depth == 16) ? 8u : 4u));
+  CHECK(Decode(png, padding) == Expected(source));
+}
+
+static std::vector<BYTE> ReadFile(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+
+  return std::vector<BYTE>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+TEST(PngDecoderDecodesEveryColorTypeAndDepth)
+{
+  uint32_t seed = 0;
+
+  for (const auto& type : s_ColorTypes)
+  {
+    for (const BYTE depth : type.Depths)
+    {
+      for (const bool interlaced : { false, true })
+      {
+        // smaller than a pass of Adam7, partial bytes at the end of the rows, and a few rows of every filter
+        for (const auto& size : { std::make_pair(1u, 1u), std::make_pair(3u, 2u), std::make_pair(13u, 7u), std::make_pair(33u, 17u) })
+        {
+          const PngSource source = PngWriter::Pattern(size.first, size.second, type.ColorType, depth, interlaced, ++seed);
+
+          for (const auto deflate : s_Deflates) CheckDecode(source, deflate);
+        }
+      }
+    }
+  }
+}
+
+TEST(PngDecoderDecodesLargeImages)
+{
+  // image data of many deflate blocks, 32K matches and Adler-32 over several of its 5552 byte chunks
+  CheckDecode(PngWriter::Pattern(1000, 300, 6, 8, false, 1), PngDeflate::Fixed);
+  CheckDecode(PngWriter::Pattern(517, 203, 6, 16, true, 2), PngDeflate::Mixed);
+  CheckDecode(PngWriter::Pattern(777, 301, 2, 8, false, 3), PngDeflate::Stored);
+  CheckDecode(PngWriter::Pattern(1023, 257, 3, 4, true, 4), PngDeflate::Fixed);
+}
+
+TEST(PngDecoderWritesRowsWithPadding)
+{
+  CheckDecode(PngWriter::Pattern(13, 7, 6, 8, false, 5), PngDeflate::Fixed, SIZE_MAX, 12);
+  CheckDecode(PngWriter::Pattern(13, 7, 0, 2, true, 6), PngDeflate::Fixed, SIZE_MAX, 3);
+  CheckDecode(PngWriter::Pattern(13, 7, 6, 16, true, 7), PngDeflate::Mixed, SIZE_MAX, 8);
+}
+
+TEST(PngDecoderAppliesTransparency)
+{
+  for (const BYTE depth : { 1, 2, 4, 8, 16 })
+  {
+    PngSource gray = PngWriter::Pattern(33, 17, 0, depth, depth == 4, depth);
+
+    // a key with bits above the depth set, they are ignored
+    gray.Transparency = { static_cast<BYTE>(0xF0 | gray.Samples[0] >> 8), static_cast<BYTE>(gray.Samples[0]) };
+
+    if (depth == 16) gray.Transparency[0] = static_cast<BYTE>(gray.Samples[0] >> 8);
+
+    CheckDecode(gray, PngDeflate::Fixed);
+  }
+
+  for (const BYTE depth : { 8, 16 })
+  {
+    PngSource color = PngWriter::Pattern(33, 17, 2, depth, depth == 16, depth);
+
+    for (UINT c = 0; c < 3; ++c) color.Transparency.insert(color.Transparency.end(), { static_cast<BYTE>(color.Samples[c] >> 8), static_cast<BYTE>(color.Samples[c]) });
+
+    CheckDecode(color, PngDeflate::Fixed);
+  }
+
+  for (const BYTE depth : { 1, 2, 4, 8 })
+  {
+    PngSource palette = PngWriter::Pattern(33, 17, 3, depth, depth == 2, depth);
+
+    // fewer alpha values than colors, the others stay opaque
+    for (size_t i = 0; i < palette.Palette.size() / 3 / 2 + 1; ++i) palette.Transparency.push_back(static_cast<BYTE>(i * 97));
+
+    CheckDecode(palette, PngDeflate::Fixed);
+  }
+
+  // indices past the end of a short palette read opaque black
+  PngSource shortPalette = PngWriter::Pattern(13, 7, 3, 4, false, 8);
+
+  shortPalette.Palette.resize(5 * 3);
+
+  CheckDecode(shortPalette, PngDeflate::Stored);
+}
+
+TEST(PngDecoderJoinsSplitImageData)
+{
+  const PngSource source = PngWriter::Pattern(33, 17, 6, 8, true, 9);
+
+  for (const size_t chunkSize : { 1, 2, 7, 100 })
+  {
+    for (const auto deflate : s_Deflates) CheckDecode(source, deflate, chunkSize);
+  }
+}
+
+TEST(PngDecoderRejectsDamagedImageData)
+{
+  const PngSource source = PngWriter::Pattern(33, 17, 6, 8, false, 10);
+
+  for (const auto deflate : s_Deflates)
+  {
+    const std::vector<BYTE> png = PngWriter::Write(source, deflate);
+
+    CHECK(Decode(png) == Expected(source));
+
+    // the Adler-32 ends the image data, the last chunks are its CRC and IEND
+    std::vector<BYTE> adler(png);
+
+    adler[png.size() - 12 - 4 - 1] ^= 1;
+
+    CHECK(Decode(adler).empty());
+
+    // cut off inside the image data
+    CHECK(Decode(std::vector<BYTE>(png.begin(), png.begin() + png.size() / 2)).empty());
+  }
+
+  // a damaged byte of a stored block has no structure to fail on, only the Adler-32 notices it
+  std::vector<BYTE> stored = PngWriter::Write(source, PngDeflate::Stored);
+
+  stored[stored.size() / 2] ^= 0x10;
+
+  CHECK(Decode(stored).empty());
+}
+
+TEST(PngDecoderDecodesShippedImages)
+{
+  // the hashes of the RGBA8 pixels libpng decodes from the files
+  static const struct
+  {
+    const char* Filename;
+    UINT Width;
+    UINT Height;
+    uint64_t Hash;
+  } s_Images[] = { { "barrier.png", 1024, 1024, 0x70122ce85e22bcf4ull }, { "thm.png", 1983, 1983, 0x322f877dbc21b872ull } };
+
+  for (const auto& image : s_Images)
+  {
+    const std::vector<BYTE> png = ReadFile(image.Filename);
+
+    PngInfo info;
+
+    CHECK(PngDecoder::ReadInfo(png.data(), png.size(), info));
+    CHECK(info.Width == image.Width && info.Height == image.Height && info.Format == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+    const std::vector<BYTE> pixels = Decode(png);
+
+    CHECK(pixels.size() == static_cast<size_t>(image.Width) * image.Height * 4);
+    CHECK(ImportCache::Hash(reinterpret_cast<const char*>(pixels.data()), pixels.size(), 0) == image.Hash);
+  }
+}
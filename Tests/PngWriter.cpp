@@ -0,0 +1,371 @@
+#include "PngWriter.h"
+
+// origin and spacing of the pixels of the Adam7 passes
+static const UINT s_Adam7[7][4] = { { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+static const UINT s_Sequential[1][4] = { { 0, 0, 1, 1 } };
+
+static const uint16_t s_LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const BYTE s_LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t s_DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const BYTE s_DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// bytes of image data per deflate block, small enough for several blocks in most test images
+static constexpr size_t s_BlockSize = 4096;
+static constexpr size_t s_Window = 32768;
+
+// writes a deflate stream least significant bit first
+class BitWriter
+{
+public:
+  explicit BitWriter(std::vector<BYTE>& out) noexcept : m_Out(out) {}
+
+  void Write(uint32_t value, uint32_t count)
+  {
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      m_Bits |= ((value >> i) & 1) << m_Count;
+
+      if (++m_Count == 8) Flush();
+    }
+  }
+
+  // Huffman codes start with their most significant bit
+  void WriteCode(uint32_t code, uint32_t length)
+  {
+    for (uint32_t i = length; i-- > 0;) Write((code >> i) & 1, 1);
+  }
+
+  void Align(void)
+  {
+    if (m_Count) Flush();
+  }
+
+private:
+  void Flush(void)
+  {
+    m_Out.push_back(static_cast<BYTE>(m_Bits));
+    m_Bits = 0;
+    m_Count = 0;
+  }
+
+  std::vector<BYTE>& m_Out;
+  uint32_t m_Bits = 0;
+  uint32_t m_Count = 0;
+
+};
+
+static void WriteLiteral(BitWriter& writer, const uint32_t symbol)
+{
+  if (symbol < 144) writer.WriteCode(0x30 + symbol, 8);
+  else if (symbol < 256) writer.WriteCode(0x190 + symbol - 144, 9);
+  else if (symbol < 280) writer.WriteCode(symbol - 256, 7);
+  else writer.WriteCode(0xC0 + symbol - 280, 8);
+}
+
+static void WriteMatch(BitWriter& writer, const uint32_t length, const uint32_t distance)
+{
+  uint32_t code = 28;
+
+  while (s_LengthBase[code] > length) --code;
+
+  WriteLiteral(writer, 257 + code);
+  writer.Write(length - s_LengthBase[code], s_LengthExtra[code]);
+
+  code = 29;
+
+  while (s_DistanceBase[code] > distance) --code;
+
+  writer.WriteCode(code, 5);
+  writer.Write(distance - s_DistanceBase[code], s_DistanceExtra[code]);
+}
+
+// a block with the fixed codes, greedy LZ77 over the 3 byte prefixes that were seen last, matches may reach back into earlier blocks
+static void WriteFixedBlock(BitWriter& writer, const std::vector<BYTE>& data, const size_t begin, const size_t end, std::vector<size_t>& heads, const bool last)
+{
+  writer.Write(last ? 1 : 0, 1);
+  writer.Write(1, 2);
+
+  for (size_t i = begin; i < end;)
+  {
+    size_t length = 0;
+    size_t distance = 0;
+
+    if (i + 3 <= end)
+    {
+      const size_t hash = (data[i] << 16 | data[i + 1] << 8 | data[i + 2]) % heads.size();
+      const size_t candidate = heads[hash];
+
+      heads[hash] = i + 1;
+
+      if (candidate && i - (candidate - 1) <= s_Window)
+      {
+        const size_t from = candidate - 1;
+
+        while (i + length < end && length < 258 && data[from + length] == data[i + length]) ++length;
+
+        distance = i - from;
+      }
+    }
+
+    if (length >= 3)
+    {
+      WriteMatch(writer, static_cast<uint32_t>(length), static_cast<uint32_t>(distance));
+      i += length;
+    }
+    else
+    {
+      WriteLiteral(writer, data[i]);
+      ++i;
+    }
+  }
+
+  WriteLiteral(writer, 256);
+}
+
+static void WriteStoredBlock(BitWriter& writer, std::vector<BYTE>& out, const std::vector<BYTE>& data, const size_t begin, const size_t end, const bool last)
+{
+  writer.Write(last ? 1 : 0, 1);
+  writer.Write(0, 2);
+  writer.Align();
+
+  const uint32_t length = static_cast<uint32_t>(end - begin);
+
+  writer.Write(length, 16);
+  writer.Write(~length & 0xFFFF, 16);
+
+  out.insert(out.end(), data.begin() + begin, data.begin() + end);
+}
+
+static std::vector<BYTE> Deflate(const std::vector<BYTE>& data, const PngDeflate deflate)
+{
+  // deflate with a 32K window and without preset dictionary
+  std::vector<BYTE> out = { 0x78, 0x01 };
+  BitWriter writer(out);
+  std::vector<size_t> heads(4093, 0);
+
+  const size_t blocks = std::max<size_t>(1, (data.size() + s_BlockSize - 1) / s_BlockSize);
+
+  for (size_t b = 0; b < blocks; ++b)
+  {
+    const size_t begin = b * s_BlockSize;
+    const size_t end = std::min(data.size(), begin + s_BlockSize);
+    const bool last = (b + 1 == blocks);
+    const bool stored = (deflate == PngDeflate::Stored) || (deflate == PngDeflate::Mixed && b % 2 == 1);
+
+    if (stored) WriteStoredBlock(writer, out, data, begin, end, last);
+    else WriteFixedBlock(writer, data, begin, end, heads, last);
+  }
+
+  writer.Align();
+
+  const uint32_t adler = PngWriter::Adler32(data.data(), data.size());
+
+  for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<BYTE>(adler >> shift));
+
+  return out;
+}
+
+static uint32_t Crc32(const BYTE* data, const size_t size) noexcept
+{
+  static const auto table = []()
+  {
+    std::array<uint32_t, 256> table;
+
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+      uint32_t c = n;
+
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+
+      table[n] = c;
+    }
+
+    return table;
+  }();
+
+  uint32_t crc = 0xFFFFFFFFu;
+
+  for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+  return crc ^ 0xFFFFFFFFu;
+}
+
+static void AppendBigEndian(std::vector<BYTE>& out, const uint32_t value)
+{
+  for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<BYTE>(value >> shift));
+}
+
+static void AppendChunk(std::vector<BYTE>& png, const char* type, const BYTE* data, const size_t size)
+{
+  AppendBigEndian(png, static_cast<uint32_t>(size));
+
+  const size_t start = png.size();
+
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data, data + size);
+
+  AppendBigEndian(png, Crc32(png.data() + start, png.size() - start));
+}
+
+static BYTE Paeth(const int a, const int b, const int c) noexcept
+{
+  const int p = a + b - c;
+  const int pa = abs(p - a);
+  const int pb = abs(p - b);
+  const int pc = abs(p - c);
+
+  return static_cast<BYTE>((pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c);
+}
+
+// the rows of every pass packed, filtered and preceded by their filter type
+static std::vector<BYTE> Filter(const PngSource& source)
+{
+  const UINT (*passes)[4] = source.Interlaced ? s_Adam7 : s_Sequential;
+  const size_t passCount = source.Interlaced ? 7 : 1;
+  const UINT channels = source.Channels();
+  const size_t bpp = std::max<size_t>(1, channels * source.Depth / 8);
+
+  std::vector<BYTE> filtered;
+
+  for (size_t p = 0; p < passCount; ++p)
+  {
+    const UINT* pass = passes[p];
+    const UINT width = (source.Width > pass[0]) ? (source.Width - pass[0] + pass[2] - 1) / pass[2] : 0;
+    const UINT height = (source.Height > pass[1]) ? (source.Height - pass[1] + pass[3] - 1) / pass[3] : 0;
+    const size_t rowBytes = (static_cast<size_t>(width) * channels * source.Depth + 7) / 8;
+
+    if (!width || !height) continue;
+
+    std::vector<BYTE> prev(rowBytes, 0);
+    std::vector<BYTE> row(rowBytes);
+
+    for (UINT y = 0; y < height; ++y)
+    {
+      std::fill(row.begin(), row.end(), 0);
+
+      for (UINT x = 0; x < width; ++x)
+      {
+        const size_t pixel = (static_cast<size_t>(pass[1] + y * pass[3]) * source.Width + pass[0] + x * pass[2]) * channels;
+
+        for (UINT c = 0; c < channels; ++c)
+        {
+          const uint16_t sample = source.Samples[pixel + c];
+          const size_t bit = (static_cast<size_t>(x) * channels + c) * source.Depth;
+
+          if (source.Depth == 16)
+          {
+            row[bit / 8] = static_cast<BYTE>(sample >> 8);
+            row[bit / 8 + 1] = static_cast<BYTE>(sample);
+          }
+          else
+          {
+            row[bit / 8] |= static_cast<BYTE>(sample << (8 - source.Depth - bit % 8));
+          }
+        }
+      }
+
+      const BYTE type = static_cast<BYTE>((y + p) % 5);
+
+      filtered.push_back(type);
+
+      for (size_t i = 0; i < rowBytes; ++i)
+      {
+        const int a = (i >= bpp) ? row[i - bpp] : 0;
+        const int b = prev[i];
+        const int c = (i >= bpp) ? prev[i - bpp] : 0;
+        int predicted = 0;
+
+        switch (type)
+        {
+        case 1: predicted = a; break;
+        case 2: predicted = b; break;
+        case 3: predicted = (a + b) / 2; break;
+        case 4: predicted = Paeth(a, b, c); break;
+        }
+
+        filtered.push_back(static_cast<BYTE>(row[i] - predicted));
+      }
+
+      prev.swap(row);
+    }
+  }
+
+  return filtered;
+}
+
+std::vector<BYTE> PngWriter::Write(const PngSource& source, PngDeflate deflate, size_t chunkSize)
+{
+  std::vector<BYTE> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+  std::vector<BYTE> header;
+
+  AppendBigEndian(header, source.Width);
+  AppendBigEndian(header, source.Height);
+  header.insert(header.end(), { source.Depth, source.ColorType, 0, 0, static_cast<BYTE>(source.Interlaced ? 1 : 0) });
+
+  AppendChunk(png, "IHDR", header.data(), header.size());
+
+  if (!source.Palette.empty()) AppendChunk(png, "PLTE", source.Palette.data(), source.Palette.size());
+  if (!source.Transparency.empty()) AppendChunk(png, "tRNS", source.Transparency.data(), source.Transparency.size());
+
+  const std::vector<BYTE> stream = Deflate(Filter(source), deflate);
+
+  for (size_t offset = 0; offset < stream.size(); offset += chunkSize)
+  {
+    AppendChunk(png, "IDAT", stream.data() + offset, std::min(chunkSize, stream.size() - offset));
+  }
+
+  AppendChunk(png, "IEND", nullptr, 0);
+
+  return png;
+}
+
+PngSource PngWriter::Pattern(UINT width, UINT height, BYTE colorType, BYTE depth, bool interlaced, uint32_t seed)
+{
+  PngSource source;
+
+  source.Width = width;
+  source.Height = height;
+  source.ColorType = colorType;
+  source.Depth = depth;
+  source.Interlaced = interlaced;
+
+  const uint32_t range = 1u << depth;
+  const size_t count = static_cast<size_t>(width) * height * source.Channels();
+
+  source.Samples.resize(count);
+
+  // runs of a repeated sample between random ones
+  uint32_t state = seed * 2654435761u + 1;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    state = state * 1664525u + 1013904223u;
+
+    source.Samples[i] = ((state >> 28) < 6 && i > 0) ? source.Samples[i - 1] : static_cast<uint16_t>((state >> 8) % range);
+  }
+
+  if (colorType == 3)
+  {
+    for (uint32_t i = 0; i < range; ++i)
+    {
+      source.Palette.insert(source.Palette.end(), { static_cast<BYTE>(i * 37), static_cast<BYTE>(255 - i * 11), static_cast<BYTE>(i * 101 + seed) });
+    }
+  }
+
+  return source;
+}
+
+uint32_t PngWriter::Adler32(const BYTE* data, size_t size) noexcept
+{
+  uint32_t a = 1;
+  uint32_t b = 0;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+
+  return b << 16 | a;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// the deflate blocks PngWriter writes the image data with
+enum class PngDeflate
+{
+  Stored,   // uncompressed blocks
+  Fixed,    // the fixed Huffman codes with LZ77 matches
+  Mixed,    // stored and fixed blocks alternating, so stored blocks start in the middle of a byte
+};
+
+// an image for PngWriter, one sample per channel and pixel in [0, 2^Depth), palette indices for color type 3
+struct PngSource
+{
+  UINT Width = 0;
+  UINT Height = 0;
+  BYTE ColorType = 6;
+  BYTE Depth = 8;
+  bool Interlaced = false;
+  std::vector<uint16_t> Samples;
+  std::vector<BYTE> Palette;        // RGB triplets, written as PLTE if not empty
+  std::vector<BYTE> Transparency;   // written as tRNS if not empty
+
+  inline UINT Channels(void) const noexcept { return (ColorType == 2) ? 3 : (ColorType == 4) ? 2 : (ColorType == 6) ? 4 : 1; }
+};
+
+// synthetic PNG files for the tests and benchmarks
+class PngWriter
+{
+public:
+  // every row is filtered with type (row + pass) % 5, so all filters occur in every image of a few rows
+  // the image data is split into IDAT chunks of chunkSize bytes
+  static std::vector<BYTE> Write(const PngSource& source, PngDeflate deflate, size_t chunkSize = SIZE_MAX);
+
+  // pseudo random samples with runs that LZ77 finds, and a palette of 2^depth colors for color type 3
+  static PngSource Pattern(UINT width, UINT height, BYTE colorType, BYTE depth, bool interlaced, uint32_t seed);
+
+  // the zlib checksum of [data, data + size), one byte at a time
+  static uint32_t Adler32(const BYTE* data, size_t size) noexcept;
+
+private:
+  PngWriter(void) noexcept = delete;
+  ~PngWriter(void) noexcept = delete;
+
+};
@@ -0,0 +1,138 @@
+#include "ReferenceObjLoader.h"
+
+// the tokens of str between the characters of delimiters, empty ones are dropped
+static std::vector<std::string> Split(const std::string& str, const char* delimiters)
+{
+  std::vector<std::string> tokens;
+
+  for (size_t start = str.find_first_not_of(delimiters); start != std::string::npos; start = str.find_first_not_of(delimiters, start))
+  {
+    const size_t end = std::min(str.find_first_of(delimiters, start), str.length());
+
+    tokens.push_back(str.substr(start, end - start));
+    start = end;
+  }
+
+  return tokens;
+}
+
+// a float token, 0 if the line has less tokens
+static float Coordinate(const std::vector<std::string>& tokens, const size_t index)
+{
+  return (index < tokens.size()) ? strtof(tokens[index].c_str(), nullptr) : 0.0f;
+}
+
+// 0-based index of what a corner refers to, negative indices count back from the count read so far
+static int Resolve(const std::string& index, const size_t count)
+{
+  const int value = atoi(index.c_str());
+
+  return (value < 0) ? static_cast<int>(count) + value : value - 1;
+}
+
+struct ReferenceCorner
+{
+  int Position;
+  int TexCoord;
+  bool HasTexCoord;
+};
+
+bool ReferenceObjLoader::Load(const std::string& filename, std::vector<Vertex>& corners, std::vector<ObjSubmesh>& submeshes)
+{
+  std::ifstream input(filename, std::ios::binary);
+
+  corners.clear();
+  submeshes.clear();
+
+  if (!input.is_open()) return false;
+
+  std::vector<XMFLOAT3> positions;
+  std::vector<XMFLOAT2> texCoords;
+  std::vector<ReferenceCorner> faces;
+  std::vector<UINT> faceMaterials;
+  std::vector<std::string> materials(1);
+  UINT material = 0;
+
+  std::string line;
+
+  while (std::getline(input, line))
+  {
+    const auto tokens = Split(line, " \t\r");
+
+    if (tokens.empty()) continue;
+
+    if (tokens[0] == "v")
+    {
+      positions.push_back({ Coordinate(tokens, 1), Coordinate(tokens, 2), Coordinate(tokens, 3) });
+    }
+    else if (tokens[0] == "vt")
+    {
+      texCoords.push_back({ Coordinate(tokens, 1), 1.0f - Coordinate(tokens, 2) });
+    }
+    else if (tokens[0] == "usemtl")
+    {
+      const size_t start = line.find_first_not_of(" \t\r", line.find("usemtl") + 6);
+      const size_t end = line.find_last_not_of(" \t\r");
+      const auto name = (start == std::string::npos) ? std::string() : line.substr(start, end + 1 - start);
+
+      material = static_cast<UINT>(std::find(materials.begin(), materials.end(), name) - materials.begin());
+
+      if (material == materials.size()) materials.push_back(name);
+    }
+    else if (tokens[0] == "f")
+    {
+      std::vector<ReferenceCorner> polygon;
+
+      for (size_t i = 1; i < tokens.size() && tokens[i][0] != '#'; ++i)
+      {
+        // "v", "v/vt", "v//vn" or "v/vt/vn"
+        const auto& corner = tokens[i];
+        const size_t slash = corner.find('/');
+        const auto texCoord = (slash == std::string::npos) ? std::string() : corner.substr(slash + 1, corner.find('/', slash + 1) - slash - 1);
+
+        if (atoi(corner.c_str()) == 0) return false;
+
+        polygon.push_back({ Resolve(corner.substr(0, slash), positions.size()), texCoord.empty() ? 0 : Resolve(texCoord, texCoords.size()), !texCoord.empty() });
+      }
+
+      if (polygon.size() < 3) return false;
+
+      for (size_t i = 2; i < polygon.size(); ++i)
+      {
+        faces.push_back(polygon[0]);
+        faces.push_back(polygon[i - 1]);
+        faces.push_back(polygon[i]);
+        faceMaterials.push_back(material);
+      }
+    }
+  }
+
+  // the indices may refer to attributes further down the file
+  for (const auto& corner : faces)
+  {
+    if (corner.Position < 0 || corner.Position >= static_cast<int>(positions.size())) return false;
+    if (corner.HasTexCoord && (corner.TexCoord < 0 || corner.TexCoord >= static_cast<int>(texCoords.size()))) return false;
+  }
+
+  for (UINT m = 0; m < materials.size(); ++m)
+  {
+    const DWORD start = static_cast<DWORD>(corners.size());
+
+    for (size_t face = 0; face < faceMaterials.size(); ++face)
+    {
+      if (faceMaterials[face] != m) continue;
+
+      for (size_t k = face * 3; k < face * 3 + 3; ++k)
+      {
+        const auto& position = positions[faces[k].Position];
+        const auto texCoord = !faces[k].HasTexCoord ? XMFLOAT2(0.0f, 1.0f) : texCoords[faces[k].TexCoord];
+
+        corners.push_back({ position, { 1.0f, 1.0f, 1.0f, 1.0f }, texCoord });
+      }
+    }
+
+    if (corners.size() > start) submeshes.push_back({ materials[m], std::string(), start, static_cast<DWORD>(corners.size()) - start });
+  }
+
+  return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../ObjLoader.h"
+
+// a line by line OBJ loader written for the tests next to OBJLoader, the oracle for what the baseline loader cannot read
+// every line is split into strings and every corner is resolved on its own, which is slow but simple enough to trust
+// it reads n-gons as a fan around their first corner, negative indices and v, v/vt, v//vn and v/vt/vn corners
+// everything the baseline reads is compared against BaselineObjLoader instead
+class ReferenceObjLoader
+{
+public:
+  // corners receives one vertex per triangle corner, the triangles grouped by material like OBJLoader::Submeshes, whose ranges go to submeshes
+  // false for a face with less than three corners or with an index out of range
+  static bool Load(const std::string& filename, std::vector<Vertex>& corners, std::vector<ObjSubmesh>& submeshes);
+
+private:
+  ReferenceObjLoader(void) noexcept = delete;
+  ~ReferenceObjLoader(void) noexcept = delete;
+
+};
@@ -0,0 +1,76 @@
+#include "Test.h"
+
+struct TestCase
+{
+  const char* Name;
+  void (*Run)(void);
+};
+
+// a function local static, the tests of other translation units register before any global of this one is initialized
+static std::vector<TestCase>& Tests(void)
+{
+  static std::vector<TestCase> tests;
+
+  return tests;
+}
+
+static UINT s_Failures = 0;
+
+bool Test::Register(const char* name, void (*run)(void))
+{
+  Tests().push_back({ name, run });
+
+  return true;
+}
+
+void Test::Fail(const char* file, int line, const std::string& condition)
+{
+  std::cout << "  " << file << "(" << line << "): CHECK(" << condition << ") failed" << std::endl;
+
+  ++s_Failures;
+}
+
+int Test::RunAll(const std::string& filter)
+{
+  int failed = 0;
+  int run = 0;
+
+  for (const auto& test : Tests())
+  {
+    if (std::string(test.Name).find(filter) == std::string::npos) continue;
+
+    std::cout << test.Name << std::endl;
+
+    s_Failures = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    test.Run();
+
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << (s_Failures ? "FAILED" : "passed") << " in " << static_cast<int>(seconds.count() * 1e3) << " ms" << std::endl;
+
+    if (s_Failures) ++failed;
+    ++run;
+  }
+
+  std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+
+  return failed;
+}
+
+TemporaryFile::TemporaryFile(const std::string& filename, const std::string& content) : m_Filename(filename)
+{
+  std::ofstream(filename, std::ios::binary | std::ios::trunc).write(content.data(), content.size());
+}
+
+TemporaryFile::TemporaryFile(const std::string& filename, const std::vector<BYTE>& content) : m_Filename(filename)
+{
+  std::ofstream(filename, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(content.data()), content.size());
+}
+
+TemporaryFile::~TemporaryFile(void) noexcept
+{
+  std::remove(m_Filename.c_str());
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// a test runner without dependencies, every TEST registers itself before main and CHECK reports a failed condition without ending the test
+// the runner is started in the solution directory, the shipped assets are read from there
+class Test
+{
+public:
+  static bool Register(const char* name, void (*run)(void));
+  static void Fail(const char* file, int line, const std::string& condition);
+
+  // runs every test whose name contains filter, returns the number of tests that failed
+  static int RunAll(const std::string& filter);
+
+private:
+  Test(void) noexcept = delete;
+  ~Test(void) noexcept = delete;
+
+};
+
+// a file in the working directory that lives as long as the object
+class TemporaryFile
+{
+public:
+  TemporaryFile(const std::string& filename, const std::string& content);
+  TemporaryFile(const std::string& filename, const std::vector<BYTE>& content);
+  ~TemporaryFile(void) noexcept;
+
+  TemporaryFile(const TemporaryFile&) = delete;
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+  inline const std::string& Name(void) const noexcept { return m_Filename; }
+
+private:
+  std::string m_Filename;
+
+};
+
+#define TEST(name) \
+  static void name(void); \
+  static const bool s_Registered##name = Test::Register(#name, &name); \
+  static void name(void)
+
+#define CHECK(condition) do { if (!(condition)) Test::Fail(__FILE__, __LINE__, #condition); } while (false)
@@ -0,0 +1,22 @@
+// the engine shows errors in a message box, which would stop a test run until someone closes it
+// the tests and benchmarks link this one instead and write everything to the console
+
+void Log::Info(std::string message)
+{
+  std::cout << "  INFO: " << message << std::endl;
+}
+
+void Log::Info(std::wstring message)
+{
+  Log::Info(std::string(message.begin(), message.end()));
+}
+
+void Log::Error(std::string message)
+{
+  std::cout << "  ERROR: " << message << std::endl;
+}
+
+void Log::Error(std::wstring message)
+{
+  Log::Error(std::string(message.begin(), message.end()));
+}
@@ -0,0 +1,7 @@
+#include "Test.h"
+
+// Tests.exe [filter], runs the tests whose name contains filter or all of them
+int main(int argc, char* argv[])
+{
+  return (Test::RunAll((argc > 1) ? argv[1] : "") == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,348 @@
+#include "TextureCache.h"
+
+#include <tuple>
+#include <atomic>
+#include <thread>
+#include <cwctype>
+
+std::map<std::pair<std::wstring, DXGI_FORMAT>, UINT> TextureCache::s_Handles;
+std::vector<TextureCache::Entry> TextureCache::s_Entries;
+std::vector<UINT> TextureCache::s_FreeHandles;
+std::vector<TextureCache::TextureArray> TextureCache::s_Arrays;
+std::vector<UINT> TextureCache::s_FreeArrays;
+std::vector<TextureCache::Retired> TextureCache::s_Retired;
+UINT64 TextureCache::s_NextFence = 0;
+ComPtr<ID3D12DescriptorHeap> TextureCache::s_DescriptorHeap;
+UINT TextureCache::s_DescriptorCapacity = 0;
+UINT TextureCache::s_DescriptorSize = 0;
+
+// every way of naming a file finds the same entry
+static std::wstring NormalizedPath(const std::wstring& filename)
+{
+  wchar_t path[MAX_PATH];
+  const DWORD length = GetFullPathNameW(filename.c_str(), MAX_PATH, path, nullptr);
+  std::wstring normalized = (length && length < MAX_PATH) ? std::wstring(path, length) : filename;
+
+  std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](const wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+
+  return normalized;
+}
+
+UINT TextureCache::Acquire(const std::wstring& filename, DXGI_FORMAT format)
+{
+  const auto key = std::make_pair(NormalizedPath(filename), format);
+  const auto it = s_Handles.find(key);
+
+  if (it != s_Handles.end())
+  {
+    ++s_Entries[it->second].References;
+
+    return it->second;
+  }
+
+  UINT handle = static_cast<UINT>(s_Entries.size());
+
+  if (s_FreeHandles.empty()) s_Entries.emplace_back();
+  else
+  {
+    handle = s_FreeHandles.back();
+    s_FreeHandles.pop_back();
+  }
+
+  Entry& entry = s_Entries[handle];
+
+  entry = Entry();
+  entry.Filename = filename;
+  entry.Path = key.first;
+  entry.Format = format;
+  entry.References = 1;
+
+  s_Handles.emplace(key, handle);
+
+  return handle;
+}
+
+void TextureCache::Release(UINT handle)
+{
+  if (handle >= s_Entries.size() || !s_Entries[handle].References) return;
+
+  Entry& entry = s_Entries[handle];
+
+  if (--entry.References) return;
+
+  // the layer stays in its array until the array has no other layer left
+  // the frames in flight may still sample it, so the array and its descriptor are only reused once the GPU is past them
+  if (entry.Array && !--s_Arrays[entry.Array].Layers)
+  {
+    Retire(s_Arrays[entry.Array].UploadHeap);
+    Retire(s_Arrays[entry.Array].Texture, entry.Array);
+    s_Arrays[entry.Array] = TextureArray();
+
+    // the view stays as it is until then, it is written again by the Pack that reuses the array
+    s_Arrays[entry.Array].Described = true;
+  }
+
+  s_Handles.erase(std::make_pair(entry.Path, entry.Format));
+  entry = Entry();
+  s_FreeHandles.push_back(handle);
+}
+
+void TextureCache::ImportAll(void)
+{
+  std::vector<Entry*> pending;
+
+  for (auto& entry : s_Entries)
+  {
+    if (!entry.References || entry.Imported) continue;
+
+    entry.Imported = true;
+    entry.Image.reset(new TextureImage());
+    pending.push_back(&entry);
+  }
+
+  if (pending.empty()) return;
+
+  // one worker per core takes the next image as it finishes one, the cores left over filter and compress inside the images
+  const UINT cores = std::max(1u, std::thread::hardware_concurrency());
+  const UINT threads = static_cast<UINT>(std::min<size_t>(cores, pending.size()));
+  const UINT threadsPerImage = std::max(1u, cores / threads);
+
+  std::atomic<size_t> next(0);
+
+  const auto work = [&pending, &next, threadsPerImage](void)
+  {
+    for (size_t i = next++; i < pending.size(); i = next++) pending[i]->Image->Open(pending[i]->Filename, pending[i]->Format, threadsPerImage);
+  };
+
+  std::vector<std::thread> workers;
+
+  for (UINT t = 1; t < threads; ++t) workers.emplace_back(work);
+
+  work();
+
+  for (auto& worker : workers) worker.join();
+}
+
+bool TextureCache::LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList)
+{
+  if (s_Arrays.empty()) s_Arrays.emplace_back();
+
+  // the images of every array, by size, format and number of levels, their layers in the order of the handles
+  std::map<std::tuple<UINT64, UINT, DXGI_FORMAT, UINT16>, std::vector<UINT>> arrays;
+  bool loaded = true;
+
+  for (UINT handle = 0; handle < s_Entries.size(); ++handle)
+  {
+    Entry& entry = s_Entries[handle];
+
+    if (!entry.References) continue;
+
+    // acquired after the last ImportAll
+    if (!entry.Imported)
+    {
+      entry.Imported = true;
+      entry.Image.reset(new TextureImage());
+      entry.Image->Open(entry.Filename, entry.Format);
+    }
+
+    if (!entry.Image) continue;
+
+    if (entry.Image->IsOpen())
+    {
+      const D3D12_RESOURCE_DESC& description = entry.Image->Description();
+
+      arrays[std::make_tuple(description.Width, description.Height, description.Format, description.MipLevels)].push_back(handle);
+
+      continue;
+    }
+
+    // stays in the empty array
+    Log::Error(L"Loading of texture " + entry.Filename + L" failed");
+
+    entry.Image.reset();
+    loaded = false;
+  }
+
+  for (const auto& images : arrays)
+  {
+    const auto& handles = images.second;
+
+    for (size_t first = 0; first < handles.size(); first += D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION)
+    {
+      const UINT count = static_cast<UINT>(std::min<size_t>(handles.size() - first, D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION));
+
+      loaded = Pack(device, commandList, handles.data() + first, count) && loaded;
+    }
+  }
+
+  const UINT count = static_cast<UINT>(s_Arrays.size());
+
+  // a new heap has room for every array and gets the views of all of them
+  if (count > s_DescriptorCapacity)
+  {
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+
+    heapDesc.NumDescriptors = std::max(count, 2 * s_DescriptorCapacity);
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+
+    ComPtr<ID3D12DescriptorHeap> heap;
+    const bool created = SUCCEEDED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(heap.GetAddressOf())));
+
+    // the frames in flight still use the views of the old heap
+    Retire(s_DescriptorHeap);
+    s_DescriptorHeap = heap;
+
+    if (!created)
+    {
+      Log::Error(L"Failed to create texture descriptor heap");
+
+      s_DescriptorCapacity = 0;
+
+      return false;
+    }
+
+    s_DescriptorCapacity = heapDesc.NumDescriptors;
+    s_DescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    for (auto& array : s_Arrays) array.Described = false;
+  }
+
+  for (UINT array = 0; array < count; ++array)
+  {
+    if (!s_Arrays[array].Described) Describe(device.Get(), array);
+  }
+
+  if (!arrays.empty())
+  {
+    size_t layers = 0;
+
+    for (const auto& images : arrays) layers += images.second.size();
+
+    Log::Info("Packed " + std::to_string(layers) + " textures into " + std::to_string(arrays.size()) + " texture arrays");
+  }
+
+  return loaded;
+}
+
+bool TextureCache::IsLoaded(UINT handle) noexcept
+{
+  return handle < s_Entries.size() && s_Entries[handle].Array != 0;
+}
+
+UINT TextureCache::Array(UINT handle) noexcept
+{
+  return (handle < s_Entries.size()) ? s_Entries[handle].Array : 0;
+}
+
+UINT TextureCache::Slice(UINT handle) noexcept
+{
+  return (handle < s_Entries.size()) ? s_Entries[handle].Slice : 0;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE TextureCache::Descriptor(UINT handle) noexcept
+{
+  if (!s_DescriptorHeap) return D3D12_GPU_DESCRIPTOR_HANDLE{ 0 };
+
+  return CD3DX12_GPU_DESCRIPTOR_HANDLE(s_DescriptorHeap->GetGPUDescriptorHandleForHeapStart(), Array(handle), s_DescriptorSize);
+}
+
+void TextureCache::Collect(UINT64 completed, UINT64 next)
+{
+  s_NextFence = next;
+
+  const auto passed = std::stable_partition(s_Retired.begin(), s_Retired.end(), [completed](const Retired& retired) { return retired.Fence > completed; });
+
+  for (auto it = passed; it != s_Retired.end(); ++it)
+  {
+    if (it->Array) s_FreeArrays.push_back(it->Array);
+  }
+
+  s_Retired.erase(passed, s_Retired.end());
+}
+
+// everything recorded so far is signaled with s_NextFence at the latest
+void TextureCache::Retire(ComPtr<ID3D12Pageable> resource, UINT array)
+{
+  if (!resource && !array) return;
+
+  Retired retired;
+
+  retired.Fence = s_NextFence;
+  retired.Resource = std::move(resource);
+  retired.Array = array;
+
+  s_Retired.push_back(std::move(retired));
+}
+
+// uploads the images of handles as the layers of a new array, they stay in the empty array if it can not be created
+bool TextureCache::Pack(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, const UINT* handles, UINT count)
+{
+  std::vector<const TextureImage*> images(count);
+  TextureArray array;
+
+  for (UINT i = 0; i < count; ++i) images[i] = s_Entries[handles[i]].Image.get();
+
+  // the images were usually opened by ImportAll already, with their levels in mapped DDS files
+  const bool created = TextureLoader::CreateTextureArray(device.Get(), commandList.Get(), images.data(), count, array.Texture, array.UploadHeap);
+
+  for (UINT i = 0; i < count; ++i) s_Entries[handles[i]].Image.reset();
+
+  if (!created)
+  {
+    Log::Error("Creating a texture array of " + std::to_string(count) + " textures failed");
+
+    return false;
+  }
+
+  UINT index = static_cast<UINT>(s_Arrays.size());
+
+  if (s_FreeArrays.empty()) s_Arrays.emplace_back();
+  else
+  {
+    index = s_FreeArrays.back();
+    s_FreeArrays.pop_back();
+  }
+
+  array.Layers = count;
+  s_Arrays[index] = std::move(array);
+
+  for (UINT i = 0; i < count; ++i)
+  {
+    s_Entries[handles[i]].Array = index;
+    s_Entries[handles[i]].Slice = i;
+  }
+
+  return true;
+}
+
+void TextureCache::Describe(ID3D12Device* device, UINT array)
+{
+  TextureArray& textures = s_Arrays[array];
+
+  // now we create a shader resource view (descriptor that points to the texture and describes it)
+  D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+
+  srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+  srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+
+  if (textures.Texture)
+  {
+    const D3D12_RESOURCE_DESC textureDesc = textures.Texture->GetDesc();
+
+    srvDesc.Format = textureDesc.Format;
+    srvDesc.Texture2DArray.MipLevels = textureDesc.MipLevels;
+    srvDesc.Texture2DArray.ArraySize = textureDesc.DepthOrArraySize;
+  }
+  else
+  {
+    // a null view, every sample reads 0
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.Texture2DArray.MipLevels = 1;
+    srvDesc.Texture2DArray.ArraySize = 1;
+  }
+
+  device->CreateShaderResourceView(textures.Texture.Get(), &srvDesc, CD3DX12_CPU_DESCRIPTOR_HANDLE(s_DescriptorHeap->GetCPUDescriptorHandleForHeapStart(), array, s_DescriptorSize));
+
+  textures.Described = true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "TextureLoader.h"
+
+// the textures of every mesh and model, one layer of a texture array per image and format however many of them use it
+// images of the same size, format and number of levels share a Texture2DArray, so a level is usually drawn with a single descriptor table
+// the descriptor heap holds one view per array, it is bound once per frame and every draw selects its layer by Slice
+// a handle is a reference that is given back by Release, an array is dropped once none of its layers is referenced anymore
+// dropped arrays and replaced descriptor heaps may still be used by frames in flight, they are only released by Collect once the GPU is past them
+// images are opened on import threads by ImportAll and packed by LoadResources, both only touch the entries that are not done yet
+class TextureCache
+{
+public:
+  static constexpr UINT InvalidHandle = UINT_MAX;
+
+  // a reference to the texture of filename in format, DXGI_FORMAT_UNKNOWN leaves the format to the importer
+  static UINT Acquire(const std::wstring& filename, DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN);
+  static void Release(UINT handle);
+
+  // opens every image that is not open yet on a worker per core, the images share the cores with their own filtering and compression
+  static void ImportAll(void);
+
+  // packs every image that is not uploaded yet into new texture arrays and describes them in the descriptor heap, which grows with the number of arrays
+  // the upload heaps have to live until the command list executed, they are kept with their array
+  static bool LoadResources(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList);
+
+  static bool IsLoaded(UINT handle) noexcept;
+
+  // called after waiting for the frame fence, completed is the value the GPU reached and next the one the following work is signaled with
+  // releases what was dropped before completed was signaled and makes the descriptors of released arrays available again
+  static void Collect(UINT64 completed, UINT64 next);
+
+  // one Texture2DArray view per array, entries that did not load are in an empty array that reads black
+  // null until LoadResources created it or if that failed, Descriptor then returns a null handle, nothing that samples the textures may be drawn without a table
+  static inline ID3D12DescriptorHeap* DescriptorHeap(void) noexcept { return s_DescriptorHeap.Get(); }
+  // the array of a handle, handles of the same array share its descriptor
+  static UINT Array(UINT handle) noexcept;
+  static UINT Slice(UINT handle) noexcept;
+  static D3D12_GPU_DESCRIPTOR_HANDLE Descriptor(UINT handle) noexcept;
+
+private:
+  TextureCache(void) noexcept = delete;
+  ~TextureCache(void) noexcept = delete;
+
+  struct Entry
+  {
+    std::wstring Filename;
+    std::wstring Path;                      // full and in lower case, the key together with Format
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    UINT References = 0;
+    std::unique_ptr<TextureImage> Image;    // released once the levels are in the upload heap
+    bool Imported = false;
+    UINT Array = 0;
+    UINT Slice = 0;
+  };
+
+  struct TextureArray
+  {
+    ComPtr<ID3D12Resource> Texture;
+    ComPtr<ID3D12Resource> UploadHeap;
+    UINT Layers = 0;                        // the ones still referenced
+    bool Described = false;
+  };
+
+  // a resource the GPU may still read until the fence reaches Fence, and the array whose descriptor is free from then on
+  struct Retired
+  {
+    UINT64 Fence = 0;
+    ComPtr<ID3D12Pageable> Resource;
+    UINT Array = 0;
+  };
+
+  static bool Pack(ComPtr<ID3D12Device>& device, ComPtr<ID3D12GraphicsCommandList>& commandList, const UINT* handles, UINT count);
+  static void Describe(ID3D12Device* device, UINT array);
+  static void Retire(ComPtr<ID3D12Pageable> resource, UINT array = 0);
+
+  static std::map<std::pair<std::wstring, DXGI_FORMAT>, UINT> s_Handles;
+  static std::vector<Entry> s_Entries;      // by handle, the entries without references are reused
+  static std::vector<UINT> s_FreeHandles;
+  static std::vector<TextureArray> s_Arrays;  // by descriptor, array 0 is the empty one
+  static std::vector<UINT> s_FreeArrays;
+  static std::vector<Retired> s_Retired;
+  static UINT64 s_NextFence;
+  static ComPtr<ID3D12DescriptorHeap> s_DescriptorHeap;
+  static UINT s_DescriptorCapacity;
+  static UINT s_DescriptorSize;
+
+};
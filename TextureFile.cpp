@@ -0,0 +1,321 @@
+#include "TextureFile.h"
+
+#include "ImportCache.h"
+#include "MipGenerator.h"
+
+static constexpr uint32_t s_Magic = 0x20534444; // "DDS "
+
+static constexpr uint32_t FourCC(const char a, const char b, const char c, const char d) noexcept
+{
+  return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+// the flags of the DDS headers this loader reads or writes
+static constexpr uint32_t s_HeaderCaps = 0x1;
+static constexpr uint32_t s_HeaderHeight = 0x2;
+static constexpr uint32_t s_HeaderWidth = 0x4;
+static constexpr uint32_t s_HeaderPitch = 0x8;
+static constexpr uint32_t s_HeaderPixelFormat = 0x1000;
+static constexpr uint32_t s_HeaderMipMapCount = 0x20000;
+static constexpr uint32_t s_HeaderLinearSize = 0x80000;
+
+static constexpr uint32_t s_PixelFormatAlphaPixels = 0x1;
+static constexpr uint32_t s_PixelFormatFourCC = 0x4;
+static constexpr uint32_t s_PixelFormatRGB = 0x40;
+
+static constexpr uint32_t s_CapsComplex = 0x8;
+static constexpr uint32_t s_CapsTexture = 0x1000;
+static constexpr uint32_t s_CapsMipMap = 0x400000;
+
+static constexpr uint32_t s_Caps2CubeMap = 0x200;
+static constexpr uint32_t s_Caps2Volume = 0x200000;
+
+static constexpr uint32_t s_Dimension2D = 3;           // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+static constexpr uint32_t s_MiscTextureCube = 0x4;
+
+struct DdsPixelFormat
+{
+  uint32_t Size;
+  uint32_t Flags;
+  uint32_t FourCC;
+  uint32_t RGBBitCount;
+  uint32_t RBitMask;
+  uint32_t GBitMask;
+  uint32_t BBitMask;
+  uint32_t ABitMask;
+};
+
+struct DdsHeader
+{
+  uint32_t Size;
+  uint32_t Flags;
+  uint32_t Height;
+  uint32_t Width;
+  uint32_t PitchOrLinearSize;
+  uint32_t Depth;
+  uint32_t MipMapCount;
+  uint32_t Reserved1[11];
+  DdsPixelFormat PixelFormat;
+  uint32_t Caps;
+  uint32_t Caps2;
+  uint32_t Caps3;
+  uint32_t Caps4;
+  uint32_t Reserved2;
+};
+
+struct DdsHeaderDxt10
+{
+  uint32_t Format;      // DXGI_FORMAT
+  uint32_t ResourceDimension;
+  uint32_t MiscFlag;
+  uint32_t ArraySize;
+  uint32_t MiscFlags2;
+};
+
+// the start of every file Write creates, the levels follow it
+struct DdsFileHeader
+{
+  uint32_t Magic;
+  DdsHeader Header;
+  DdsHeaderDxt10 Dxt10;
+};
+
+// levels of a full mip chain down to 1x1
+static UINT ChainLength(const UINT width, const UINT height) noexcept
+{
+  UINT levels = 1;
+
+  for (UINT size = std::max(width, height); size > 1; size >>= 1) ++levels;
+
+  return levels;
+}
+
+// the format of a DDS without the DX10 extension, DXGI_FORMAT_UNKNOWN if it has none
+static DXGI_FORMAT LegacyFormat(const DdsPixelFormat& pixelFormat) noexcept
+{
+  if (pixelFormat.Flags & s_PixelFormatFourCC)
+  {
+    switch (pixelFormat.FourCC)
+    {
+    case FourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+    case FourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+    case FourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+    case FourCC('A', 'T', 'I', '1'): return DXGI_FORMAT_BC4_UNORM;
+    case FourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+    case FourCC('A', 'T', 'I', '2'): return DXGI_FORMAT_BC5_UNORM;
+    case FourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+    default: return DXGI_FORMAT_UNKNOWN;
+    }
+  }
+
+  if ((pixelFormat.Flags & s_PixelFormatRGB) && pixelFormat.RGBBitCount == 32)
+  {
+    const uint32_t alpha = (pixelFormat.Flags & s_PixelFormatAlphaPixels) ? pixelFormat.ABitMask : 0;
+
+    if (pixelFormat.RBitMask == 0x000000FF && pixelFormat.GBitMask == 0x0000FF00 && pixelFormat.BBitMask == 0x00FF0000 && alpha == 0xFF000000) return DXGI_FORMAT_R8G8B8A8_UNORM;
+    if (pixelFormat.RBitMask == 0x00FF0000 && pixelFormat.GBitMask == 0x0000FF00 && pixelFormat.BBitMask == 0x000000FF && alpha == 0xFF000000) return DXGI_FORMAT_B8G8R8A8_UNORM;
+    if (pixelFormat.RBitMask == 0x00FF0000 && pixelFormat.GBitMask == 0x0000FF00 && pixelFormat.BBitMask == 0x000000FF && alpha == 0) return DXGI_FORMAT_B8G8R8X8_UNORM;
+  }
+
+  return DXGI_FORMAT_UNKNOWN;
+}
+
+TextureFile::TextureFile(TextureFile&& other) noexcept :
+  m_File(std::move(other.m_File)),
+  m_Levels(other.m_Levels),
+  m_Width(other.m_Width),
+  m_Height(other.m_Height),
+  m_Format(other.m_Format),
+  m_MipLevels(other.m_MipLevels)
+{
+  other.m_Levels = nullptr;
+}
+
+TextureFile& TextureFile::operator=(TextureFile&& other) noexcept
+{
+  m_File = std::move(other.m_File);
+  m_Levels = other.m_Levels;
+  m_Width = other.m_Width;
+  m_Height = other.m_Height;
+  m_Format = other.m_Format;
+  m_MipLevels = other.m_MipLevels;
+  other.m_Levels = nullptr;
+
+  return *this;
+}
+
+bool TextureFile::Write(const std::string& filename, UINT width, UINT height, DXGI_FORMAT format, UINT mipLevels, const BYTE* levels, size_t size)
+{
+  if (size != LevelsSize(format, width, height, mipLevels)) return false;
+
+  const bool compressed = BlockSize(format) != 0;
+  DdsFileHeader file = {};
+
+  file.Magic = s_Magic;
+  file.Header.Size = sizeof(DdsHeader);
+  file.Header.Flags = s_HeaderCaps | s_HeaderHeight | s_HeaderWidth | s_HeaderPixelFormat | s_HeaderMipMapCount | (compressed ? s_HeaderLinearSize : s_HeaderPitch);
+  file.Header.Height = height;
+  file.Header.Width = width;
+  // the size of level 0 for the block compressed formats, the size of a row for the others
+  file.Header.PitchOrLinearSize = compressed ? RowSize(format, width) * RowCount(format, height) : RowSize(format, width);
+  file.Header.MipMapCount = mipLevels;
+  file.Header.PixelFormat.Size = sizeof(DdsPixelFormat);
+  file.Header.PixelFormat.Flags = s_PixelFormatFourCC;
+  file.Header.PixelFormat.FourCC = FourCC('D', 'X', '1', '0');
+  file.Header.Caps = s_CapsTexture | ((mipLevels > 1) ? s_CapsComplex | s_CapsMipMap : 0);
+  file.Dxt10.Format = static_cast<uint32_t>(format);
+  file.Dxt10.ResourceDimension = s_Dimension2D;
+  file.Dxt10.ArraySize = 1;
+
+  return ImportCache::Store(filename, &file, sizeof(file), levels, size);
+}
+
+// get the number of bits per pixel for a dxgi format
+UINT TextureFile::BitsPerPixel(DXGI_FORMAT format) noexcept
+{
+  switch (format)
+  {
+  case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    return 128;
+
+  case DXGI_FORMAT_R16G16B16A16_FLOAT:
+  case DXGI_FORMAT_R16G16B16A16_UNORM:
+    return 64;
+
+  case DXGI_FORMAT_R8G8B8A8_UNORM:
+  case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+  case DXGI_FORMAT_B8G8R8A8_UNORM:
+  case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+  case DXGI_FORMAT_B8G8R8X8_UNORM:
+  case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+  case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+  case DXGI_FORMAT_R10G10B10A2_UNORM:
+  case DXGI_FORMAT_R32_FLOAT:
+    return 32;
+
+  case DXGI_FORMAT_B5G5R5A1_UNORM:
+  case DXGI_FORMAT_B5G6R5_UNORM:
+  case DXGI_FORMAT_R16_FLOAT:
+  case DXGI_FORMAT_R16_UNORM:
+    return 16;
+
+  case DXGI_FORMAT_R8_UNORM:
+  case DXGI_FORMAT_A8_UNORM:
+    return 8;
+
+  default:
+    return 0;
+  }
+}
+
+UINT TextureFile::BlockSize(DXGI_FORMAT format) noexcept
+{
+  switch (format)
+  {
+  case DXGI_FORMAT_BC1_UNORM:
+  case DXGI_FORMAT_BC1_UNORM_SRGB:
+  case DXGI_FORMAT_BC4_UNORM:
+  case DXGI_FORMAT_BC4_SNORM:
+    return 8;
+
+  case DXGI_FORMAT_BC2_UNORM:
+  case DXGI_FORMAT_BC2_UNORM_SRGB:
+  case DXGI_FORMAT_BC3_UNORM:
+  case DXGI_FORMAT_BC3_UNORM_SRGB:
+  case DXGI_FORMAT_BC5_UNORM:
+  case DXGI_FORMAT_BC5_SNORM:
+  case DXGI_FORMAT_BC6H_UF16:
+  case DXGI_FORMAT_BC6H_SF16:
+  case DXGI_FORMAT_BC7_UNORM:
+  case DXGI_FORMAT_BC7_UNORM_SRGB:
+    return 16;
+
+  default:
+    return 0;
+  }
+}
+
+UINT TextureFile::RowSize(DXGI_FORMAT format, UINT width) noexcept
+{
+  const UINT blockSize = BlockSize(format);
+
+  return blockSize ? (width + 3) / 4 * blockSize : width * (BitsPerPixel(format) / 8);
+}
+
+UINT TextureFile::RowCount(DXGI_FORMAT format, UINT height) noexcept
+{
+  return BlockSize(format) ? (height + 3) / 4 : height;
+}
+
+uint64_t TextureFile::LevelsSize(DXGI_FORMAT format, UINT width, UINT height, UINT levels) noexcept
+{
+  uint64_t size = 0;
+
+  for (UINT level = 0; level < levels; ++level)
+  {
+    size += static_cast<uint64_t>(RowSize(format, MipGenerator::LevelSize(width, level))) * RowCount(format, MipGenerator::LevelSize(height, level));
+  }
+
+  return size;
+}
+
+bool TextureFile::Open(const std::string& filename) noexcept
+{
+  Close();
+
+  if (!m_File.Open(filename)) return false;
+
+  const auto size = static_cast<uint64_t>(m_File.Size());
+  const auto* file = reinterpret_cast<const DdsFileHeader*>(m_File.Data());
+  const uint64_t legacySize = sizeof(uint32_t) + sizeof(DdsHeader);
+
+  if (size < legacySize || file->Magic != s_Magic || file->Header.Size != sizeof(DdsHeader) || file->Header.PixelFormat.Size != sizeof(DdsPixelFormat))
+  {
+    m_File.Close();
+
+    return false;
+  }
+
+  const DdsHeader& header = file->Header;
+  const bool extended = (header.PixelFormat.Flags & s_PixelFormatFourCC) && header.PixelFormat.FourCC == FourCC('D', 'X', '1', '0');
+  const uint64_t offset = extended ? sizeof(DdsFileHeader) : legacySize;
+  const DXGI_FORMAT format = extended ? ((size >= offset) ? static_cast<DXGI_FORMAT>(file->Dxt10.Format) : DXGI_FORMAT_UNKNOWN) : LegacyFormat(header.PixelFormat);
+  const UINT mipLevels = std::max(1u, header.MipMapCount);
+  const UINT blockSize = BlockSize(format);
+
+  // a single 2D image in a format a texture can be stored in, Direct3D needs level 0 of a block compressed texture in whole blocks
+  bool valid =
+    (blockSize || BitsPerPixel(format)) &&
+    !(header.Caps2 & (s_Caps2CubeMap | s_Caps2Volume)) &&
+    header.Width > 0 && header.Width <= D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION &&
+    header.Height > 0 && header.Height <= D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION &&
+    mipLevels <= ChainLength(header.Width, header.Height) &&
+    (!blockSize || (header.Width % 4 == 0 && header.Height % 4 == 0)) &&
+    offset + LevelsSize(format, header.Width, header.Height, mipLevels) <= size;
+
+  if (valid && extended)
+  {
+    valid = file->Dxt10.ResourceDimension == s_Dimension2D && file->Dxt10.ArraySize == 1 && !(file->Dxt10.MiscFlag & s_MiscTextureCube);
+  }
+
+  if (!valid)
+  {
+    m_File.Close();
+
+    return false;
+  }
+
+  m_Levels = reinterpret_cast<const BYTE*>(m_File.Data()) + offset;
+  m_Width = header.Width;
+  m_Height = header.Height;
+  m_Format = format;
+  m_MipLevels = mipLevels;
+
+  return true;
+}
+
+void TextureFile::Close(void) noexcept
+{
+  m_Levels = nullptr;
+  m_File.Close();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "MappedFile.h"
+
+// a cooked texture on disk as a plain DDS file: "DDS ", the DDS header and its DX10 extension, then every mip level from the largest one on in subresource order
+// the rows of a level are tightly packed as DDS has them, rows of 4x4 blocks for the block compressed formats, and go from the mapped file straight into the upload heap
+// any DDS of a single 2D image opens, with the DX10 extension or as DXT1, DXT3, DXT5, ATI1, ATI2 or 32 bit RGB, so textures cooked by other tools load without an import
+class TextureFile
+{
+public:
+  TextureFile(void) noexcept = default;
+  TextureFile(TextureFile&& other) noexcept;
+  ~TextureFile(void) noexcept = default;
+
+  TextureFile& operator=(TextureFile&& other) noexcept;
+
+  // levels holds every level one after the other without padding, it is written through a temporary file by ImportCache::Store
+  static bool Write(const std::string& filename, UINT width, UINT height, DXGI_FORMAT format, UINT mipLevels, const BYTE* levels, size_t size);
+
+  // bits per pixel of the formats that are not block compressed, 0 for every other one
+  static UINT BitsPerPixel(DXGI_FORMAT format) noexcept;
+  // bytes per 4x4 block of the block compressed formats, 0 for every other one
+  static UINT BlockSize(DXGI_FORMAT format) noexcept;
+
+  // a row is a row of pixels, or of 4x4 blocks for the block compressed formats
+  static UINT RowSize(DXGI_FORMAT format, UINT width) noexcept;
+  static UINT RowCount(DXGI_FORMAT format, UINT height) noexcept;
+  // bytes of the first levels of an image together
+  static uint64_t LevelsSize(DXGI_FORMAT format, UINT width, UINT height, UINT levels) noexcept;
+
+  bool Open(const std::string& filename) noexcept;
+  void Close(void) noexcept;
+
+  inline bool IsOpen(void) const noexcept { return m_Levels != nullptr; }
+
+  inline UINT Width(void) const noexcept { return m_Width; }
+  inline UINT Height(void) const noexcept { return m_Height; }
+  inline DXGI_FORMAT Format(void) const noexcept { return m_Format; }
+  inline UINT MipLevels(void) const noexcept { return m_MipLevels; }
+
+  // level 0, the others follow it
+  inline const BYTE* Levels(void) const noexcept { return m_Levels; }
+
+private:
+  MappedFile m_File;
+  const BYTE* m_Levels = nullptr;
+  UINT m_Width = 0;
+  UINT m_Height = 0;
+  DXGI_FORMAT m_Format = DXGI_FORMAT_UNKNOWN;
+  UINT m_MipLevels = 0;
+
+};
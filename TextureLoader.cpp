@@ -1,54 +1,371 @@
 #include "TextureLoader.h"
 
-int TextureLoader::LoadImageDataFromFile(BYTE** imageData, D3D12_RESOURCE_DESC& resourceDescription, LPCWSTR filename, int& bytesPerRow)
+#include "ImportCache.h"
+#include "PngDecoder.h"
+#include "MipGenerator.h"
+#include "BlockCompressor.h"
+
+#include <mutex>
+
+// raised with every change of the decoding, the filtering, the compression or the layout, part of the import cache key so every texture is imported again
+static constexpr uint32_t s_Version = 6;
+
+// 8 bit images are block compressed, opaque ones to BC1 and the others to BC3, or all of them to BC7 for twice the size of BC1 at a much higher quality
+static constexpr bool s_CompressToBC7 = false;
+static constexpr BlockCompressionQuality s_CompressionQuality = BlockCompressionQuality::Normal;
+
+// the block compressed format for the levels of an image, DXGI_FORMAT_UNKNOWN to keep them as they are
+static DXGI_FORMAT CompressedFormat(const std::vector<BYTE>& pixels, const D3D12_RESOURCE_DESC& description, const DXGI_FORMAT requested)
+{
+  // Direct3D needs level 0 of a block compressed texture in whole blocks
+  if (description.Width % 4 || description.Height % 4) return DXGI_FORMAT_UNKNOWN;
+
+  if (description.Format != DXGI_FORMAT_R8G8B8A8_UNORM && description.Format != DXGI_FORMAT_B8G8R8A8_UNORM && description.Format != DXGI_FORMAT_B8G8R8X8_UNORM) return DXGI_FORMAT_UNKNOWN;
+
+  if (requested != DXGI_FORMAT_UNKNOWN) return BlockCompressor::BlockSize(requested) ? requested : DXGI_FORMAT_UNKNOWN;
+
+  if (s_CompressToBC7) return DXGI_FORMAT_BC7_UNORM;
+
+  bool opaque = true;
+  const size_t count = static_cast<size_t>(description.Width) * description.Height;
+
+  if (description.Format != DXGI_FORMAT_B8G8R8X8_UNORM)
+  {
+    for (size_t i = 0; i < count && opaque; ++i) opaque = (pixels[i * 4 + 3] == 255);
+  }
+
+  return opaque ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+}
+
+bool TextureImage::Open(const std::wstring& filename, DXGI_FORMAT format, UINT threads)
+{
+  m_Filename.assign(filename.begin(), filename.end());
+  m_File.Close();
+  m_Decoded.clear();
+  m_Pixels = nullptr;
+  m_Description = {};
+
+  // a DDS file is already cooked, its levels are uploaded from the source without going through the cache
+  // otherwise images are only decoded, filtered and compressed if their content is not in the cache yet
+  std::string artifact;
+
+  if (!m_File.Open(m_Filename))
+  {
+    // every format asked for is an artifact of its own
+    const std::string extension = (format == DXGI_FORMAT_UNKNOWN) ? ".dds" : "." + std::to_string(format) + ".dds";
+
+    if (!ImportCache::ArtifactFileName(m_Filename, s_Version, extension, artifact)) return false;
+
+    m_File.Open(artifact);
+  }
+
+  if (m_File.IsOpen())
+  {
+    m_Pixels = m_File.Levels();
+    TextureLoader::DescribeTexture(m_Description, m_File.Width(), m_File.Height(), m_File.Format(), m_File.MipLevels());
+
+    return true;
+  }
+
+  if (!Import()) return false;
+
+  const auto start = std::chrono::steady_clock::now();
+  const UINT width = static_cast<UINT>(m_Description.Width);
+
+  MipGenerator::Generate(m_Decoded, width, m_Description.Height, m_Description.Format, threads);
+  m_Description.MipLevels = static_cast<UINT16>(MipGenerator::LevelCount(width, m_Description.Height, m_Description.Format));
+
+  const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  if (m_Description.MipLevels > 1) Log::Info("Generated " + std::to_string(m_Description.MipLevels - 1) + " mip levels of " + m_Filename + " in " + std::to_string(seconds.count() * 1e3) + " ms");
+
+  const DXGI_FORMAT compressed = CompressedFormat(m_Decoded, m_Description, format);
+
+  if (compressed != DXGI_FORMAT_UNKNOWN && !Compress(compressed, threads)) return false;
+
+  if (!TextureFile::Write(artifact, width, m_Description.Height, m_Description.Format, m_Description.MipLevels, m_Decoded.data(), m_Decoded.size()))
+  {
+    Log::Error("Caching of texture " + artifact + " failed");
+  }
+  else if (m_File.Open(artifact))
+  {
+    // the levels are uploaded from the cached file like on any later open, the decoded ones are not needed any more
+    std::vector<BYTE>().swap(m_Decoded);
+    m_Pixels = m_File.Levels();
+
+    return true;
+  }
+
+  m_Pixels = m_Decoded.data();
+
+  return true;
+}
+
+// replaces every level in m_Decoded by its blocks in the target format
+bool TextureImage::Compress(DXGI_FORMAT target, UINT threads)
+{
+  const auto start = std::chrono::steady_clock::now();
+  const DXGI_FORMAT source = m_Description.Format;
+  const UINT width = static_cast<UINT>(m_Description.Width);
+  const UINT height = m_Description.Height;
+  std::vector<BYTE> blocks(static_cast<size_t>(TextureFile::LevelsSize(target, width, height, m_Description.MipLevels)));
+
+  for (UINT level = 0; level < m_Description.MipLevels; ++level)
+  {
+    const BYTE* pixels = m_Decoded.data() + TextureFile::LevelsSize(source, width, height, level);
+    BYTE* out = blocks.data() + TextureFile::LevelsSize(target, width, height, level);
+
+    if (!BlockCompressor::Compress(pixels, MipGenerator::LevelSize(width, level), MipGenerator::LevelSize(height, level), source, target, s_CompressionQuality, out, threads))
+    {
+      Log::Error("Compression of texture " + m_Filename + " failed");
+
+      return false;
+    }
+  }
+
+  const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  // level 0 decoded again for how close the blocks come to the image
+  std::vector<BYTE> decoded(static_cast<size_t>(width) * height * 4);
+
+  const double psnr = BlockCompressor::Decompress(blocks.data(), width, height, target, decoded.data()) ?
+    BlockCompressor::PSNR(m_Decoded.data(), source, decoded.data(), static_cast<size_t>(width) * height) : 0.0;
+
+  Log::Info("Compressed " + m_Filename + " to " + std::string((target == DXGI_FORMAT_BC1_UNORM) ? "BC1" : (target == DXGI_FORMAT_BC3_UNORM) ? "BC3" : "BC7") +
+    " in " + std::to_string(seconds.count() * 1e3) + " ms, " + std::to_string(m_Decoded.size() / 1024) + " KB to " + std::to_string(blocks.size() / 1024) + " KB, PSNR " + std::to_string(psnr) + " dB");
+
+  m_Decoded.swap(blocks);
+  m_Description.Format = target;
+
+  return true;
+}
+
+// decodes level 0 into m_Decoded and describes it
+bool TextureImage::Import(void)
+{
+  MappedFile file;
+
+  if (!file.Open(m_Filename)) return false;
+
+  const BYTE* data = reinterpret_cast<const BYTE*>(file.Data());
+  PngInfo info;
+
+  if (!PngDecoder::IsPng(data, file.Size()))
+  {
+    file.Close();
+
+    UINT bytesPerRow;
+
+    return TextureLoader::DecodeImage(std::wstring(m_Filename.begin(), m_Filename.end()), m_Decoded, m_Description, bytesPerRow);
+  }
+
+  if (!PngDecoder::ReadInfo(data, file.Size(), info))
+  {
+    Log::Error("Invalid PNG header in " + m_Filename);
+
+    return false;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  m_Decoded.resize(static_cast<size_t>(info.Width) * info.BytesPerPixel * info.Height);
+
+  if (!PngDecoder::Decode(data, file.Size(), m_Decoded.data(), static_cast<size_t>(info.Width) * info.BytesPerPixel))
+  {
+    Log::Error("Decoding of PNG " + m_Filename + " failed");
+
+    return false;
+  }
+
+  const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  const double megapixels = static_cast<double>(info.Width) * info.Height / 1e6;
+
+  Log::Info("Decoded " + m_Filename + ", " + std::to_string(info.Width) + "x" + std::to_string(info.Height) + " in " + std::to_string(seconds.count() * 1e3) + " ms (" +
+    std::to_string(megapixels / std::max(seconds.count(), 1e-9)) + " MPixel/s)");
+
+  TextureLoader::DescribeTexture(m_Description, info.Width, info.Height, info.Format);
+
+  return true;
+}
+
+UINT TextureImage::BytesPerRow(UINT level) const noexcept
+{
+  return TextureFile::RowSize(m_Description.Format, MipGenerator::LevelSize(static_cast<UINT>(m_Description.Width), level));
+}
+
+UINT TextureImage::RowCount(UINT level) const noexcept
+{
+  return TextureFile::RowCount(m_Description.Format, MipGenerator::LevelSize(m_Description.Height, level));
+}
+
+const BYTE* TextureImage::Level(UINT level) const noexcept
+{
+  return m_Pixels + TextureFile::LevelsSize(m_Description.Format, static_cast<UINT>(m_Description.Width), m_Description.Height, level);
+}
+
+bool TextureLoader::CreateTexture(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const TextureImage& image, ComPtr<ID3D12Resource>& texture, ComPtr<ID3D12Resource>& uploadHeap)
+{
+  const TextureImage* images[] = { &image };
+
+  return CreateTextureArray(device, commandList, images, 1, texture, uploadHeap);
+}
+
+bool TextureLoader::CreateTextureArray(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const TextureImage* const* images, UINT count, ComPtr<ID3D12Resource>& texture, ComPtr<ID3D12Resource>& uploadHeap)
+{
+  if (!count || count > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) return false;
+
+  D3D12_RESOURCE_DESC description = images[0]->Description();
+
+  for (UINT i = 0; i < count; ++i)
+  {
+    const D3D12_RESOURCE_DESC& layer = images[i]->Description();
+
+    if (!images[i]->IsOpen() || layer.Width != description.Width || layer.Height != description.Height || layer.Format != description.Format || layer.MipLevels != description.MipLevels) return false;
+  }
+
+  description.DepthOrArraySize = static_cast<UINT16>(count);
+
+  // create a default heap where the upload heap will copy its contents into (contents being the texture)
+  if (
+    FAILED(
+      device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), // a default heap
+        D3D12_HEAP_FLAG_NONE, // no flags
+        &description, // the description of our texture
+        D3D12_RESOURCE_STATE_COPY_DEST, // We will copy the texture from the upload heap to here, so we start it out in a copy dest state
+        nullptr, // used for render targets and depth/stencil buffers
+        IID_PPV_ARGS(&texture)
+      )
+    )
+  )
+  {
+    return false;
+  }
+  texture->SetName(L"Texture Buffer Resource Heap");
+
+  // every level of every layer goes into the same upload heap, each one 512 byte aligned with 256 byte aligned rows
+  const UINT levels = description.MipLevels;
+  const UINT subresourceCount = levels * count;
+  const UINT64 uploadSize = GetRequiredIntermediateSize(texture.Get(), 0, subresourceCount);
+
+  // now we create an upload heap to upload our texture to the GPU
+  if (
+    FAILED(
+      device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
+        D3D12_HEAP_FLAG_NONE, // no flags
+        &CD3DX12_RESOURCE_DESC::Buffer(uploadSize), // resource description for a buffer (storing the image data in this heap just to copy to the default heap)
+        D3D12_RESOURCE_STATE_GENERIC_READ, // We will copy the contents from this heap to the default heap above
+        nullptr,
+        IID_PPV_ARGS(&uploadHeap))
+    )
+  )
+  {
+    Log::Info(L"Failed to create committed resource texture upload heap");
+
+    return false;
+  }
+  uploadHeap->SetName(L"Texture Buffer Upload Resource Heap");
+
+  // the levels of a layer follow each other, layer by layer
+  std::vector<D3D12_SUBRESOURCE_DATA> subresources(subresourceCount);
+
+  for (UINT i = 0; i < count; ++i)
+  {
+    for (UINT level = 0; level < levels; ++level)
+    {
+      auto& subresource = subresources[D3D12CalcSubresource(level, i, 0, levels, count)];
+
+      subresource.pData = images[i]->Level(level);
+      subresource.RowPitch = images[i]->BytesPerRow(level);
+      subresource.SlicePitch = subresource.RowPitch * images[i]->RowCount(level);
+    }
+  }
+
+  // copies the levels from the mapped DDS files into the upload heap and records one copy per level
+  if (!UpdateSubresources(commandList, texture.Get(), uploadHeap.Get(), 0, 0, subresourceCount, subresources.data())) return false;
+
+  // transition the texture default heap to a pixel shader resource (we will be sampling from this heap in the pixel shader to get the color of pixels)
+  commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+  return true;
+}
+
+void TextureLoader::DescribeTexture(D3D12_RESOURCE_DESC& resourceDescription, const UINT textureWidth, const UINT textureHeight, const DXGI_FORMAT dxgiFormat, const UINT mipLevels)
+{
+  // now describe the texture with the information we have obtained from the image
+  resourceDescription = {};
+  resourceDescription.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+  resourceDescription.Alignment = 0; // may be 0, 4KB, 64KB, or 4MB. 0 will let runtime decide between 64KB and 4MB (4MB for multi-sampled textures)
+  resourceDescription.Width = textureWidth; // width of the texture
+  resourceDescription.Height = textureHeight; // height of the texture
+  resourceDescription.DepthOrArraySize = 1; // if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (we only have one image, so we set 1)
+  resourceDescription.MipLevels = static_cast<UINT16>(mipLevels); // Number of mipmaps, the image holds every one of them
+  resourceDescription.Format = dxgiFormat; // This is the dxgi format of the image (format of the pixels)
+  resourceDescription.SampleDesc.Count = 1; // This is the number of samples per pixel, we just want 1 sample
+  resourceDescription.SampleDesc.Quality = 0; // The quality level of the samples. Higher is better quality, but worse performance
+  resourceDescription.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN; // The arrangement of the pixels. Setting to unknown lets the driver choose the most efficient one
+  resourceDescription.Flags = D3D12_RESOURCE_FLAG_NONE; // no flags
+}
+
+bool TextureLoader::DecodeImage(const std::wstring& filename, std::vector<BYTE>& pixels, D3D12_RESOURCE_DESC& resourceDescription, UINT& bytesPerRow)
 {
   HRESULT hr;
 
-  // reset decoder, frame and converter since these will be different for each image we load
-  IWICBitmapDecoder* wicDecoder = NULL;
-  IWICBitmapFrameDecode* wicFrame = NULL;
-  IWICFormatConverter* wicConverter = NULL;
+  // every image gets a decoder, frame and converter of its own, released when they go out of scope
+  ComPtr<IWICBitmapDecoder> wicDecoder;
+  ComPtr<IWICBitmapFrameDecode> wicFrame;
+  ComPtr<IWICFormatConverter> wicConverter;
 
   bool imageConverted = false;
-  static IWICImagingFactory* m_wicFactory;
-  if (m_wicFactory == NULL)
+
+  // images are decoded on the import threads, COM has to be initialized on each of them
+  // a thread that initialized COM as single threaded before keeps that, RPC_E_CHANGED_MODE still means COM is usable
+  static thread_local const struct ComScope
   {
-    // Initialize the COM library
-    CoInitialize(NULL);
+    ComScope(void) noexcept : Initialized(SUCCEEDED(CoInitializeEx(NULL, COINIT_MULTITHREADED))) {}
+    ~ComScope(void) noexcept { if (Initialized) CoUninitialize(); }
 
-    // create the WIC factory
-    hr = CoCreateInstance(
-      CLSID_WICImagingFactory,
-      NULL,
-      CLSCTX_INPROC_SERVER,
-      IID_PPV_ARGS(&m_wicFactory)
-    );
-    if (FAILED(hr)) return 0;
-  }
+    const bool Initialized;
+  } s_Com;
+
+  // the WIC factory is free threaded, it is created once by whichever thread gets here first and shared by all of them
+  // the multithreaded apartment is held for the life of the process, so the factory outlives the threads that initialized it
+  static std::once_flag s_FactoryCreated;
+  static IWICImagingFactory* s_WicFactory = NULL;
+
+  std::call_once(s_FactoryCreated, []()
+  {
+    CO_MTA_USAGE_COOKIE cookie;
+
+    if (SUCCEEDED(CoIncrementMTAUsage(&cookie))) CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&s_WicFactory));
+  });
+
+  if (!s_WicFactory) return false;
 
   // load a decoder for the image
-  hr = m_wicFactory->CreateDecoderFromFilename(
-    filename,                        // Image we want to load in
+  hr = s_WicFactory->CreateDecoderFromFilename(
+    filename.c_str(),                // Image we want to load in
     NULL,                            // This is a vendor ID, we do not prefer a specific one so set to null
     GENERIC_READ,                    // We want to read from this file
     WICDecodeMetadataCacheOnLoad,    // We will cache the metadata right away, rather than when needed, which might be unknown
     &wicDecoder                      // the wic decoder to be created
   );
-  if (FAILED(hr)) return 0;
+  if (FAILED(hr)) return false;
 
   // get image from decoder (this will decode the "frame")
   hr = wicDecoder->GetFrame(0, &wicFrame);
-  if (FAILED(hr)) return 0;
+  if (FAILED(hr)) return false;
 
   // get wic pixel format of image
   WICPixelFormatGUID pixelFormat;
   hr = wicFrame->GetPixelFormat(&pixelFormat);
-  if (FAILED(hr)) return 0;
+  if (FAILED(hr)) return false;
 
   // get size of image
   UINT textureWidth, textureHeight;
   hr = wicFrame->GetSize(&textureWidth, &textureHeight);
-  if (FAILED(hr)) return 0;
+  if (FAILED(hr)) return false;
 
   // we are not handling sRGB types in this tutorial, so if you need that support, you'll have to figure
   // out how to implement the support yourself
@@ -63,65 +380,52 @@ int TextureLoader::LoadImageDataFromFile(BYTE** imageData, D3D12_RESOURCE_DESC&
     WICPixelFormatGUID convertToPixelFormat = GetConvertToWICFormat(pixelFormat);
 
     // return if no dxgi compatible format was found
-    if (convertToPixelFormat == GUID_WICPixelFormatDontCare) return 0;
+    if (convertToPixelFormat == GUID_WICPixelFormatDontCare) return false;
 
     // set the dxgi format
     dxgiFormat = GetDXGIFormatFromWICFormat(convertToPixelFormat);
 
     // create the format converter
-    hr = m_wicFactory->CreateFormatConverter(&wicConverter);
-    if (FAILED(hr)) return 0;
+    hr = s_WicFactory->CreateFormatConverter(&wicConverter);
+    if (FAILED(hr)) return false;
 
     // make sure we can convert to the dxgi compatible format
     BOOL canConvert = FALSE;
     hr = wicConverter->CanConvert(pixelFormat, convertToPixelFormat, &canConvert);
-    if (FAILED(hr) || !canConvert) return 0;
+    if (FAILED(hr) || !canConvert) return false;
 
     // do the conversion (wicConverter will contain the converted image)
-    hr = wicConverter->Initialize(wicFrame, convertToPixelFormat, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom);
-    if (FAILED(hr)) return 0;
+    hr = wicConverter->Initialize(wicFrame.Get(), convertToPixelFormat, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom);
+    if (FAILED(hr)) return false;
 
     // this is so we know to get the image data from the wicConverter (otherwise we will get from wicFrame)
     imageConverted = true;
   }
 
-  int bitsPerPixel = GetDXGIFormatBitsPerPixel(dxgiFormat); // number of bits per pixel
+  UINT bitsPerPixel = TextureFile::BitsPerPixel(dxgiFormat); // number of bits per pixel
   bytesPerRow = (textureWidth * bitsPerPixel) / 8; // number of bytes in each row of the image data
-  int imageSize = bytesPerRow * textureHeight; // total image size in bytes
+  UINT imageSize = bytesPerRow * textureHeight; // total image size in bytes
 
-                                               // allocate enough memory for the raw image data, and set imageData to point to that memory
-  *imageData = (BYTE*)malloc(imageSize);
+  // allocate enough memory for the raw image data
+  pixels.resize(imageSize);
 
-  // copy (decoded) raw image data into the newly allocated memory (imageData)
+  // copy (decoded) raw image data into pixels
   if (imageConverted)
   {
     // if image format needed to be converted, the wic converter will contain the converted image
-    hr = wicConverter->CopyPixels(0, bytesPerRow, imageSize, *imageData);
-    if (FAILED(hr)) return 0;
+    hr = wicConverter->CopyPixels(0, bytesPerRow, imageSize, pixels.data());
+    if (FAILED(hr)) return false;
   }
   else
   {
     // no need to convert, just copy data from the wic frame
-    hr = wicFrame->CopyPixels(0, bytesPerRow, imageSize, *imageData);
-    if (FAILED(hr)) return 0;
+    hr = wicFrame->CopyPixels(0, bytesPerRow, imageSize, pixels.data());
+    if (FAILED(hr)) return false;
   }
 
-  // now describe the texture with the information we have obtained from the image
-  resourceDescription = {};
-  resourceDescription.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-  resourceDescription.Alignment = 0; // may be 0, 4KB, 64KB, or 4MB. 0 will let runtime decide between 64KB and 4MB (4MB for multi-sampled textures)
-  resourceDescription.Width = textureWidth; // width of the texture
-  resourceDescription.Height = textureHeight; // height of the texture
-  resourceDescription.DepthOrArraySize = 1; // if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (we only have one image, so we set 1)
-  resourceDescription.MipLevels = 0; // Number of mipmaps. We are not generating default mipmaps for this texture, so 0
-  resourceDescription.Format = dxgiFormat; // This is the dxgi format of the image (format of the pixels)
-  resourceDescription.SampleDesc.Count = 1; // This is the number of samples per pixel, we just want 1 sample
-  resourceDescription.SampleDesc.Quality = 0; // The quality level of the samples. Higher is better quality, but worse performance
-  resourceDescription.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN; // The arrangement of the pixels. Setting to unknown lets the driver choose the most efficient one
-  resourceDescription.Flags = D3D12_RESOURCE_FLAG_NONE; // no flags
+  DescribeTexture(resourceDescription, textureWidth, textureHeight, dxgiFormat);
 
-                                                        // return the size of the image. remember to delete the image once your done with it (in this tutorial once its uploaded to the gpu)
-  return imageSize;
+  return true;
 }
 
 // get the dxgi format equivilent of a wic format
@@ -194,25 +498,4 @@ WICPixelFormatGUID TextureLoader::GetConvertToWICFormat(WICPixelFormatGUID& wicF
 #endif
 
   else return GUID_WICPixelFormatDontCare;
-}
-
-// get the number of bits per pixel for a dxgi format
-int TextureLoader::GetDXGIFormatBitsPerPixel(DXGI_FORMAT& dxgiFormat)
-{
-  if (dxgiFormat == DXGI_FORMAT_R32G32B32A32_FLOAT) return 128;
-  else if (dxgiFormat == DXGI_FORMAT_R16G16B16A16_FLOAT) return 64;
-  else if (dxgiFormat == DXGI_FORMAT_R16G16B16A16_UNORM) return 64;
-  else if (dxgiFormat == DXGI_FORMAT_R8G8B8A8_UNORM) return 32;
-  else if (dxgiFormat == DXGI_FORMAT_B8G8R8A8_UNORM) return 32;
-  else if (dxgiFormat == DXGI_FORMAT_B8G8R8X8_UNORM) return 32;
-  else if (dxgiFormat == DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM) return 32;
-
-  else if (dxgiFormat == DXGI_FORMAT_R10G10B10A2_UNORM) return 32;
-  else if (dxgiFormat == DXGI_FORMAT_B5G5R5A1_UNORM) return 16;
-  else if (dxgiFormat == DXGI_FORMAT_B5G6R5_UNORM) return 16;
-  else if (dxgiFormat == DXGI_FORMAT_R32_FLOAT) return 32;
-  else if (dxgiFormat == DXGI_FORMAT_R16_FLOAT) return 16;
-  else if (dxgiFormat == DXGI_FORMAT_R16_UNORM) return 16;
-  else if (dxgiFormat == DXGI_FORMAT_R8_UNORM) return 8;
-  else if (dxgiFormat == DXGI_FORMAT_A8_UNORM) return 8;
 }
\ No newline at end of file
@@ -1,16 +1,62 @@
 #pragma once
 
+#include "TextureFile.h"
+
+// an image opened for upload with its whole mip chain, a DDS file is mapped as it is, any other image is decoded, filtered and block compressed once and then read from the import cache
+// PNG files are decoded by PngDecoder, other formats by WIC, the levels of the formats MipGenerator filters follow level 0
+class TextureImage
+{
+public:
+  TextureImage(void) noexcept = default;
+  ~TextureImage(void) noexcept = default;
+
+  // format asks for BC1, BC3 or BC7, any other format for no block compression, DXGI_FORMAT_UNKNOWN leaves it to the image
+  // a DDS file is used as it is
+  // the levels are filtered and compressed on up to threads threads, 0 uses one per core
+  bool Open(const std::wstring& filename, DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN, UINT threads = 0);
+
+  inline bool IsOpen(void) const noexcept { return m_Pixels != nullptr; }
+
+  // a 2D texture of the size, format and number of levels of the image
+  inline const D3D12_RESOURCE_DESC& Description(void) const noexcept { return m_Description; }
+
+  // a row is a row of pixels, or of 4x4 blocks for the block compressed formats
+  UINT BytesPerRow(UINT level) const noexcept;
+  UINT RowCount(UINT level) const noexcept;
+
+  // the rows of a level without padding
+  const BYTE* Level(UINT level) const noexcept;
+
+private:
+  bool Import(void);
+  bool Compress(DXGI_FORMAT target, UINT threads);
+
+  std::string m_Filename;
+  TextureFile m_File;               // the DDS source or the cooked levels
+  std::vector<BYTE> m_Decoded;      // levels decoded and filtered on this open, freed once they are cached and mapped from the cache
+  const BYTE* m_Pixels = nullptr;   // level 0, the others follow it
+  D3D12_RESOURCE_DESC m_Description = {};
+
+};
+
 class TextureLoader
 {
 public:
-  static int LoadImageDataFromFile(BYTE** imageData, D3D12_RESOURCE_DESC& resourceDescription, LPCWSTR filename, int& bytesPerRow);
+  // creates the texture in a default heap and records the copy of every level from one upload heap
+  // the upload heap has to live until the command list executed
+  static bool CreateTexture(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const TextureImage& image, ComPtr<ID3D12Resource>& texture, ComPtr<ID3D12Resource>& uploadHeap);
+  // creates a texture array with one layer per image, the images have to match in size, format and number of levels
+  static bool CreateTextureArray(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const TextureImage* const* images, UINT count, ComPtr<ID3D12Resource>& texture, ComPtr<ID3D12Resource>& uploadHeap);
+
+  // decodes any format WIC knows to rows without padding, safe to call from several import threads at once
+  static bool DecodeImage(const std::wstring& filename, std::vector<BYTE>& pixels, D3D12_RESOURCE_DESC& resourceDescription, UINT& bytesPerRow);
+
+  static void DescribeTexture(D3D12_RESOURCE_DESC& resourceDescription, UINT textureWidth, UINT textureHeight, DXGI_FORMAT dxgiFormat, UINT mipLevels = 1);
 
 private:
   TextureLoader(void) noexcept = default;
   ~TextureLoader(void) noexcept = default;
 
-
   static DXGI_FORMAT GetDXGIFormatFromWICFormat(WICPixelFormatGUID& wicFormatGUID);
   static WICPixelFormatGUID GetConvertToWICFormat(WICPixelFormatGUID& wicFormatGUID);
-  static int GetDXGIFormatBitsPerPixel(DXGI_FORMAT& dxgiFormat);
-};
\ No newline at end of file
+};
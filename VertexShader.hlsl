@@ -5,6 +5,12 @@ struct VS_INPUT
 	float2 texcoord : TEXCOORD;
 };
 
+struct VS_INPUT_PACKED
+{
+	float4 pos : POSITION;
+	float2 texcoord : TEXCOORD;
+};
+
 struct VS_OUTPUT
 {
 	float4 pos: SV_POSITION;
@@ -34,4 +40,17 @@ VS_OUTPUT main(VS_INPUT input)
 	output.texcoord = input.texcoord;
 
 	return output;
-}
\ No newline at end of file
+}
+
+// cooked meshes: the input assembler expands the unorm16 position to [0, 1] with w = 1
+// the mesh AABB is folded into wvpMat and the color comes from the constants only
+VS_OUTPUT mainPacked(VS_INPUT_PACKED input)
+{
+	VS_OUTPUT output;
+
+	output.pos = mul(wvpMat, input.pos);
+	output.color = colorMultiplier;
+	output.texcoord = input.texcoord;
+
+	return output;
+}